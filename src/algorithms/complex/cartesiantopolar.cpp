@@ -51,9 +51,8 @@ void CartesianToPolar::compute() {
   magnitude.resize(c.size());
   phase.resize(c.size());
 
-  for (std::vector<Real>::size_type i=0; i<magnitude.size(); i++) {
-    magnitude[i] = sqrt(c[i].real()*c[i].real() + c[i].imag()*c[i].imag());
-  }
+  if (c.empty()) return;
+  util::magnitude(&c[0], &magnitude[0], (int)c.size());
 
   for (std::vector<Real>::size_type i=0; i<phase.size(); i++) {
     phase[i] = atan2(c[i].imag(), c[i].real());
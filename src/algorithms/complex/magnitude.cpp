@@ -40,7 +40,6 @@ void Magnitude::compute() {
 
   magnitude.resize(cmplex.size());
 
-  for (std::vector<Real>::size_type i=0; i<magnitude.size(); i++) {
-    magnitude[i] = sqrt(cmplex[i].real()*cmplex[i].real() + cmplex[i].imag()*cmplex[i].imag());
-  }
+  if (cmplex.empty()) return;
+  util::magnitude(&cmplex[0], &magnitude[0], (int)cmplex.size());
 }
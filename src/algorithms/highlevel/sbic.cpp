@@ -44,25 +44,45 @@ const char* SBic::description = DOC("This algorithm segments audio using the Bay
 
 
 
-Array2D<Real> subarray(const Array2D<Real>& matrix, int i0, int i1, int j0, int j1) {
-   int dim1 = i1 - i0 + 1, dim2 = j1 - j0 + 1;
-   if (dim1<1 || dim2 <1) return Array2D<Real>();
-   Array2D<Real> subMatrix = Array2D<Real>(dim1,dim2);
-
-   for (int i=0; i<dim1; ++i) {
-     for (int j=0; j<dim2; ++j) {
-       subMatrix[i][j] = matrix[i+i0][j+j0];
-     }
-   }
-
-   return subMatrix;
+namespace essentia {
+
+void BicStatistics::clear(int nFeatures) {
+  _nFeatures = nFeatures;
+  _first = 0;
+  _sums.assign(nFeatures, 0.0);
+  _squares.assign(nFeatures, 0.0);
+}
+
+void BicStatistics::append(const vector<Real>& frame) {
+  if (int(frame.size()) != _nFeatures) {
+    throw EssentiaException("SBic: all frames should have the same number of features, expected ", _nFeatures, " but got ", frame.size());
+  }
+
+  int last = int(_sums.size()) - _nFeatures;
+  _sums.resize(_sums.size() + _nFeatures);
+  _squares.resize(_squares.size() + _nFeatures);
+
+  for (int i=0; i<_nFeatures; ++i) {
+    double a = frame[i];
+    _sums[last + _nFeatures + i] = _sums[last + i] + a;
+    _squares[last + _nFeatures + i] = _squares[last + i] + a * a;
+  }
 }
 
-// This function returns the logarithm of the determinant of (the covariance) matrix
-// Seems kind of magic that all together can be computed in just few lines...
-Real SBic::logDet(const Array2D<Real>& matrix) const {
+void BicStatistics::discardBefore(int frame) {
+  // only erase when it frees at least half of the memory, so that appending
+  // stays amortized O(nFeatures)
+  int rows = frame - _first;
+  if (rows <= 0 || rows * _nFeatures < int(_sums.size()) / 2) return;
 
-  // Remember dimensions are swapped: dim1 is the number of features and dim2 is the number of frames!
+  _sums.erase(_sums.begin(), _sums.begin() + rows * _nFeatures);
+  _squares.erase(_squares.begin(), _squares.begin() + rows * _nFeatures);
+  _first = frame;
+}
+
+// This function returns the logarithm of the determinant of the covariance
+// matrix of the frames [begin, end]
+Real BicStatistics::logDet(int begin, int end) const {
 
   // As we are computing the determinant of the covariance matrix and this matrix is known to be symmetric
   // and positive definite, we can apply  the cholesky decomposition: A = LL*.
@@ -73,87 +93,61 @@ Real SBic::logDet(const Array2D<Real>& matrix) const {
   // Due to computing the log_determinant, then log(prod(a_ii])) = sum(log(a_ii))
   // http://en.wikipedia.org/wiki/Cholesky_decomposition
 
-  int dim1 = matrix.dim1();
-  int dim2 = matrix.dim2();
-
-  vector<Real> mp(dim1, 0.0);
-  vector<Real> vp(dim1, 0.0);
-  Real a, logd = 0.0;
-  Real z = 1.0 / Real(dim2);
-  Real zz = z * z;
+  if (end < begin || _nFeatures == 0) return 0.0;
 
   // As for computing the determinant we are only interested in the diagonal of the covariance matrix, which for
   // each feature vector is:
   // 1/n(sum(x_ii - mu_i)^2) = 1/n(sum(x_i^2) - 2*mu_i*sum(x_i) + sum(mu_i)^2) =
   // 1/n(sum(x_i^2) - 2*n*mu_i*mu_i + n*mu_i^2) = 1/n(sum(x_i^2) - n*mu^2) = 1/n*sum(x_i^2)+ mu_i^2
-  // where mu_i is the mean of feature i, and n is the number of frames
+  // where mu_i is the mean of feature i, and n is the number of frames.
+  // The sums of x_i and x_i^2 over the range are the differences of the prefix sums at both ends.
 
-  for (int i=0; i<dim1; ++i) {
-    for (int j=0; j<dim2; ++j) {
-      a = matrix[i][j];
-      mp[i] += a;
-      vp[i] += a * a;
-    }
-  }
+  const double* mp0 = &_sums[(begin - _first) * _nFeatures];
+  const double* mp1 = &_sums[(end + 1 - _first) * _nFeatures];
+  const double* vp0 = &_squares[(begin - _first) * _nFeatures];
+  const double* vp1 = &_squares[(end + 1 - _first) * _nFeatures];
+
+  double z = 1.0 / double(end - begin + 1);
+  Real logd = 0.0;
 
-  // this code accumulates rounding errors which causes bad behaviour when input features are constant.
-  // A possible soultion would be to check for a higher threshold (1e-6), as constant features should
-  // give a covariance of zero, because (x_i - mu)^2 = 0
-  Real diag_cov = 0.0; // diagonal values of the covariance matrix
-  for (int j=0; j<dim1; ++j) {
-    diag_cov = vp[j] * z - mp[j] * mp[j] * zz; // 1/n*sum(x_i^2)+ mu_i^2.
+  for (int i=0; i<_nFeatures; ++i) {
+    double mean = (mp1[i] - mp0[i]) * z;
+    double diag_cov = (vp1[i] - vp0[i]) * z - mean * mean; // 1/n*sum(x_i^2)+ mu_i^2.
     // although it could be zero when input is constant, this operation can never be negative by definition
     // however due to rounding errors, it does get negative at times with values of order 1e-9, thus we convert
     // them to zero (1e-10), bounding the logarithm to -10
-    logd += diag_cov > 1e-5 ? log(diag_cov):-5;
+    logd += diag_cov > 1e-5 ? Real(log(diag_cov)) : -5;
   }
 
   return logd;
-
-  // another way of computing the same as above, with possibly less rounding errors, but more expensive.
-  //vector<Real> cov(dim1, 0.0);
-  //for (int i=0; i<dim1; ++i) {
-  //  Real mean = mp[i]/dim2;
-  //  Real cov = 0.0;
-  //  for (int j=0; j<dim2; ++j) {
-  //    a = matrix[i][j];
-  //    cov += (a-mean)*(a-mean);
-  //  }
-  //  cov /= dim2;
-  //  logd += cov > 0 ? log(cov):-30;
-  //}
 }
 
-// This function finds the next change in matrix
-int SBic::bicChangeSearch(const Array2D<Real>& matrix, int inc, int current) const {
-  int nFeatures = matrix.dim1();
-  int nFrames = matrix.dim2();
+// This function finds the next change in the frames [begin, end]
+int BicStatistics::changeSearch(int begin, int end, int inc, Real penalty) const {
+  int nFrames = end - begin + 1;
 
-  Real d, dmin, penalty;
+  Real d, dmin;
   Real s, s1, s2;
-  Array2D<Real> half;
   int n1, n2, seg = 0, shift = inc-1;
 
   // according to the paper the penalty coefficient should be the following:
   // penalty = 0.5*(3*nFeatures + nFeatures*nFeatures);
 
-  penalty = _cpw * _cp * log(Real(nFrames));
+  penalty *= log(Real(nFrames));
   dmin = numeric_limits<Real>::max();
 
   // log-determinant for the entire window
-  s = logDet(matrix);
+  s = logDet(begin, end);
 
   // loop on all mid positions
   while (shift < nFrames - inc) {
     // first part
     n1 = shift + 1;
-    half = subarray(matrix, 0, nFeatures-1, 0, shift);
-    s1 = logDet(half);
+    s1 = logDet(begin, begin + shift);
 
     // second part
     n2 = nFrames - n1;
-    half = subarray(matrix, 0, nFeatures-1, shift+1, nFrames-1);
-    s2 = logDet(half);
+    s2 = logDet(begin + shift + 1, end);
 
     d = 0.5 * (n1*s1 + n2*s2 - nFrames*s + penalty);
 
@@ -166,33 +160,30 @@ int SBic::bicChangeSearch(const Array2D<Real>& matrix, int inc, int current) con
 
   if (dmin > 0) return 0;
 
-  return current + seg;
+  return begin + seg;
 }
 
 // This function computes the delta bic. It is actually used to determine
 // whether two consecutive segments have the same probability distribution
 // or not. In such case, these segments are joined.
-Real SBic::delta_bic(const Array2D<Real>& matrix, Real segPoint) const{
-
-  int nFeatures = matrix.dim1();
-  int nFrames = matrix.dim2();
-  Array2D<Real> half;
+Real BicStatistics::deltaBic(int begin, int end, Real segPoint, Real penalty) const {
+  int nFrames = end - begin + 1;
   Real s, s1, s2;
 
   // entire segment
-  s = logDet(matrix);
+  s = logDet(begin, end);
 
   // first half
-  half = subarray(matrix, 0, nFeatures-1, 0, int(segPoint));
-  s1 = logDet(half);
+  s1 = logDet(begin, min(begin + int(segPoint), end));
 
   // second half
-  half = subarray(matrix, 0, nFeatures-1, int(segPoint + 1), nFrames-1);
-  s2 = logDet(half);
+  s2 = logDet(begin + int(segPoint + 1), end);
 
-  return 0.5 * ( segPoint*s1 + (nFrames - segPoint)*s2 - nFrames*s + _cpw*_cp*log(Real(nFrames)) );
+  return 0.5 * ( segPoint*s1 + (nFrames - segPoint)*s2 - nFrames*s + penalty*log(Real(nFrames)) );
 }
 
+} // namespace essentia
+
 
 void SBic::configure() {
   _size1 = parameter("size1").toInt();
@@ -206,7 +197,6 @@ void SBic::configure() {
 void SBic::compute() {
   const Array2D<Real>& features = _features.get();
   vector<Real>& segmentation = _segmentation.get();
-  Array2D<Real> window;
 
   int currSeg = 0, endSeg = 0, currIdx, prevSeg, nextSeg, i;
 
@@ -227,6 +217,16 @@ void SBic::compute() {
   }
 
   _cp = 2 * nFeatures;
+  Real penalty = _cpw * _cp;
+
+  // the windows of all the passes are ranges of frames of the whole matrix,
+  // accumulate it once so that their covariances don't depend on their size
+  _statistics.clear(nFeatures);
+  vector<Real> frame(nFeatures);
+  for (int j=0; j<nFrames; ++j) {
+    for (int k=0; k<nFeatures; ++k) frame[k] = features[k][j];
+    _statistics.append(frame);
+  }
 
   ///////////////////////////////////
   // first pass - coarse segmentation
@@ -235,10 +235,8 @@ void SBic::compute() {
     endSeg += _size1;
     if (endSeg >= nFrames) endSeg = nFrames-1;
 
-    window = subarray(features, 0, nFeatures-1, currSeg, endSeg);
-
     // A change has been found
-    if ((i = bicChangeSearch(window, _inc1, currSeg))) {
+    if ((i = _statistics.changeSearch(currSeg, endSeg, _inc1, penalty))) {
       segmentation.push_back(i);
       currSeg = (i + _inc1);
       endSeg = currSeg - 1;
@@ -259,10 +257,8 @@ void SBic::compute() {
 
     if (endSeg >= nFrames) endSeg = nFrames-1;
 
-    window = subarray(features, 0, nFeatures-1, currSeg, endSeg);
-
     // A change has been found
-    if ((i = bicChangeSearch(window, _inc2, currSeg))) {
+    if ((i = _statistics.changeSearch(currSeg, endSeg, _inc2, penalty))) {
       prevSeg = (currIdx == 0) ? 0 : int(segmentation[currIdx-1]);
       nextSeg = (currIdx + 1 >= int(segmentation.size())) ? nFrames - 1 : int(segmentation[currIdx + 1]);
 
@@ -326,8 +322,7 @@ void SBic::compute() {
   // verify delta_bic is negative between consecutive segments
   for (i=1; i<int(segmentation.size())-1; ++i) {
     endSeg = int(segmentation[i+1]);
-    window = subarray(features, 0, nFeatures-1, currSeg, endSeg);
-    if (delta_bic(window, segmentation[i] - segmentation[i - 1]) > 0) {
+    if (_statistics.deltaBic(currSeg, endSeg, segmentation[i] - segmentation[i - 1], penalty) > 0) {
       segmentation.erase(segmentation.begin() + i);
       --i;
       continue;
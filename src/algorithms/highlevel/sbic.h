@@ -24,6 +24,68 @@
 #include "tnt/tnt.h"
 
 namespace essentia {
+
+/**
+ * Running sums of the features and of their squares, frame after frame. The
+ * diagonal covariance of any range of frames, and thus the BIC values used by
+ * SBic, can be computed from them in O(nFeatures), without going through the
+ * frames of the range. The sums are kept in double precision, as they are
+ * subtracted from each other.
+ */
+class BicStatistics {
+ public:
+  BicStatistics() : _nFeatures(0), _first(0) {}
+
+  /**
+   * Removes all the frames, and sets the number of features of the next ones.
+   */
+  void clear(int nFeatures);
+
+  /**
+   * Appends a frame of nFeatures values.
+   */
+  void append(const std::vector<Real>& frame);
+
+  /**
+   * Frees the sums of the frames before the given one, which cannot be used
+   * in any range anymore.
+   */
+  void discardBefore(int frame);
+
+  /**
+   * @returns the number of frames appended since the last call to clear().
+   */
+  int size() const { return _nFeatures ? _first + int(_sums.size() / _nFeatures) - 1 : 0; }
+
+  int nFeatures() const { return _nFeatures; }
+
+  /**
+   * @returns the logarithm of the determinant of the diagonal covariance
+   * matrix of the frames [begin, end], or 0 if the range is empty.
+   */
+  Real logDet(int begin, int end) const;
+
+  /**
+   * Searches the frames [begin, end] for the split point which minimizes the
+   * BIC differential, trying every @e inc frames. @returns the index of the
+   * last frame before the change, or 0 if no split makes the BIC decrease.
+   */
+  int changeSearch(int begin, int end, int inc, Real penalty) const;
+
+  /**
+   * @returns the BIC differential of splitting the frames [begin, end] after
+   * frame begin + segPoint.
+   */
+  Real deltaBic(int begin, int end, Real segPoint, Real penalty) const;
+
+ protected:
+  int _nFeatures;
+  int _first; // index of the frame whose sums are stored first
+  // prefix sums: row r holds the sums of the frames before _first + r
+  std::vector<double> _sums;
+  std::vector<double> _squares;
+};
+
 namespace standard {
 
 class SBic : public Algorithm {
@@ -39,6 +101,7 @@ class SBic : public Algorithm {
   Real _cpw;
   int _minLength;
   Real _cp; // complexity penalty
+  BicStatistics _statistics;
 
  public:
   SBic() {
@@ -64,11 +127,6 @@ class SBic : public Algorithm {
   static const char* category;
   static const char* description;
 
- private:
-  Real logDet(const TNT::Array2D<Real>& matrix) const;
-  int bicChangeSearch(const TNT::Array2D<Real>& matrix, int inc, int current) const;
-  Real delta_bic(const TNT::Array2D<Real>& matrix, Real segPoint) const;
-
 };
 
 } // namespace standard
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "sbiconline.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace essentia {
+namespace streaming {
+
+const char* SBicOnline::name = "SBicOnline";
+const char* SBicOnline::category = "Segmentation";
+const char* SBicOnline::description = DOC("This algorithm segments audio using the Bayesian Information Criterion given a stream of frame features, and outputs the change points as soon as they are found. It is the streaming counterpart of the SBic algorithm, which needs the features of the whole signal: the coarse and fine segmentation passes are the same and are run as soon as enough frames are available, so that the memory used only depends on the length of the current segment.\n"
+"\n"
+"The validation pass can only look one change point ahead, as the change points are output as soon as they are validated: a change point is dropped if the segment it ends is shorter than 'minLength', or if the BIC differential between this segment and the next one is positive. The result can thus differ slightly from the one of SBic, which can also merge a short segment with the previous one.\n"
+"\n"
+"All units are in terms of frames, and the first and last frames are not output as change points.\n"
+"\n"
+"References:\n"
+"  [1] Audioseg, http://audioseg.gforge.inria.fr\n\n"
+"  [2] G. Gravier, M. Betser, and M. Ben, Audio Segmentation Toolkit,\n"
+"  release 1.2, 2010. Available online:\n"
+"  https://gforge.inria.fr/frs/download.php/25187/audioseg-1.2.pdf\n");
+
+
+void SBicOnline::configure() {
+  _size1 = parameter("size1").toInt();
+  _inc1 = parameter("inc1").toInt();
+  _size2 = parameter("size2").toInt();
+  _inc2 = parameter("inc2").toInt();
+  _cpw = parameter("cpw").toReal();
+  _minLength = parameter("minLength").toInt();
+
+  reset();
+}
+
+void SBicOnline::reset() {
+  Algorithm::reset();
+
+  // the number of features is only known with the first frame
+  _statistics.clear(0);
+  _penalty = 0;
+
+  _currSeg = 0;
+  _endSeg = -1;
+  _coarse.clear();
+  _refined = 0;
+  _pending.clear();
+  _lastChange = 0;
+}
+
+// first pass - coarse segmentation, in windows of size1 frames which grow
+// until a change is found
+void SBicOnline::coarseSearch(int nFrames, bool endOfStream) {
+  while (true) {
+    int endSeg = _endSeg + _size1;
+
+    if (endSeg >= nFrames) {
+      // the last window is only cut at the end of the stream
+      if (!endOfStream || _endSeg >= nFrames-1) break;
+      endSeg = nFrames-1;
+    }
+    _endSeg = endSeg;
+
+    int i = _statistics.changeSearch(_currSeg, _endSeg, _inc1, _penalty);
+
+    // A change has been found
+    if (i) {
+      _coarse.push_back(i);
+      _currSeg = i + _inc1;
+      _endSeg = _currSeg - 1;
+    }
+  }
+}
+
+// second pass - fine segmentation, around each change of the first pass once
+// the next one is known
+void SBicOnline::fineSearch(int nFrames, bool endOfStream) {
+  int halfSize = _size2 / 2;
+
+  while (!_coarse.empty()) {
+    if (_coarse.size() < 2 && !endOfStream) break;
+
+    int change = _coarse.front();
+    int currSeg = max(change - halfSize, 0);
+    int endSeg = currSeg + _size2 - 1;
+
+    if (endSeg >= nFrames) {
+      if (!endOfStream) break;
+      endSeg = nFrames-1;
+    }
+
+    int i = _statistics.changeSearch(currSeg, endSeg, _inc2, _penalty);
+    _coarse.pop_front();
+
+    if (i) {
+      int nextSeg = _coarse.empty() ? nFrames - 1 : _coarse.front();
+
+      // We remove the segmentation if the refined change is out of bounds
+      if (i < _refined || i > nextSeg) continue;
+
+      // We move (refine) the segmentation
+      change = i;
+    }
+
+    _pending.push_back(change);
+    _refined = change;
+  }
+}
+
+// third pass - segment validation, each change is checked against the
+// previous one which has been output and the next one
+void SBicOnline::validate(int nFrames, bool endOfStream) {
+  while (!_pending.empty()) {
+    if (_pending.size() < 2 && !endOfStream) break;
+
+    int change = _pending.front();
+    int nextSeg = _pending.size() < 2 ? nFrames - 1 : _pending[1];
+    _pending.pop_front();
+
+    // verify that segments are above minimum-length treshold
+    if (change - _lastChange < _minLength) continue;
+    if (_pending.empty() && endOfStream && nextSeg - change < _minLength) continue;
+
+    // verify delta_bic is negative between consecutive segments
+    int currSeg = _lastChange == 0 ? 0 : _lastChange + 1;
+    if (_statistics.deltaBic(currSeg, nextSeg, Real(change - _lastChange), _penalty) > 0) continue;
+
+    _changePoints.push(Real(change));
+    _lastChange = change;
+  }
+}
+
+AlgorithmStatus SBicOnline::process() {
+  // change points are pushed as they are found, only the input is acquired
+  if (!_features.acquire(1)) {
+    if (!shouldStop()) return NO_INPUT;
+
+    // We only have enough frames for one segment
+    int nFrames = _statistics.size();
+    if (nFrames < 2 || nFrames <= _minLength-1) return FINISHED;
+
+    coarseSearch(nFrames, true);
+    fineSearch(nFrames, true);
+    validate(nFrames, true);
+
+    return FINISHED;
+  }
+
+  const vector<Real>& frame = _features.firstToken();
+
+  if (_statistics.nFeatures() == 0) {
+    if (frame.empty()) {
+      throw EssentiaException("SBicOnline: the frames of features should not be empty");
+    }
+    _statistics.clear(frame.size());
+    _penalty = _cpw * 2 * frame.size();
+  }
+
+  _statistics.append(frame);
+  _features.release(1);
+
+  int nFrames = _statistics.size();
+  coarseSearch(nFrames, false);
+  fineSearch(nFrames, false);
+  validate(nFrames, false);
+
+  // the windows of the next searches never start before these frames: the
+  // fine window of a change still to be found by the first pass starts at
+  // most size2/2 frames before its earliest position, _currSeg + inc1 - 1
+  int first = min(_currSeg, _lastChange);
+  first = min(first, max(_currSeg + _inc1 - 1 - _size2 / 2, 0));
+  if (!_coarse.empty()) first = min(first, max(_coarse.front() - _size2 / 2, 0));
+  _statistics.discardBefore(first);
+
+  return OK;
+}
+
+} // namespace streaming
+} // namespace essentia
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_SBICONLINE_H
+#define ESSENTIA_SBICONLINE_H
+
+#include <deque>
+#include "streamingalgorithm.h"
+#include "sbic.h"
+
+namespace essentia {
+namespace streaming {
+
+class SBicOnline : public Algorithm {
+
+ protected:
+  Sink<std::vector<Real> > _features;
+  Source<Real> _changePoints;
+
+  int _size1;
+  int _inc1;
+  int _size2;
+  int _inc2;
+  Real _cpw;
+  int _minLength;
+  Real _penalty;
+
+  BicStatistics _statistics;
+
+  int _currSeg;              // first frame of the current coarse window
+  int _endSeg;               // last frame of the last coarse window searched
+  std::deque<int> _coarse;   // changes found by the first pass, not refined yet
+  int _refined;              // last change kept by the second pass
+  std::deque<int> _pending;  // refined changes, not validated yet
+  int _lastChange;           // last change which has been output
+
+  void coarseSearch(int nFrames, bool endOfStream);
+  void fineSearch(int nFrames, bool endOfStream);
+  void validate(int nFrames, bool endOfStream);
+
+ public:
+  SBicOnline() : Algorithm() {
+    declareInput(_features, 1, "features", "the features of each frame");
+    declareOutput(_changePoints, 0, "changePoints", "the indices of the frames where a segment ends, output as soon as they are validated");
+  }
+
+  void declareParameters() {
+    declareParameter("size1", "first pass window size [frames]", "[1,inf)", 300);
+    declareParameter("inc1", "first pass increment [frames]", "[1,inf)", 60);
+    declareParameter("size2", "second pass window size [frames]", "[1,inf)", 200);
+    declareParameter("inc2", "second pass increment [frames]", "[1,inf)", 20);
+    declareParameter("cpw", "complexity penalty weight", "[0,inf)", 1.5);
+    declareParameter("minLength", "minimum length of a segment [frames]", "[1,inf)", 10);
+  }
+
+  void configure();
+  AlgorithmStatus process();
+  void reset();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_SBICONLINE_H
@@ -31,6 +31,7 @@ const char* AudioLoader::category = "Input/output";
 const char* AudioLoader::description = DOC("This algorithm loads the single audio stream contained in a given audio or video file. Supported formats are all those supported by the ffmpeg library including wav, aiff, flac, ogg and mp3.\n"
 "\n"
 "This algorithm will throw an exception if it was not properly configured which is normally due to not specifying a valid filename. Invalid names comprise those with extensions different than the supported  formats and non existent files. If using this algorithm on Windows, you must ensure that the filename is encoded as UTF-8\n\n"
+"When the 'asynchronous' parameter is set, the file is demuxed and decoded in a separate thread which runs ahead of the rest of the network, so that decoding and analysis can run concurrently. The output is the same as in synchronous mode. This option is ignored on Windows.\n\n"
 "Note: ogg files are decoded in reverse phase, due to be using ffmpeg library.\n"
 "\n"
 "References:\n"
@@ -46,12 +47,22 @@ const char* AudioLoader::description = DOC("This algorithm loads the single audi
 "      http://en.wikipedia.org/wiki/Mp3");
 
 
+ForcedMutex AudioLoader::globalAVCodecMutex;
+
 AudioLoader::~AudioLoader() {
+#ifndef OS_WIN32
+    stopDecodeThread();
+#endif
     closeAudioFile();
 
     av_freep(&_buffer);
     av_freep(&_md5Encoded);
     av_freep(&_decodedFrame);
+
+#ifndef OS_WIN32
+    pthread_cond_destroy(&_decodeCond);
+    pthread_mutex_destroy(&_decodeMutex);
+#endif
 }
 
 void AudioLoader::configure() {
@@ -61,6 +72,21 @@ void AudioLoader::configure() {
     //av_log_set_level(AV_LOG_VERBOSE);
     _computeMD5 = parameter("computeMD5").toBool();
     _selectedStream = parameter("audioStream").toInt();
+#ifndef OS_WIN32
+    // the decode thread writes to the intermediate buffer, stop it before
+    // resizing the buffer, which is only large in asynchronous mode
+    stopDecodeThread();
+    bool asynchronous = parameter("asynchronous").toBool();
+    if (asynchronous && !_asynchronous) {
+        _decoded.setBufferType(BufferUsage::forLargeAudioStream);
+        connect(_decoded, _decodedReader);
+    }
+    else if (!asynchronous && _asynchronous) {
+        disconnect(_decoded, _decodedReader);
+        _decoded.setBufferType(BufferUsage::forSingleFrames);
+    }
+    _asynchronous = asynchronous;
+#endif
     reset();
 }
 
@@ -119,8 +145,11 @@ void AudioLoader::openAudioFile(const string& filename) {
         throw EssentiaException("AudioLoader: Unsupported codec!");
     }
 
-    if (avcodec_open2(_audioCtx, _audioCodec, NULL) < 0) {
-        throw EssentiaException("AudioLoader: Unable to instantiate codec...");
+    {
+        ForcedMutexLocker lock(globalAVCodecMutex);
+        if (avcodec_open2(_audioCtx, _audioCodec, NULL) < 0) {
+            throw EssentiaException("AudioLoader: Unable to instantiate codec...");
+        }
     }
   
     // Configure format convertion  (no samplerate conversion yet)
@@ -168,7 +197,10 @@ void AudioLoader::closeAudioFile() {
     }
 
     // Close the codec
-    avcodec_close(_audioCtx);
+    {
+        ForcedMutexLocker lock(globalAVCodecMutex);
+        avcodec_close(_audioCtx);
+    }
 
     // Close the audio file
     avformat_close_input(&_demuxCtx);
@@ -217,6 +249,33 @@ AlgorithmStatus AudioLoader::process() {
         throw EssentiaException("AudioLoader: Trying to call process() on an AudioLoader algo which hasn't been correctly configured.");
     }
 
+#ifndef OS_WIN32
+    if (_asynchronous) return forwardDecodedSamples();
+#endif
+
+    if (!readPacket()) {
+        flushPacket();
+        finalizeMD5();
+        return finish();
+    }
+
+    // decode frames in packet
+    while(_packet.size > 0) {
+        if (!decodePacket()) break;
+        copyFFmpegOutput();
+    }
+    // neds to be freed !!
+    av_free_packet(&_packet);
+
+    return OK;
+}
+
+
+/**
+ * Reads the next packet of the selected audio stream into _packet, and updates
+ * the md5 checksum with it. Returns false when there are no more packets.
+ */
+bool AudioLoader::readPacket() {
     // read frames until we get a good one
     do {
         int result = av_read_frame(_demuxCtx, &_packet);
@@ -232,18 +291,7 @@ AlgorithmStatus AudioLoader::process() {
             }
             // TODO: should try reading again on EAGAIN error?
             //       https://github.com/FFmpeg/FFmpeg/blob/master/ffmpeg.c
-            shouldStop(true);
-            flushPacket();
-            closeAudioFile();
-            if (_computeMD5) {
-                av_md5_final(_md5Encoded, _checksum);
-                _md5.push(uint8_t_to_hex(_checksum, 16));
-            }
-            else {
-                string md5 = "";
-                _md5.push(md5);
-            }
-            return FINISHED;
+            return false;
         }
     } while (_packet.stream_index != _streamIdx);
 
@@ -252,17 +300,167 @@ AlgorithmStatus AudioLoader::process() {
         av_md5_update(_md5Encoded, _packet.data, _packet.size);
     }
 
-    // decode frames in packet
-    while(_packet.size > 0) {
-        if (!decodePacket()) break;
-        copyFFmpegOutput();
+    return true;
+}
+
+
+void AudioLoader::finalizeMD5() {
+    if (_computeMD5) {
+        av_md5_final(_md5Encoded, _checksum);
+        _md5Result = uint8_t_to_hex(_checksum, 16);
     }
-    // neds to be freed !!
-    av_free_packet(&_packet);
-    
+    else {
+        _md5Result = "";
+    }
+}
+
+
+/**
+ * Called once all the audio has been decoded and sent to the output.
+ */
+AlgorithmStatus AudioLoader::finish() {
+    shouldStop(true);
+    closeAudioFile();
+    _md5.push(_md5Result);
+    return FINISHED;
+}
+
+
+#ifndef OS_WIN32
+
+void* AudioLoader::decodeThreadMain(void* arg) {
+    static_cast<AudioLoader*>(arg)->decodeLoop();
+    return 0;
+}
+
+/**
+ * Body of the decode thread: this is the same as calling process() until the
+ * end of the file in synchronous mode, except that the samples are written to
+ * the _decoded buffer instead of the audio output.
+ */
+void AudioLoader::decodeLoop() {
+    // any exception has to be caught here, as it can't leave the thread; it
+    // is rethrown by process()
+    try {
+        while (readPacket()) {
+            // the packet needs to be freed however its decoding ends, e.g.
+            // when copyFFmpegOutput() throws because we're asked to stop
+            try {
+                while (_packet.size > 0) {
+                    if (!decodePacket()) break;
+                    copyFFmpegOutput();
+                }
+            }
+            catch (...) {
+                av_free_packet(&_packet);
+                throw;
+            }
+            av_free_packet(&_packet);
+        }
+        flushPacket();
+        finalizeMD5();
+    }
+    catch (EssentiaException& e) {
+        _decodeError = e.what();
+    }
+    catch (std::exception& e) {
+        _decodeError = string("AudioLoader: error in the decode thread: ") + e.what();
+    }
+    catch (...) {
+        _decodeError = "AudioLoader: unknown error in the decode thread";
+    }
+
+    pthread_mutex_lock(&_decodeMutex);
+    _decodeFinished = true;
+    pthread_cond_broadcast(&_decodeCond);
+    pthread_mutex_unlock(&_decodeMutex);
+}
+
+void AudioLoader::startDecodeThread() {
+    _decodeFinished = false;
+    _stopDecoding = false;
+    _decodeError.clear();
+
+    if (pthread_create(&_decodeThread, 0, &AudioLoader::decodeThreadMain, this) != 0) {
+        throw EssentiaException("AudioLoader: could not create decode thread");
+    }
+    _decodeThreadRunning = true;
+}
+
+void AudioLoader::stopDecodeThread() {
+    if (!_decodeThreadRunning) return;
+
+    pthread_mutex_lock(&_decodeMutex);
+    _stopDecoding = true;
+    pthread_cond_broadcast(&_decodeCond);
+    pthread_mutex_unlock(&_decodeMutex);
+
+    pthread_join(_decodeThread, 0);
+    _decodeThreadRunning = false;
+}
+
+/**
+ * Blocks until there are decoded samples to forward, or until the decode
+ * thread is done. Returns false if there will be no more samples.
+ */
+bool AudioLoader::waitForDecodedSamples() {
+    pthread_mutex_lock(&_decodeMutex);
+    while (_decodedReader.available() == 0 && !_decodeFinished) {
+        pthread_cond_wait(&_decodeCond, &_decodeMutex);
+    }
+    pthread_mutex_unlock(&_decodeMutex);
+
+    // the decode thread may have written its last samples just before finishing
+    return _decodedReader.available() > 0;
+}
+
+/**
+ * Called from the decode thread when the buffer is full, blocks until process()
+ * has read enough samples. Returns false if the thread has been asked to stop
+ * in the meantime.
+ */
+bool AudioLoader::waitForFreeSpace(int nsamples) {
+    bool ok = false;
+    pthread_mutex_lock(&_decodeMutex);
+    while (!(ok = _decoded.acquire(nsamples)) && !_stopDecoding) {
+        pthread_cond_wait(&_decodeCond, &_decodeMutex);
+    }
+    pthread_mutex_unlock(&_decodeMutex);
+    return ok;
+}
+
+AlgorithmStatus AudioLoader::forwardDecodedSamples() {
+    if (!waitForDecodedSamples()) {
+        stopDecodeThread();
+        if (!_decodeError.empty()) {
+            throw EssentiaException(_decodeError);
+        }
+        return finish();
+    }
+
+    int nsamples = std::min(_decodedReader.available(),
+                            _audio.bufferInfo().maxContiguousElements);
+
+    if (!_audio.acquire(nsamples)) {
+        throw EssentiaException("AudioLoader: could not acquire output for audio");
+    }
+    _decodedReader.acquire(nsamples);
+
+    fastcopy(&_audio.firstToken(), &_decodedReader.firstToken(), nsamples);
+
+    _audio.release(nsamples);
+    _decodedReader.release(nsamples);
+
+    // let the decode thread know there is free space again
+    pthread_mutex_lock(&_decodeMutex);
+    pthread_cond_broadcast(&_decodeCond);
+    pthread_mutex_unlock(&_decodeMutex);
+
     return OK;
 }
 
+#endif // OS_WIN32
+
 
 int AudioLoader::decode_audio_frame(AVCodecContext* audioCtx,
                                     float* output,
@@ -445,13 +643,20 @@ void AudioLoader::copyFFmpegOutput() {
     int nsamples = _dataSize / (av_get_bytes_per_sample(AV_SAMPLE_FMT_FLT)  * _nChannels);
     if (nsamples == 0) return;
 
+    // in asynchronous mode, samples are not sent to the output directly but
+    // to the buffer which is read by process()
+    Source<StereoSample>& output = _asynchronous ? _decoded : _audio;
+
     // acquire necessary data
-    bool ok = _audio.acquire(nsamples);
+    bool ok = output.acquire(nsamples);
+#ifndef OS_WIN32
+    if (!ok && _asynchronous) ok = waitForFreeSpace(nsamples);
+#endif
     if (!ok) {
         throw EssentiaException("AudioLoader: could not acquire output for audio");
     }
 
-    vector<StereoSample>& audio = *((vector<StereoSample>*)_audio.getTokens());
+    vector<StereoSample>& audio = *((vector<StereoSample>*)output.getTokens());
 
     if (_nChannels == 1) {
         for (int i=0; i<nsamples; i++) {
@@ -477,11 +682,24 @@ void AudioLoader::copyFFmpegOutput() {
     }
 
     // release data
-    _audio.release(nsamples);
+    output.release(nsamples);
+
+#ifndef OS_WIN32
+    if (_asynchronous) {
+        pthread_mutex_lock(&_decodeMutex);
+        pthread_cond_broadcast(&_decodeCond);
+        pthread_mutex_unlock(&_decodeMutex);
+    }
+#endif
 }
 
 void AudioLoader::reset() {
+#ifndef OS_WIN32
+    // the decode thread uses the file, so it needs to be stopped first
+    stopDecodeThread();
+#endif
     Algorithm::reset();
+    _decoded.reset();
 
     if (!parameter("filename").isConfigured()) return;
 
@@ -492,6 +710,12 @@ void AudioLoader::reset() {
 
     pushChannelsSampleRateInfo(_audioCtx->channels, _audioCtx->sample_rate);
     pushCodecInfo(_audioCodec->name, _audioCtx->bit_rate);
+
+#ifndef OS_WIN32
+    // start decoding right away, so that samples are ready by the time the
+    // network starts
+    if (_asynchronous) startDecodeThread();
+#endif
 }
 
 } // namespace streaming
@@ -522,7 +746,8 @@ void AudioLoader::createInnerNetwork() {
 void AudioLoader::configure() {
     _loader->configure(INHERIT("filename"),
                        INHERIT("computeMD5"),
-                       INHERIT("audioStream"));
+                       INHERIT("audioStream"),
+                       INHERIT("asynchronous"));
 }
 
 void AudioLoader::compute() {
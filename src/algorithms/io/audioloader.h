@@ -24,6 +24,7 @@
 #include "network.h"
 #include "ffmpegapi.h"
 #include "poolstorage.h"
+#include "threading.h"
 
 
 #define MAX_AUDIO_FRAME_SIZE 192000
@@ -66,7 +67,40 @@ class AudioLoader : public Algorithm {
   std::vector<int> _streams;
   int _selectedStream;
   bool _configured;
-
+  std::string _md5Result;
+
+  // opening and closing codecs is not thread-safe in libavcodec, this makes
+  // it possible to load multiple files concurrently from different threads
+  // (the codecs opened internally by libavformat are protected by the lock
+  // manager registered in initFFmpeg())
+  static ForcedMutex globalAVCodecMutex;
+
+  // In asynchronous mode, demuxing, decoding and sample format conversion are
+  // done in a separate thread, which writes the decoded samples to a bounded
+  // lock-free buffer; process() then only forwards the samples that are ready.
+  // Threads are only available with pthreads, on windows the audio is always
+  // decoded synchronously.
+  bool _asynchronous;
+  Source<StereoSample> _decoded;
+  Sink<StereoSample> _decodedReader;
+
+#ifndef OS_WIN32
+  pthread_t _decodeThread;
+  pthread_mutex_t _decodeMutex;
+  pthread_cond_t _decodeCond; // signalled whenever samples are written or read
+  bool _decodeThreadRunning;
+  bool _decodeFinished;
+  bool _stopDecoding;
+  std::string _decodeError;
+
+  static void* decodeThreadMain(void* arg);
+  void decodeLoop();
+  void startDecodeThread();
+  void stopDecodeThread();
+  bool waitForDecodedSamples();
+  bool waitForFreeSpace(int nsamples);
+  AlgorithmStatus forwardDecodedSamples();
+#endif
 
   void openAudioFile(const std::string& filename);
   void closeAudioFile();
@@ -75,15 +109,19 @@ class AudioLoader : public Algorithm {
   void pushCodecInfo(std::string codec, int bit_rate);
   int decode_audio_frame(AVCodecContext* audioCtx, float* output,
                          int* outputSize, AVPacket* packet);
+  bool readPacket();
   int decodePacket();
   void flushPacket();
+  void finalizeMD5();
   void copyFFmpegOutput();
+  AlgorithmStatus finish();
 
 
  public:
   AudioLoader() : Algorithm(), _buffer(0),  _demuxCtx(0),
 	          _audioCtx(0), _audioCodec(0), _decodedFrame(0),
-            _convertCtxAv(0), _configured(false) {
+            _convertCtxAv(0), _configured(false), _asynchronous(false),
+            _decoded("decoded"), _decodedReader("decodedReader") {
 
     declareOutput(_audio, 1, "audio", "the input audio signal");
     declareOutput(_sampleRate, 0, "sampleRate", "the sampling rate of the audio signal [Hz]");
@@ -94,8 +132,18 @@ class AudioLoader : public Algorithm {
 
     _audio.setBufferType(BufferUsage::forLargeAudioStream);
 
+    // the decode thread is the only writer and process() the only reader. The
+    // buffer is only sized and connected in configure(), in asynchronous mode
+    _decoded.setBufferThreadingPolicy(BufferThreading::LockFree);
+
+#ifndef OS_WIN32
+    _decodeThreadRunning = false;
+    pthread_mutex_init(&_decodeMutex, 0);
+    pthread_cond_init(&_decodeCond, 0);
+#endif
+
     // Register all formats and codecs
-    av_register_all();
+    initFFmpeg();
 
     // use av_malloc, because we _need_ the buffer to be 16-byte aligned
     _buffer = (float*)av_malloc(FFMPEG_BUFFER_SIZE);
@@ -115,6 +163,7 @@ class AudioLoader : public Algorithm {
     declareParameter("filename", "the name of the file from which to read", "", Parameter::STRING);
     declareParameter("computeMD5", "compute the MD5 checksum", "{true,false}", false);
     declareParameter("audioStream", "audio stream index to be loaded. Other streams are not taken into account (e.g. if stream 0 is video and 1 is audio use index 0 to access it.)", "[0,inf)", 0);
+    declareParameter("asynchronous", "decode the audio in a separate thread, ahead of the processing of the rest of the network", "{true,false}", false);
   }
 
   void configure();
@@ -176,6 +225,7 @@ class AudioLoader : public Algorithm {
     declareParameter("filename", "the name of the file from which to read", "", Parameter::STRING);
     declareParameter("computeMD5", "compute the MD5 checksum", "{true,false}", false);
     declareParameter("audioStream", "audio stream index to be loaded. Other streams are no taken into account (e.g. if stream 0 is video and 1 is audio use index 0 to access it.)", "[0,inf)", 0);
+    declareParameter("asynchronous", "decode the audio in a separate thread, ahead of the processing of the rest of the network", "{true,false}", false);
   }
 
   void configure();
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "binarypoolinput.h"
+#include "poolbinary.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* BinaryPoolInput::name = "BinaryPoolInput";
+const char* BinaryPoolInput::category = "Input/output";
+const char* BinaryPoolInput::description = DOC("This algorithm reads a Pool from a file written by the BinaryPoolOutput algorithm. The file is mapped in memory and each descriptor is converted from its column in one go, without any parsing of text.\n"
+"\n"
+"Files with compressed columns can only be read if Essentia has been compiled with zlib.");
+
+
+void BinaryPoolInput::configure() {
+  if (parameter("filename").isConfigured()) {
+    _filename = parameter("filename").toString();
+  }
+}
+
+void BinaryPoolInput::compute() {
+  if (!parameter("filename").isConfigured()) {
+    throw EssentiaException("BinaryPoolInput: 'filename' parameter has not been configured");
+  }
+  if (_filename == "") throw EssentiaException("BinaryPoolInput: please provide a valid filename");
+
+  try {
+    readPoolBinary(_filename, _pool.get());
+  }
+  catch (EssentiaException& e) {
+    throw EssentiaException("BinaryPoolInput: ", e.what());
+  }
+}
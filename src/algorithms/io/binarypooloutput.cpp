@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "binarypooloutput.h"
+#include "poolbinary.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* BinaryPoolOutput::name = "BinaryPoolOutput";
+const char* BinaryPoolOutput::category = "Input/output";
+const char* BinaryPoolOutput::description = DOC("This algorithm writes a Pool to a file in a compact binary format, which can be read back with the BinaryPoolInput algorithm. Contrary to YamlOutput, the values are not converted to text: each descriptor is stored as a typed column, where the real values of all the frames are stored one after the other as 32-bit little-endian floats. Frame-wise descriptors are thus much smaller and faster to write and read than in YAML or JSON.\n"
+"\n"
+"If 'compress' is true, the column of each descriptor is compressed with zlib (columns which are not made smaller are stored uncompressed). This is only available if Essentia has been compiled with zlib. Uncompressed columns are aligned so that the file can be mapped in memory and the values read in place by other programs.\n"
+"\n"
+"The specification of the format is given in src/essentia/utils/poolbinary.h.");
+
+
+void BinaryPoolOutput::configure() {
+  if (parameter("filename").isConfigured()) {
+    _filename = parameter("filename").toString();
+  }
+  _compress = parameter("compress").toBool();
+  _writeVersion = parameter("writeVersion").toBool();
+
+  if (_compress && !poolBinaryCompressionAvailable()) {
+    throw EssentiaException("BinaryPoolOutput: compression is not available, Essentia has been compiled without zlib");
+  }
+}
+
+void BinaryPoolOutput::compute() {
+  if (!parameter("filename").isConfigured()) {
+    throw EssentiaException("BinaryPoolOutput: 'filename' parameter has not been configured");
+  }
+  if (_filename == "") throw EssentiaException("BinaryPoolOutput: please provide a valid filename");
+
+  try {
+    writePoolBinary(_pool.get(), _filename, _compress, _writeVersion);
+  }
+  catch (EssentiaException& e) {
+    throw EssentiaException("BinaryPoolOutput: ", e.what());
+  }
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "mmapaudioloader.h"
+#include "algorithmfactory.h"
+#include <cstring>
+
+using namespace std;
+
+namespace essentia {
+namespace streaming {
+
+const char* MmapAudioLoader::name = "MmapAudioLoader";
+const char* MmapAudioLoader::category = "Input/output";
+const char* MmapAudioLoader::description = DOC("This algorithm loads the audio of an uncompressed file, either a WAV file or raw PCM samples without header, and outputs it downmixed to mono. Contrary to AudioLoader, the file is not decoded by ffmpeg: it is mapped in memory and the samples are converted to floating point directly from the mapped pages into the output buffer, so that loading long uncompressed recordings is almost free and the memory used does not depend on their length.\n"
+"\n"
+"Supported sample formats are 16, 24 and 32-bit integer PCM, and 32-bit floating point, with one or two channels. For raw files, the sample format, sampling rate and number of channels are given by the parameters, and the samples are little-endian and interleaved. Integer samples are scaled to [-1,1) as AudioLoader does. No resampling is done: the sampling rate of the file is output as 'sampleRate'.\n"
+"\n"
+"This algorithm will throw an exception if the file cannot be opened, or if it is not a WAV file with a supported sample format.\n"
+"\n"
+"References:\n"
+"  [1] WAV - Wikipedia, the free encyclopedia,\n"
+"      http://en.wikipedia.org/wiki/Wav");
+
+
+// WAV files are little-endian, whatever the endianness of the host
+inline int readInt16(const char* p) {
+  const unsigned char* b = (const unsigned char*)p;
+  return sint16(b[0] | (b[1] << 8));
+}
+
+inline int readInt24(const char* p) {
+  const unsigned char* b = (const unsigned char*)p;
+  return sint32((uint32(b[0]) << 8) | (uint32(b[1]) << 16) | (uint32(b[2]) << 24)) >> 8;
+}
+
+inline uint32 readUInt32(const char* p) {
+  const unsigned char* b = (const unsigned char*)p;
+  return uint32(b[0]) | (uint32(b[1]) << 8) | (uint32(b[2]) << 16) | (uint32(b[3]) << 24);
+}
+
+inline sint32 readInt32(const char* p) {
+  return sint32(readUInt32(p));
+}
+
+inline Real readFloat32(const char* p) {
+  uint32 bits = readUInt32(p);
+  float value;
+  memcpy(&value, &bits, sizeof(float));
+  return value;
+}
+
+template <typename Reader>
+void convertSamples(Real* output, const char* data, int nframes, int nChannels,
+                    int sampleBytes, int channel, Real scale, Reader read) {
+  if (channel >= 0) {
+    // a single channel is output, the other one (if any) is skipped
+    const char* p = data + channel*sampleBytes;
+    int step = nChannels * sampleBytes;
+    for (int i=0; i<nframes; ++i, p += step) output[i] = scale * read(p);
+  }
+  else {
+    // mix both channels, as MonoMixer does
+    Real mixScale = 0.5 * scale;
+    const char* p = data;
+    for (int i=0; i<nframes; ++i, p += 2*sampleBytes) {
+      output[i] = mixScale * (read(p) + read(p + sampleBytes));
+    }
+  }
+}
+
+
+void MmapAudioLoader::configure() {
+  string format = parameter("sampleFormat").toString();
+  if      (format == "int16") _format = INT16;
+  else if (format == "int24") _format = INT24;
+  else if (format == "int32") _format = INT32;
+  else                        _format = FLOAT32;
+
+  string downmix = parameter("downmix").toString();
+  if      (downmix == "left")  _downmix = LEFT;
+  else if (downmix == "right") _downmix = RIGHT;
+  else                         _downmix = MIX;
+
+  reset();
+}
+
+
+void MmapAudioLoader::openAudioFile(const string& filename) {
+  E_DEBUG(EAlgorithm, "MmapAudioLoader: opening file: " << filename);
+
+  try {
+    // the samples are read once from the beginning to the end
+    _file.open(filename, true);
+  }
+  catch (EssentiaException& e) {
+    throw EssentiaException("MmapAudioLoader: ", e.what());
+  }
+
+  _data = 0;
+  _nFrames = 0;
+}
+
+size_t MmapAudioLoader::parseWavHeader() {
+  const char* file = _file.data();
+  size_t fileSize = _file.size();
+
+  if (fileSize < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0) {
+    throw EssentiaException("MmapAudioLoader: the file is not a WAV file");
+  }
+
+  bool foundFormat = false;
+  size_t offset = 12;
+
+  while (offset + 8 <= fileSize) {
+    const char* chunk = file + offset;
+    size_t chunkSize = readUInt32(chunk + 4);
+    offset += 8;
+
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      if (chunkSize < 16 || offset + chunkSize > fileSize) {
+        throw EssentiaException("MmapAudioLoader: invalid WAV format chunk");
+      }
+      int formatTag = readInt16(chunk + 8) & 0xffff;
+      _nChannels = readInt16(chunk + 10);
+      _fileSampleRate = Real(readUInt32(chunk + 12));
+      int bitsPerSample = readInt16(chunk + 22);
+
+      // WAVE_FORMAT_EXTENSIBLE: the actual format is in the sub-format GUID
+      if (formatTag == 0xfffe && chunkSize >= 40) formatTag = readInt16(chunk + 32) & 0xffff;
+
+      if      (formatTag == 1 && bitsPerSample == 16) _format = INT16;
+      else if (formatTag == 1 && bitsPerSample == 24) _format = INT24;
+      else if (formatTag == 1 && bitsPerSample == 32) _format = INT32;
+      else if (formatTag == 3 && bitsPerSample == 32) _format = FLOAT32;
+      else {
+        throw EssentiaException("MmapAudioLoader: unsupported WAV sample format ", formatTag,
+                                " with bits per sample: ", bitsPerSample);
+      }
+      foundFormat = true;
+    }
+    else if (memcmp(chunk, "data", 4) == 0) {
+      if (!foundFormat) {
+        throw EssentiaException("MmapAudioLoader: the WAV data chunk comes before the format chunk");
+      }
+      // files which are still being written, or bigger than 4GB, have an
+      // invalid data size, in which case the samples go to the end of the file
+      _data = file + offset;
+      return min(chunkSize, fileSize - offset);
+    }
+
+    // chunks are aligned on 2 bytes
+    offset += chunkSize + (chunkSize & 1);
+  }
+
+  throw EssentiaException("MmapAudioLoader: could not find the data chunk of the WAV file");
+}
+
+void MmapAudioLoader::reset() {
+  Algorithm::reset();
+
+  if (!parameter("filename").isConfigured()) return;
+
+  openAudioFile(parameter("filename").toString());
+
+  if (parameter("format").toString() == "wav") {
+    _nFrames = sint64(parseWavHeader());
+  }
+  else {
+    _data = _file.data();
+    _nFrames = sint64(_file.size());
+    _nChannels = parameter("channels").toInt();
+    _fileSampleRate = parameter("sampleRate").toReal();
+  }
+
+  if (_nChannels < 1 || _nChannels > 2) {
+    throw EssentiaException("MmapAudioLoader: could not load audio. Audio file has ", _nChannels, " channels, only mono and stereo files are supported.");
+  }
+  if (_fileSampleRate <= 0) {
+    throw EssentiaException("MmapAudioLoader: could not load audio. Audio sampling rate must be greater than 0.");
+  }
+
+  static const int sampleBytes[] = { 2, 3, 4, 4 };
+  _frameBytes = _nChannels * sampleBytes[_format];
+  _nFrames /= _frameBytes; // _nFrames was the size of the data in bytes, an incomplete last frame is ignored
+  _position = 0;
+  _released = 0;
+
+  _channels.push(_nChannels);
+  _sampleRate.push(_fileSampleRate);
+}
+
+void MmapAudioLoader::convert(Real* output, sint64 frame, int nframes) const {
+  const char* data = _data + frame*_frameBytes;
+  int sampleBytes = _frameBytes / _nChannels;
+
+  int channel = 0;
+  if (_nChannels == 2) {
+    if (_downmix == RIGHT) channel = 1;
+    else if (_downmix == MIX) channel = -1;
+  }
+
+  // the scales are those used by ffmpeg to convert integer samples to float
+  switch (_format) {
+  case INT16:
+    convertSamples(output, data, nframes, _nChannels, sampleBytes, channel, Real(1.0/32768), readInt16);
+    break;
+  case INT24:
+    convertSamples(output, data, nframes, _nChannels, sampleBytes, channel, Real(1.0/8388608), readInt24);
+    break;
+  case INT32:
+    convertSamples(output, data, nframes, _nChannels, sampleBytes, channel, Real(1.0/2147483648.0), readInt32);
+    break;
+  case FLOAT32:
+    convertSamples(output, data, nframes, _nChannels, sampleBytes, channel, Real(1.0), readFloat32);
+    break;
+  }
+}
+
+void MmapAudioLoader::releasePages() {
+  // the pages which have been read are not needed anymore, release them every
+  // few megabytes so that the resident memory does not grow with the length
+  // of the file (they stay in the page cache)
+  static const size_t releaseSize = 1 << 22;
+
+  size_t offset = (_data - _file.data()) + size_t(_position)*_frameBytes;
+  if (offset < _released + releaseSize) return;
+
+  _file.release(offset);
+  _released = offset;
+}
+
+AlgorithmStatus MmapAudioLoader::process() {
+  if (!parameter("filename").isConfigured()) {
+    throw EssentiaException("MmapAudioLoader: Trying to call process() on an MmapAudioLoader algo which hasn't been correctly configured.");
+  }
+
+  if (_position >= _nFrames) {
+    shouldStop(true);
+    return FINISHED;
+  }
+
+  int nframes = int(min(sint64(CHUNK_SIZE), _nFrames - _position));
+
+  if (!_audio.acquire(nframes)) {
+    return NO_OUTPUT;
+  }
+
+  // the samples are written directly in the output buffer
+  vector<Real>& audio = *((vector<Real>*)_audio.getTokens());
+  convert(&audio[0], _position, nframes);
+
+  _audio.release(nframes);
+  _position += nframes;
+
+  releasePages();
+
+  return OK;
+}
+
+} // namespace streaming
+} // namespace essentia
+
+
+namespace essentia {
+namespace standard {
+
+const char* MmapAudioLoader::name = essentia::streaming::MmapAudioLoader::name;
+const char* MmapAudioLoader::category = essentia::streaming::MmapAudioLoader::category;
+const char* MmapAudioLoader::description = essentia::streaming::MmapAudioLoader::description;
+
+
+void MmapAudioLoader::createInnerNetwork() {
+  _loader = streaming::AlgorithmFactory::create("MmapAudioLoader");
+  _audioStorage = new streaming::VectorOutput<Real>();
+
+  _loader->output("audio")           >>  _audioStorage->input("data");
+  _loader->output("sampleRate")      >>  PC(_pool, "internal.sampleRate");
+  _loader->output("numberChannels")  >>  PC(_pool, "internal.numberChannels");
+  _network = new scheduler::Network(_loader);
+}
+
+void MmapAudioLoader::configure() {
+  _loader->configure(INHERIT("filename"),
+                     INHERIT("format"),
+                     INHERIT("sampleFormat"),
+                     INHERIT("sampleRate"),
+                     INHERIT("channels"),
+                     INHERIT("downmix"));
+}
+
+void MmapAudioLoader::compute() {
+  if (!parameter("filename").isConfigured()) {
+    throw EssentiaException("MmapAudioLoader: Trying to call compute() on an "
+                            "MmapAudioLoader algo which hasn't been correctly configured.");
+  }
+
+  Real& sampleRate = _sampleRate.get();
+  int& numberChannels = _channels.get();
+  vector<Real>& audio = _audio.get();
+
+  _audioStorage->setVector(&audio);
+
+  _network->run();
+
+  sampleRate = _pool.value<Real>("internal.sampleRate");
+  numberChannels = (int) _pool.value<Real>("internal.numberChannels");
+
+  // reset, so it is ready to load audio again
+  reset();
+}
+
+void MmapAudioLoader::reset() {
+  _network->reset();
+  _pool.remove("internal.sampleRate");
+  _pool.remove("internal.numberChannels");
+}
+
+} // namespace standard
+} // namespace essentia
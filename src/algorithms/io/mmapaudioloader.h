@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_STREAMING_MMAPAUDIOLOADER_H
+#define ESSENTIA_STREAMING_MMAPAUDIOLOADER_H
+
+#include "streamingalgorithm.h"
+#include "network.h"
+#include "poolstorage.h"
+#include "mappedfile.h"
+
+namespace essentia {
+namespace streaming {
+
+class MmapAudioLoader : public Algorithm {
+ protected:
+  Source<Real> _audio;
+  AbsoluteSource<Real> _sampleRate;
+  AbsoluteSource<int> _channels;
+
+  // number of samples output by each call to process()
+  const static int CHUNK_SIZE = 4096;
+
+  enum SampleFormat { INT16, INT24, INT32, FLOAT32 };
+  enum Downmix { LEFT, RIGHT, MIX };
+
+  // the whole file is mapped, but only the samples in the data chunk are read
+  MappedFile _file;
+  const char* _data;
+  sint64 _nFrames;
+  sint64 _position;
+  size_t _released; // the pages before this offset have already been released
+
+  SampleFormat _format;
+  int _nChannels;
+  int _frameBytes;
+  Real _fileSampleRate;
+  Downmix _downmix;
+
+  void openAudioFile(const std::string& filename);
+  size_t parseWavHeader(); // returns the size of the data chunk
+  void releasePages();
+
+  void convert(Real* output, sint64 frame, int nframes) const;
+
+ public:
+  MmapAudioLoader() : Algorithm(), _data(0), _nFrames(0), _position(0),
+                      _released(0), _nChannels(0), _frameBytes(0) {
+    declareOutput(_audio, 1, "audio", "the input audio signal, downmixed to mono");
+    declareOutput(_sampleRate, 0, "sampleRate", "the sampling rate of the audio signal [Hz]");
+    declareOutput(_channels, 0, "numberChannels", "the number of channels");
+
+    _audio.setBufferType(BufferUsage::forLargeAudioStream);
+  }
+
+  AlgorithmStatus process();
+  void reset();
+
+  void declareParameters() {
+    declareParameter("filename", "the name of the file from which to read", "", Parameter::STRING);
+    declareParameter("format", "the format of the file: a WAV file, or raw interleaved PCM samples without header", "{wav,raw}", "wav");
+    declareParameter("sampleFormat", "the sample format of raw files (little-endian)", "{int16,int24,int32,float32}", "int16");
+    declareParameter("sampleRate", "the sampling rate of raw files [Hz]", "(0,inf)", 44100.);
+    declareParameter("channels", "the number of channels of raw files", "[1,2]", 1);
+    declareParameter("downmix", "the mixing type for stereo files", "{left,right,mix}", "mix");
+  }
+
+  void configure();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace streaming
+} // namespace essentia
+
+
+#include "vectoroutput.h"
+#include "algorithm.h"
+
+namespace essentia {
+namespace standard {
+
+// Standard non-streaming algorithm comes after the streaming one as it
+// depends on it
+class MmapAudioLoader : public Algorithm {
+
+ protected:
+  Output<std::vector<Real> > _audio;
+  Output<Real> _sampleRate;
+  Output<int> _channels;
+
+  streaming::Algorithm* _loader;
+  streaming::VectorOutput<Real>* _audioStorage;
+
+  scheduler::Network* _network;
+  Pool _pool;
+
+  void createInnerNetwork();
+
+ public:
+  MmapAudioLoader() {
+    declareOutput(_audio, "audio", "the input audio signal, downmixed to mono");
+    declareOutput(_sampleRate, "sampleRate", "the sampling rate of the audio signal [Hz]");
+    declareOutput(_channels, "numberChannels", "the number of channels");
+
+    createInnerNetwork();
+  }
+
+  ~MmapAudioLoader() {
+    // NB: this will also delete all the algorithms as the Network took ownership of them
+    delete _network;
+  }
+
+  void declareParameters() {
+    declareParameter("filename", "the name of the file from which to read", "", Parameter::STRING);
+    declareParameter("format", "the format of the file: a WAV file, or raw interleaved PCM samples without header", "{wav,raw}", "wav");
+    declareParameter("sampleFormat", "the sample format of raw files (little-endian)", "{int16,int24,int32,float32}", "int16");
+    declareParameter("sampleRate", "the sampling rate of raw files [Hz]", "(0,inf)", 44100.);
+    declareParameter("channels", "the number of channels of raw files", "[1,2]", 1);
+    declareParameter("downmix", "the mixing type for stereo files", "{left,right,mix}", "mix");
+  }
+
+  void configure();
+
+  void compute();
+  void reset();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+} // namespace standard
+} // namespace essentia
+
+#endif // ESSENTIA_STREAMING_MMAPAUDIOLOADER_H
@@ -20,6 +20,7 @@
 #include "beattrackermultifeature.h"
 #include "poolstorage.h"
 #include "algorithmfactory.h"
+#include "threadpool.h"
 
 using namespace std;
 
@@ -57,7 +58,8 @@ BeatTrackerMultiFeature::BeatTrackerMultiFeature() : AlgorithmComposite(),
     _frameCutter1(0), _windowing1(0), _fft1(0), _cart2polar1(0), _onsetRms1(0),
     _onsetComplex1(0), _ticksRms1(0), _ticksComplex1(0), _onsetMelFlux1(0),
     _ticksMelFlux1(0), _onsetBeatEmphasis3(0), _ticksBeatEmphasis3(0),
-    _onsetInfogain4(0), _ticksInfogain4(0), _scale(0), _configured(false) {
+    _onsetInfogain4(0), _ticksInfogain4(0), _tempoTapMaxAgreement(0), _scale(0),
+    _network(0), _configured(false), _numberThreads(0) {
 
   declareInput(_signal, 1024, "signal", "input signal");
   declareOutput(_ticks, 0, "ticks", "the estimated tick locations [s]");
@@ -79,15 +81,15 @@ void BeatTrackerMultiFeature::createInnerNetwork() {
   _onsetRms1            = factory.create("OnsetDetection");
   _onsetComplex1        = factory.create("OnsetDetection");
   _onsetMelFlux1        = factory.create("OnsetDetection");
-  _ticksRms1            = factory.create("TempoTapDegara");
-  _ticksComplex1        = factory.create("TempoTapDegara");
-  _ticksMelFlux1        = factory.create("TempoTapDegara");
+  _ticksRms1            = standard::AlgorithmFactory::create("TempoTapDegara");
+  _ticksComplex1        = standard::AlgorithmFactory::create("TempoTapDegara");
+  _ticksMelFlux1        = standard::AlgorithmFactory::create("TempoTapDegara");
 
-  _onsetBeatEmphasis3   = factory.create("OnsetDetectionGlobal");
-  _ticksBeatEmphasis3   = factory.create("TempoTapDegara");
+  _onsetBeatEmphasis3   = standard::AlgorithmFactory::create("OnsetDetectionGlobal");
+  _ticksBeatEmphasis3   = standard::AlgorithmFactory::create("TempoTapDegara");
 
-  _onsetInfogain4       = factory.create("OnsetDetectionGlobal");
-  _ticksInfogain4       = factory.create("TempoTapDegara");
+  _onsetInfogain4       = standard::AlgorithmFactory::create("OnsetDetectionGlobal");
+  _ticksInfogain4       = standard::AlgorithmFactory::create("TempoTapDegara");
 
   _tempoTapMaxAgreement = standard::AlgorithmFactory::create("TempoTapMaxAgreement");
 
@@ -110,22 +112,13 @@ void BeatTrackerMultiFeature::createInnerNetwork() {
   _cart2polar1->output("magnitude")          >>   _onsetMelFlux1->input("spectrum");
   _cart2polar1->output("phase")              >>   _onsetMelFlux1->input("phase");
 
-  _onsetComplex1->output("onsetDetection")   >>   _ticksComplex1->input("onsetDetections");
-  _ticksComplex1->output("ticks")            >>   PC(_pool, "internal.ticksComplex");
-  _onsetRms1->output("onsetDetection")       >>   _ticksRms1->input("onsetDetections");
-  _ticksRms1->output("ticks")                >>   PC(_pool, "internal.ticksRms");
-  _onsetMelFlux1->output("onsetDetection")   >>   _ticksMelFlux1->input("onsetDetections");
-  _ticksMelFlux1->output("ticks")            >>   PC(_pool, "internal.ticksMelFlux");
+  _onsetComplex1->output("onsetDetection")   >>   PC(_pool, "internal.onsetComplex");
+  _onsetRms1->output("onsetDetection")       >>   PC(_pool, "internal.onsetRms");
+  _onsetMelFlux1->output("onsetDetection")   >>   PC(_pool, "internal.onsetMelFlux");
 
-  //_signal                                           >>   _onsetBeatEmphasis3->input("signal");
-  _scale->output("signal")                         >>  _onsetBeatEmphasis3->input("signal");
-  _onsetBeatEmphasis3->output("onsetDetections")   >>  _ticksBeatEmphasis3->input("onsetDetections");
-  _ticksBeatEmphasis3->output("ticks")             >>  PC(_pool, "internal.ticksBeatEmphasis");
-
-  //_signal                                           >> _onsetInfogain4->input("signal");
-  _scale->output("signal")  >> _onsetInfogain4->input("signal");
-  _onsetInfogain4->output("onsetDetections")        >> _ticksInfogain4->input("onsetDetections");
-  _ticksInfogain4->output("ticks")                  >> PC(_pool, "internal.ticksInfogain");
+  // the beat emphasis and infogain detection functions are computed on the
+  // whole signal in process()
+  _scale->output("signal")                   >>   PC(_pool, "internal.signal");
 
   _network = new scheduler::Network(_scale);
 }
@@ -134,6 +127,13 @@ void BeatTrackerMultiFeature::clearAlgos() {
   if (!_configured) return;
 
   delete _network;
+  delete _ticksRms1;
+  delete _ticksComplex1;
+  delete _ticksMelFlux1;
+  delete _onsetBeatEmphasis3;
+  delete _ticksBeatEmphasis3;
+  delete _onsetInfogain4;
+  delete _ticksInfogain4;
   delete _tempoTapMaxAgreement;
 }
 
@@ -158,6 +158,7 @@ void BeatTrackerMultiFeature::configure() {
   // Configure internal algorithms
   int minTempo = parameter("minTempo").toInt();
   int maxTempo = parameter("maxTempo").toInt();
+  _numberThreads = parameter("numberThreads").toInt();
 
   int frameSize1 = 2048;
   int hopSize1 = 1024;
@@ -223,6 +224,88 @@ void BeatTrackerMultiFeature::configure() {
   _configured = true;
 }
 
+namespace {
+
+// The tick candidates of the five detection functions, computed by
+// independent chains of standard algorithms. Tasks 0-2 are the tempo trackers
+// of the frame-wise detection functions, tasks 3-4 compute the beat emphasis
+// and infogain detection functions on the whole signal, and tasks 5-6 are
+// their tempo trackers.
+class TickCandidateTasks : public scheduler::TaskList {
+ public:
+  standard::Algorithm* algos[7];
+  const vector<Real>* inputs[7];
+  vector<Real>* outputs[7];
+
+  vector<Real> onsetBeatEmphasis;
+  vector<Real> onsetInfogain;
+
+  void run(int task) {
+    // ticks candidates might be empty for very short signals, but
+    // it is ok to feed empty tick vectors to TempoTapMaxAgreement
+    if (inputs[task]->empty()) {
+      outputs[task]->clear();
+      return;
+    }
+
+    bool onsetDetection = (task == 3 || task == 4);
+    algos[task]->input(onsetDetection ? "signal" : "onsetDetections").set(*inputs[task]);
+    algos[task]->output(onsetDetection ? "onsetDetections" : "ticks").set(*outputs[task]);
+    algos[task]->compute();
+  }
+
+  void done(int task, vector<int>& ready) {
+    if (task == 3 || task == 4) ready.push_back(task + 2);
+  }
+};
+
+} // namespace
+
+void BeatTrackerMultiFeature::computeTickCandidates(vector<vector<Real> >& tickCandidates) {
+  static const char* inputNames[] = { "internal.onsetComplex", "internal.onsetRms",
+                                      "internal.onsetMelFlux", "internal.signal" };
+  const vector<Real>* inputs[4];
+  vector<Real> empty;
+
+  for (int i=0; i<4; ++i) {
+    inputs[i] = _pool.contains<vector<Real> >(inputNames[i])
+              ? &_pool.value<vector<Real> >(inputNames[i])
+              : &empty;
+  }
+
+  tickCandidates.resize(5);
+
+  TickCandidateTasks tasks;
+  standard::Algorithm* algos[] = { _ticksComplex1, _ticksRms1, _ticksMelFlux1,
+                                   _onsetBeatEmphasis3, _onsetInfogain4,
+                                   _ticksBeatEmphasis3, _ticksInfogain4 };
+  const vector<Real>* taskInputs[] = { inputs[0], inputs[1], inputs[2],
+                                       inputs[3], inputs[3],
+                                       &tasks.onsetBeatEmphasis, &tasks.onsetInfogain };
+  vector<Real>* taskOutputs[] = { &tickCandidates[0], &tickCandidates[1], &tickCandidates[2],
+                                  &tasks.onsetBeatEmphasis, &tasks.onsetInfogain,
+                                  &tickCandidates[3], &tickCandidates[4] };
+  for (int i=0; i<7; ++i) {
+    tasks.algos[i] = algos[i];
+    tasks.inputs[i] = taskInputs[i];
+    tasks.outputs[i] = taskOutputs[i];
+  }
+
+  // the global detection functions are the slowest tasks, start them first
+  // (the pool takes the ready tasks from the back)
+  vector<int> ready;
+  ready.push_back(0);
+  ready.push_back(1);
+  ready.push_back(2);
+  ready.push_back(4);
+  ready.push_back(3);
+
+  // there are never more than 5 tasks that can run at the same time
+  int nThreads = _numberThreads > 0 ? _numberThreads : scheduler::ThreadPool::hardwareConcurrency();
+  scheduler::ThreadPool threadPool(min(nThreads, 5));
+  threadPool.run(tasks, ready);
+}
+
 AlgorithmStatus BeatTrackerMultiFeature::process() {
   if (!shouldStop()) return PASS;
 
@@ -230,25 +313,7 @@ AlgorithmStatus BeatTrackerMultiFeature::process() {
   vector<Real> ticks;
   Real confidence;
 
-  tickCandidates.resize(5);
-
-  // ticks candidates might be empty for very short signals, but
-  // it is ok to feed empty tick vetors to TempoTapMaxAgreement
-  if (_pool.contains<vector<Real> >("internal.ticksComplex")) {
-    tickCandidates[0] = _pool.value<vector<Real> >("internal.ticksComplex");
-  }
-  if (_pool.contains<vector<Real> >("internal.ticksRms")) {
-    tickCandidates[1] = _pool.value<vector<Real> >("internal.ticksRms");
-  }
-  if (_pool.contains<vector<Real> >("internal.ticksMelFlux")) {
-    tickCandidates[2] = _pool.value<vector<Real> >("internal.ticksMelFlux");
-  }
-  if (_pool.contains<vector<Real> >("internal.ticksBeatEmphasis")) {
-    tickCandidates[3] = _pool.value<vector<Real> >("internal.ticksBeatEmphasis");
-  }
-  if (_pool.contains<vector<Real> >("internal.ticksInfogain")) {
-    tickCandidates[4] = _pool.value<vector<Real> >("internal.ticksInfogain");
-  }
+  computeTickCandidates(tickCandidates);
 
   _tempoTapMaxAgreement->input("tickCandidates").set(tickCandidates);
   _tempoTapMaxAgreement->output("ticks").set(ticks);
@@ -265,7 +330,16 @@ AlgorithmStatus BeatTrackerMultiFeature::process() {
 
 void BeatTrackerMultiFeature::reset() {
   AlgorithmComposite::reset();
+  _ticksRms1->reset();
+  _ticksComplex1->reset();
+  _ticksMelFlux1->reset();
+  _onsetBeatEmphasis3->reset();
+  _ticksBeatEmphasis3->reset();
+  _onsetInfogain4->reset();
+  _ticksInfogain4->reset();
   _tempoTapMaxAgreement->reset();
+  // the stored signal and detection functions belong to the previous stream
+  _pool.clear();
 }
 
 } // namespace streaming
@@ -296,7 +370,8 @@ BeatTrackerMultiFeature::~BeatTrackerMultiFeature() {
 void BeatTrackerMultiFeature::configure() {
   _beatTracker->configure(//INHERIT("sampleRate"),
                           INHERIT("maxTempo"),
-                          INHERIT("minTempo"));
+                          INHERIT("minTempo"),
+                          INHERIT("numberThreads"));
 }
 
 
@@ -44,16 +44,20 @@ class BeatTrackerMultiFeature : public AlgorithmComposite {
   Algorithm* _cart2polar1;
   Algorithm* _onsetRms1;
   Algorithm* _onsetComplex1;
-  Algorithm* _ticksRms1;
-  Algorithm* _ticksComplex1;
   Algorithm* _onsetMelFlux1;
-  Algorithm* _ticksMelFlux1;
 
-  Algorithm* _onsetBeatEmphasis3;
-  Algorithm* _ticksBeatEmphasis3;
+  // the tempo trackers and the global onset detection functions need the
+  // whole signal, they are run once it has been stored, concurrently as they
+  // share no state
+  standard::Algorithm* _ticksRms1;
+  standard::Algorithm* _ticksComplex1;
+  standard::Algorithm* _ticksMelFlux1;
 
-  Algorithm* _onsetInfogain4;
-  Algorithm* _ticksInfogain4;
+  standard::Algorithm* _onsetBeatEmphasis3;
+  standard::Algorithm* _ticksBeatEmphasis3;
+
+  standard::Algorithm* _onsetInfogain4;
+  standard::Algorithm* _ticksInfogain4;
 
   standard::Algorithm* _tempoTapMaxAgreement;
 
@@ -61,9 +65,11 @@ class BeatTrackerMultiFeature : public AlgorithmComposite {
 
   scheduler::Network* _network;
   bool _configured;
+  int _numberThreads;
 
   void createInnerNetwork();
   void clearAlgos();
+  void computeTickCandidates(std::vector<std::vector<Real> >& tickCandidates);
   Real _sampleRate;
 
  public:
@@ -75,6 +81,7 @@ class BeatTrackerMultiFeature : public AlgorithmComposite {
     //declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
     declareParameter("maxTempo", "the fastest tempo to detect [bpm]", "[60,250]", 208);
     declareParameter("minTempo", "the slowest tempo to detect [bpm]", "[40,180]", 40);
+    declareParameter("numberThreads", "the maximum number of threads used to run the tempo trackers of the different onset detection functions concurrently (0 to use one thread per processor)", "[0,inf)", 0);
   }
 
   void declareProcessOrder() {
@@ -120,6 +127,7 @@ class BeatTrackerMultiFeature : public Algorithm {
     //declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
     declareParameter("maxTempo", "the fastest tempo to detect [bpm]", "[60,250]", 208);
     declareParameter("minTempo", "the slowest tempo to detect [bpm]", "[40,180]", 40);
+    declareParameter("numberThreads", "the maximum number of threads used to run the tempo trackers of the different onset detection functions concurrently (0 to use one thread per processor)", "[0,inf)", 0);
   }
 
   void configure();
@@ -62,8 +62,8 @@ void PitchSalience::compute() {
   }
 
   vector<Real> acf;
-  _autoCorrelation->input("array").set(spectrum);
-  _autoCorrelation->output("autoCorrelation").set(acf);
+  _autoCorrelationInput.set(spectrum);
+  _autoCorrelationOutput.set(acf);
   _autoCorrelation->compute();
 
   int lowIndex = int((_lowBoundary * spectrum.size()) /
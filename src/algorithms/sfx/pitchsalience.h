@@ -35,6 +35,8 @@ class PitchSalience : public Algorithm {
   Output<Real> _pitchSalience;
 
   Algorithm* _autoCorrelation;
+  InputHandle<std::vector<Real> > _autoCorrelationInput;
+  OutputHandle<std::vector<Real> > _autoCorrelationOutput;
 
  public:
   PitchSalience() {
@@ -42,6 +44,8 @@ class PitchSalience : public Algorithm {
     declareOutput(_pitchSalience, "pitchSalience", "the pitch salience (normalized from 0 to 1)");
 
     _autoCorrelation = AlgorithmFactory::create("AutoCorrelation");
+    _autoCorrelationInput.attach(_autoCorrelation, "array");
+    _autoCorrelationOutput.attach(_autoCorrelation, "autoCorrelation");
   }
 
   ~PitchSalience() {
@@ -49,7 +49,7 @@ void BarkBands::compute() {
   const vector<Real>& spectrum = _spectrumInput.get();
   vector<Real>& bands = _bandsOutput.get();
 
-  _freqBands->input("spectrum").set(spectrum);
-  _freqBands->output("bands").set(bands);
+  _freqBandsInput.set(spectrum);
+  _freqBandsOutput.set(bands);
   _freqBands->compute();
 }
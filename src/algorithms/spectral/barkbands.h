@@ -32,12 +32,16 @@ class BarkBands : public Algorithm {
   Output<std::vector<Real> > _bandsOutput;
 
   Algorithm* _freqBands;
+  InputHandle<std::vector<Real> > _freqBandsInput;
+  OutputHandle<std::vector<Real> > _freqBandsOutput;
 
  public:
   BarkBands() {
     declareInput(_spectrumInput, "spectrum", "the input spectrum");
     declareOutput(_bandsOutput, "bands", "the energy of the bark bands");
     _freqBands = AlgorithmFactory::create("FrequencyBands");
+    _freqBandsInput.attach(_freqBands, "spectrum");
+    _freqBandsOutput.attach(_freqBands, "bands");
   }
 
   ~BarkBands() {
@@ -43,7 +43,7 @@ void ERBBands::configure() {
   calculateFilterFrequencies();
   createFilters(parameter("inputSize").toInt());
 
-  _type = parameter("type").toLower();
+  _isPower = parameter("type").toLower() == "power";
 }
 
 void ERBBands::calculateFilterFrequencies() {
@@ -68,7 +68,8 @@ void ERBBands::createFilters(int spectrumSize) {
   complex<Real> oneJ(0,1);
   Real order = 1;
   Real pi = Real(M_PI);
-  _filterCoefficients = vector<vector<Real> >(filterSize, vector<Real>(spectrumSize, 0.0));
+  _filterbank.clear(spectrumSize);
+  vector<Real> coefficients(spectrumSize);
   Real fftSize = (spectrumSize-1)*2;
   for (int i=0; i<spectrumSize; i++) {
  	  ucirc[i] = exp((oneJ*Real(2.0)*pi*Real(i))/fftSize);
@@ -118,11 +119,15 @@ void ERBBands::createFilters(int spectrumSize) {
                 Real(2)* cxExp + Real(2)*(Real(1) + cxExp)/exp(B*T)),Real(4)));
 
     for (int j=0; j<spectrumSize; j++) {
-      _filterCoefficients[i][j] = (pow(T,4)/filterGain) *
+      coefficients[j] = (pow(T,4)/filterGain) *
             abs(ucirc[j]-zeros[0]) * abs(ucirc[j]-zeros[1]) *
             abs(ucirc[j]-zeros[2]) * abs(ucirc[j]-zeros[3]) *
             pow(abs((pole-ucirc[j])*(pole-ucirc[j])),(-GTord));
     }
+
+    // the gammatone filters cover the whole spectrum, only the bins where the
+    // response underflows to zero are left out
+    _filterbank.addBand(coefficients);
   }
 }
 
@@ -131,37 +136,16 @@ void ERBBands::compute() {
   const std::vector<Real>& spectrum = _spectrumInput.get();
   std::vector<Real>& bands = _bandsOutput.get();
 
-  int filterSize = _numberBands;
   int spectrumSize = spectrum.size();
 
-  if (_filterCoefficients.empty() ||
-      int(_filterCoefficients[0].size()) != spectrumSize) {
-    E_INFO("ERBBands: input spectrum size (" << spectrumSize << ") does not correspond to the \"inputSize\" parameter (" << _filterCoefficients[0].size() << "). Recomputing the filter bank.");
+  if (_filterbank.spectrumSize() != spectrumSize) {
+    E_INFO("ERBBands: input spectrum size (" << spectrumSize << ") does not correspond to the \"inputSize\" parameter (" << _filterbank.spectrumSize() << "). Recomputing the filter bank.");
     createFilters(spectrumSize);
   }
 
-  bands.resize(filterSize);
-
-
   // NB: Band magnitudes are returned, while BarkBands and MelBands algorithms
   // return energy. Gerard Roma have found magnitudes work better when
   // working with sound effects.  Band magnitudes option is required for 
   // OnsetDetectionGlobal algorithm.
-
-  if (_type=="magnitude") {
-    for (int i=0; i<filterSize; ++i) {
-      bands[i] = 0;
-      for (int j=0; j<spectrumSize; ++j) {
-        bands[i] += (spectrum[j]) * _filterCoefficients[i][j];
-      }
-    }
-  }
-  else if (_type=="power") {
-    for (int i=0; i<filterSize; ++i) {
-      bands[i] = 0;
-      for (int j=0; j<spectrumSize; ++j) {
-        bands[i] += (spectrum[j] * spectrum[j]) * _filterCoefficients[i][j];
-      }
-    }
-  }
+  _filterbank.compute(spectrum, bands, _isPower, false);
 }
@@ -22,6 +22,7 @@
 
 #include "essentiamath.h"
 #include "algorithm.h"
+#include "utils/filterbank.h"
 #include <complex>
 
 namespace essentia {
@@ -61,7 +62,7 @@ class ERBBands : public Algorithm {
   void createFilters(int spectrumSize);
   void calculateFilterFrequencies();
 
-  std::vector<std::vector<Real> > _filterCoefficients;
+  util::Filterbank _filterbank;
   std::vector<Real> _filterFrequencies;
   int _numberBands;
 
@@ -69,7 +70,7 @@ class ERBBands : public Algorithm {
   Real _maxFrequency;
   Real _minFrequency;
   Real _width;
-  std::string _type;
+  bool _isPower;
 
   static const Real EarQ;
   static const Real minBW;
@@ -51,8 +51,8 @@ void FlatnessDB::compute() {
 
   Real flatness;
 
-  _flatness->input("array").set(array);
-  _flatness->output("flatness").set(flatness);
+  _flatnessInput.set(array);
+  _flatnessOutput.set(flatness);
   _flatness->compute();
 
   if (flatness <= 0.0) {
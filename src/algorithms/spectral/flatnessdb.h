@@ -32,6 +32,8 @@ class FlatnessDB : public Algorithm {
   Output<Real> _flatnessDB;
 
   Algorithm* _flatness;
+  InputHandle<std::vector<Real> > _flatnessInput;
+  OutputHandle<Real> _flatnessOutput;
 
  public:
   FlatnessDB() {
@@ -39,6 +41,8 @@ class FlatnessDB : public Algorithm {
     declareOutput(_flatnessDB, "flatnessDB", "the flatness dB");
 
     _flatness = AlgorithmFactory::create("Flatness");
+    _flatnessInput.attach(_flatness, "array");
+    _flatnessOutput.attach(_flatness, "flatness");
   }
 
   ~FlatnessDB() {
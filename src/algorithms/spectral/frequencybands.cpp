@@ -49,6 +49,7 @@ void FrequencyBands::configure() {
       throw EssentiaException("FrequencyBands: the values in the 'frequencyBands' parameter are not in ascending order or there exists a duplicate value");
     }
   }
+  _filterbank.clear(0);
 }
 
 void FrequencyBands::compute() {
@@ -59,31 +60,34 @@ void FrequencyBands::compute() {
     throw EssentiaException("FrequencyBands: the size of the input spectrum is not greater than one");
   }
 
-  Real frequencyscale = (_sampleRate / 2.0) / (spectrum.size() - 1);
+  // the bins of each band only depend on the size of the spectrum, so they
+  // are computed again only when it changes
+  if (_filterbank.spectrumSize() != int(spectrum.size())) {
+    createFilters(spectrum.size());
+  }
+
+  _filterbank.compute(spectrum, bands, true, false);
+
+  // decision: don't scale the bands in any way...
+  // this way, when summing the energy, we will get consistent *summed* results
+  // for different FFT-sizes, (with zero-overlap)
+}
+
+void FrequencyBands::createFilters(int spectrumSize) {
+  Real frequencyscale = (_sampleRate / 2.0) / (spectrumSize - 1);
   int nBands = int(_bandFrequencies.size() - 1);
+  std::vector<Real> ones(spectrumSize, 1.0);
 
-  bands.resize(nBands);
-  std::fill(bands.begin(), bands.end(), (Real) 0.0);
+  _filterbank.clear(spectrumSize);
 
   for (int i=0; i<nBands; i++) {
     int startBin = int(_bandFrequencies[i] / frequencyscale + 0.5);
     int endBin = int(_bandFrequencies[i + 1] / frequencyscale + 0.5);
 
-    if (startBin >= int(spectrum.size())) {
-      break;
-    }
-
-    if (endBin > int(spectrum.size())) {
-      endBin = spectrum.size();
-    }
+    // bands above the Nyquist frequency are empty
+    startBin = std::min(startBin, spectrumSize);
+    endBin = std::min(endBin, spectrumSize);
 
-    for (int j=startBin; j<endBin; j++) {
-      Real magSquared = spectrum[j] * spectrum[j];
-      bands[i] += magSquared;
-    }
+    _filterbank.addBand(startBin, &ones[0], endBin - startBin);
   }
-
-  // decision: don't scale the bands in any way...
-  // this way, when summing the energy, we will get consistent *summed* results
-  // for different FFT-sizes, (with zero-overlap)
 }
@@ -22,6 +22,7 @@
 
 #include "algorithm.h"
 #include "essentiautil.h"
+#include "utils/filterbank.h"
 
 namespace essentia {
 namespace standard {
@@ -56,8 +57,11 @@ class FrequencyBands : public Algorithm {
   static const char* description;
 
  protected:
+  void createFilters(int spectrumSize);
+
   std::vector<Real> _bandFrequencies;
   Real _sampleRate;
+  util::Filterbank _filterbank;
 };
 
 } // namespace standard
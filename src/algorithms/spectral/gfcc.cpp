@@ -55,8 +55,8 @@ void GFCC::compute() {
   vector<Real>& bands = _bands.get();
 
   // filter the spectrum using a gammatone filterbank
-  _gtFilter->input("spectrum").set(spectrum);
-  _gtFilter->output("bands").set(bands);
+  _gtFilterInput.set(spectrum);
+  _gtFilterOutput.set(bands);
   _gtFilter->compute();
 
 
@@ -67,8 +67,7 @@ void GFCC::compute() {
   }
 
   // compute the DCT of these bands
-  _dct->input("array").set(_logbands);
-  _dct->output("dct").set(gfcc);
+  _dctOutput.set(gfcc);
   _dct->compute();
 }
 
@@ -33,7 +33,10 @@ class GFCC : public Algorithm {
   Output<std::vector<Real> > _gfcc;
 
   Algorithm* _gtFilter;
+  InputHandle<std::vector<Real> > _gtFilterInput;
+  OutputHandle<std::vector<Real> > _gtFilterOutput;
   Algorithm* _dct;
+  OutputHandle<std::vector<Real> > _dctOutput;
 
   std::vector<Real> _logbands;
 
@@ -50,7 +53,11 @@ class GFCC : public Algorithm {
     declareOutput(_gfcc, "gfcc", "the gammatone feature cepstrum coefficients");
 
     _gtFilter = AlgorithmFactory::create("ERBBands");
+    _gtFilterInput.attach(_gtFilter, "spectrum");
+    _gtFilterOutput.attach(_gtFilter, "bands");
     _dct = AlgorithmFactory::create("DCT");
+    _dctOutput.attach(_dct, "dct");
+    _dct->input("array").set(_logbands);
   }
 
   ~GFCC() {
@@ -100,6 +100,10 @@ class HPCP : public Algorithm {
   bool _maxShifted;
 
   std::vector<HarmonicPeak> _harmonicPeaks;
+
+  // contributions of the low and high bands, when using the band preset
+  std::vector<Real> _hpcpLow;
+  std::vector<Real> _hpcpHigh;
 };
 
 } // namespace standard
@@ -48,21 +48,23 @@ void MelBands::configure() {
   }
   _numBands = parameter("numberBands").toInt();
   _sampleRate = parameter("sampleRate").toReal();
-  _normalization = parameter("normalize").toString();
-  _type = parameter("type").toString();
+  _unitSum = parameter("normalize").toLower() == "unit_sum";
+  _isPower = parameter("type").toLower() == "power";
+  _isLog = parameter("log").toBool();
 
   setWarpingFunctions(parameter("warpingFormula").toString(),
                       parameter("weighting").toString());
 
   calculateFilterFrequencies();
 
-  _triangularBands->configure(INHERIT("inputSize"),
-                              INHERIT("sampleRate"),
-                              INHERIT("log"),
-                              INHERIT("normalize"),
-                              INHERIT("type"),
-                              "frequencyBands", _filterFrequencies,
-                              "weighting",_weighting);
+  createFilters(parameter("inputSize").toInt());
+}
+
+void MelBands::createFilters(int spectrumSize) {
+  // the mel filters are triangles whose vertices are the filter frequencies,
+  // built the same way as in the TriangularBands algorithm
+  _filterbank.createTriangularBands(_filterFrequencies, _sampleRate, spectrumSize,
+                                    _weighter, _unitSum);
 }
 
 void MelBands::calculateFilterFrequencies() {
@@ -87,9 +89,18 @@ void MelBands::compute() {
   const std::vector<Real>& spectrum = _spectrumInput.get();
   std::vector<Real>& bands = _bandsOutput.get();
 
-  _triangularBands->input("spectrum").set(spectrum);
-  _triangularBands->output("bands").set(bands);
-  _triangularBands->compute();
+  if (spectrum.size() <= 1) {
+    throw EssentiaException("MelBands: the size of the input spectrum is not greater than one");
+  }
+
+  int spectrumSize = spectrum.size();
+
+  if (_filterbank.spectrumSize() != spectrumSize) {
+    E_INFO("MelBands: input spectrum size (" << spectrumSize << ") does not correspond to the \"inputSize\" parameter (" << _filterbank.spectrumSize() << "). Recomputing the filter bank.");
+    createFilters(spectrumSize);
+  }
+
+  _filterbank.compute(spectrum, bands, _isPower, _isLog);
 }
 
 
@@ -109,10 +120,10 @@ void MelBands::setWarpingFunctions(std::string warping, std::string weighting){
   }
 
   if (weighting == "warping"){
-    _weighting = warping;
+    _weighter = _warper;
   }
   else if (weighting == "linear"){
-    _weighting = "linear";
+    _weighter = hz2hz;
   }
   else{
     throw EssentiaException("Melbands: Bad 'weighting' parameter");
@@ -22,7 +22,7 @@
 
 #include "essentiamath.h"
 #include "algorithm.h"
-#include "algorithmfactory.h"
+#include "utils/filterbank.h"
 
 
 namespace essentia {
@@ -34,14 +34,10 @@ class MelBands : public Algorithm {
   Input<std::vector<Real> > _spectrumInput;
   Output<std::vector<Real> > _bandsOutput;
 
-  Algorithm* _triangularBands;
-
  public:
   MelBands() {
     declareInput(_spectrumInput, "spectrum", "the audio spectrum");
     declareOutput(_bandsOutput, "bands", "the energy in mel bands");
-
-    _triangularBands = AlgorithmFactory::create("TriangularBands");
   }
 
   void declareParameters() {
@@ -69,19 +65,21 @@ class MelBands : public Algorithm {
 
   void calculateFilterFrequencies();
   void setWarpingFunctions(std::string warping, std::string weighting);
+  void createFilters(int spectrumSize);
 
-  std::vector<std::vector<Real> > _filterCoefficients;
+  util::Filterbank _filterbank;
   std::vector<Real> _filterFrequencies;
   int _numBands;
   Real _sampleRate;
 
-  std::string _normalization;
-  std::string _type;
-  std::string _weighting;
+  bool _unitSum;
+  bool _isPower;
+  bool _isLog;
   typedef Real (*funcPointer)(Real);
 
   funcPointer _inverseWarper;
   funcPointer _warper;
+  funcPointer _weighter;
 };
 
 } // namespace standard
@@ -105,8 +105,8 @@ void MFCC::compute() {
   vector<Real>& bands = _bands.get();
 
   // filter the spectrum using a mel-scaled filterbank
-  _melFilter->input("spectrum").set(spectrum);
-  _melFilter->output("bands").set(bands);
+  _melFilterInput.set(spectrum);
+  _melFilterOutput.set(bands);
   _melFilter->compute();
 
   // take the dB amplitude of the spectrum
@@ -115,8 +115,7 @@ void MFCC::compute() {
   }
 
   // compute the DCT of these bands
-  _dct->input("array").set(_logbands);
-  _dct->output("dct").set(mfcc);
+  _dctOutput.set(mfcc);
   _dct->compute();
 }
 
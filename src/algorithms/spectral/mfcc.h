@@ -33,7 +33,10 @@ class MFCC : public Algorithm {
   Output<std::vector<Real> > _mfcc;
 
   Algorithm* _melFilter;
+  InputHandle<std::vector<Real> > _melFilterInput;
+  OutputHandle<std::vector<Real> > _melFilterOutput;
   Algorithm* _dct;
+  OutputHandle<std::vector<Real> > _dctOutput;
 
   std::vector<Real> _logbands;
 
@@ -49,7 +52,11 @@ class MFCC : public Algorithm {
     declareOutput(_mfcc, "mfcc", "the mel frequency cepstrum coefficients");
 
     _melFilter = AlgorithmFactory::create("MelBands");
+    _melFilterInput.attach(_melFilter, "spectrum");
+    _melFilterOutput.attach(_melFilter, "bands");
     _dct = AlgorithmFactory::create("DCT");
+    _dctOutput.attach(_dct, "dct");
+    _dct->input("array").set(_logbands);
   }
 
   ~MFCC() {
@@ -52,9 +52,9 @@ void SpectralComplexity::compute() {
   vector<Real> frequencies;
   vector<Real> magnitudes;
 
-  _spectralPeaks->input("spectrum").set(spectrum);
-  _spectralPeaks->output("frequencies").set(frequencies);
-  _spectralPeaks->output("magnitudes").set(magnitudes);
+  _spectralPeaksInput.set(spectrum);
+  _spectralPeaksFrequencies.set(frequencies);
+  _spectralPeaksMagnitudes.set(magnitudes);
   _spectralPeaks->compute();
 
   spectralComplexity = (Real)magnitudes.size();
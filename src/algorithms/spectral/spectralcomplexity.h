@@ -32,6 +32,9 @@ class SpectralComplexity : public Algorithm {
   Output<Real> _spectralComplexity;
 
   Algorithm* _spectralPeaks;
+  InputHandle<std::vector<Real> > _spectralPeaksInput;
+  OutputHandle<std::vector<Real> > _spectralPeaksFrequencies;
+  OutputHandle<std::vector<Real> > _spectralPeaksMagnitudes;
 
  public:
   SpectralComplexity() {
@@ -39,6 +42,9 @@ class SpectralComplexity : public Algorithm {
     declareOutput(_spectralComplexity, "spectralComplexity", "the spectral complexity of the input spectrum");
 
     _spectralPeaks = AlgorithmFactory::create("SpectralPeaks");
+    _spectralPeaksInput.attach(_spectralPeaks, "spectrum");
+    _spectralPeaksFrequencies.attach(_spectralPeaks, "frequencies");
+    _spectralPeaksMagnitudes.attach(_spectralPeaks, "magnitudes");
   }
 
   ~SpectralComplexity() {
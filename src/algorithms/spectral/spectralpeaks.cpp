@@ -61,9 +61,9 @@ void SpectralPeaks::compute() {
   std::vector<Real>& peakMagnitude = _magnitudes.get();
   std::vector<Real>& peakFrequency = _frequencies.get();
 
-  _peakDetect->input("array").set(spectrum);
-  _peakDetect->output("positions").set(peakFrequency);
-  _peakDetect->output("amplitudes").set(peakMagnitude);
+  _peakDetectInput.set(spectrum);
+  _peakDetectPositions.set(peakFrequency);
+  _peakDetectAmplitudes.set(peakMagnitude);
 
   _peakDetect->compute();
 }
@@ -32,6 +32,9 @@ class SpectralPeaks : public Algorithm {
   Output<std::vector<Real> > _magnitudes;
   Output<std::vector<Real> > _frequencies;
   Algorithm* _peakDetect;
+  InputHandle<std::vector<Real> > _peakDetectInput;
+  OutputHandle<std::vector<Real> > _peakDetectPositions;
+  OutputHandle<std::vector<Real> > _peakDetectAmplitudes;
 
  public:
   SpectralPeaks() {
@@ -40,6 +43,9 @@ class SpectralPeaks : public Algorithm {
     declareOutput(_magnitudes, "magnitudes", "the magnitudes of the spectral peaks");
 
     _peakDetect = AlgorithmFactory::create("PeakDetection");
+    _peakDetectInput.attach(_peakDetect, "array");
+    _peakDetectPositions.attach(_peakDetect, "positions");
+    _peakDetectAmplitudes.attach(_peakDetect, "amplitudes");
   }
 
   ~SpectralPeaks() {
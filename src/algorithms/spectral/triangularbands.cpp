@@ -36,7 +36,7 @@ void TriangularBands::configure() {
   _inputSize = parameter("inputSize").toReal();
   _sampleRate = parameter("sampleRate").toReal();
   _normalization = parameter("normalize").toLower();
-  _type = parameter("type").toLower();
+  _isPower = parameter("type").toLower() == "power";
   if ( _bandFrequencies.size() < 2 ) {
     throw EssentiaException("TriangularBands: the 'frequencyBands' parameter contains only one element (at least two elements are required)");
   }
@@ -63,109 +63,21 @@ void TriangularBands::compute() {
     throw EssentiaException("TriangularBands: the size of the input spectrum is not greater than one");
   }
 
-  int filterSize = _nBands;
   int spectrumSize = spectrum.size();
 
-  if (_filterCoefficients.empty() || int(_filterCoefficients[0].size()) != spectrumSize) {
-      E_INFO("TriangularBands: input spectrum size (" << spectrumSize << ") does not correspond to the \"inputSize\" parameter (" << _filterCoefficients[0].size() << "). Recomputing the filter bank.");
+  if (_filterbank.spectrumSize() != spectrumSize) {
+    E_INFO("TriangularBands: input spectrum size (" << spectrumSize << ") does not correspond to the \"inputSize\" parameter (" << _filterbank.spectrumSize() << "). Recomputing the filter bank.");
     createFilters(spectrumSize);
   }
 
-  Real frequencyScale = (_sampleRate / 2.0) / (spectrum.size() - 1);
-
-  bands.resize(_nBands);
-  fill(bands.begin(), bands.end(), (Real) 0.0);
-
-  for (int i=0; i<filterSize; ++i) {
-
-    int jbegin = int(_bandFrequencies[i] / frequencyScale + 0.5);
-    int jend = int(_bandFrequencies[i+2] / frequencyScale + 0.5);
-
-    for (int j=jbegin; j<jend; ++j) {
-
-      if (_type == "power"){
-        bands[i] += (spectrum[j] * spectrum[j]) * _filterCoefficients[i][j];
-      }
-
-      if (_type == "magnitude"){
-        bands[i] += (spectrum[j]) * _filterCoefficients[i][j];
-      }
-
-    }
-    if (_isLog) bands[i] = log2(1 + bands[i]);
-  }
-  
+  _filterbank.compute(spectrum, bands, _isPower, _isLog);
 }
 
 void TriangularBands::createFilters(int spectrumSize) {
-  /*
-  Calculate the filter coefficients...
-  Basically what we're doing here is the following. Every filter is
-  a triangle starting at frequency [i] and going to frequency [i+2].
-  This way we have overlap for each filter with the next and the previous one.
-
-        /\
-  _____/  \_________
-      i    i+2
-
-  After that we normalize the filter over the whole range making sure it's
-  norm is 1.
-
-  We could use the optimized scheme from HTK/CLAM/Amadeus, but this makes
-  it so much harder to understand what's going on. And you can't have more
-  than half-band overlaps either (if needed).
-  */
-
-  if (spectrumSize < 2) {
-    throw EssentiaException("TriangularBands: Filter bank cannot be computed from a spectrum with less than 2 bins");
-  }
-
-  int filterSize = _nBands;
-
-  _filterCoefficients = vector<vector<Real> >(filterSize, vector<Real>(spectrumSize, 0.0));
-
-  Real frequencyScale = ( _sampleRate / 2.0) / (spectrumSize - 1);
-
-  for (int i=0; i<filterSize; ++i) {
-    Real fstep1 = (*_weighter)(_bandFrequencies[i+1]) - (*_weighter)(_bandFrequencies[i]);
-    Real fstep2 = (*_weighter)(_bandFrequencies[i+2]) - (*_weighter)(_bandFrequencies[i+1]);
-
-    int jbegin = int(_bandFrequencies[i] / frequencyScale + 0.5);
-    int jend = int(_bandFrequencies[i+2] / frequencyScale + 0.5);
-
-    if (jend-jbegin <= 1) {
-      throw EssentiaException("TriangularBands: the number of spectrum bins is insufficient for the specified number of triangular bands. Use zero padding to increase the number of FFT bins.");
-    }
-
-    for (int j=jbegin; j<jend; ++j) {
-      Real binfreq = j*frequencyScale;
-      // in the ascending part of the triangle...
-      if ((binfreq >= _bandFrequencies[i]) && (binfreq < _bandFrequencies[i+1])) {
-        _filterCoefficients[i][j] = ((*_weighter)(binfreq) - (*_weighter)(_bandFrequencies[i])) / fstep1;
-      }
-      // in the descending part of the triangle...
-      else if ((binfreq >= _bandFrequencies[i+1]) && (binfreq < _bandFrequencies[i+2])) {
-        _filterCoefficients[i][j] = ((*_weighter)(_bandFrequencies[i+2]) - (*_weighter)(binfreq)) / fstep2;
-      }
-    }
-  }
-
-  // normalize the filter weights
-  if ( _normalization.compare("unit_sum") == 0 ){
-    for (int i=0; i<filterSize; ++i) {
-      Real weight = 0.0;
-
-      for (int j=0; j<spectrumSize; ++j) {
-        weight += _filterCoefficients[i][j];
-      }
-
-      if (weight == 0) continue;
-
-      for (int j=0; j<spectrumSize; ++j) {
-        _filterCoefficients[i][j] = _filterCoefficients[i][j] / weight;
-      }
-    }
-  }
+  // the filters are stored as sparse rows, so that only the bins covered by
+  // each triangle are visited in compute()
+  _filterbank.createTriangularBands(_bandFrequencies, _sampleRate, spectrumSize,
+                                    _weighter, _normalization == "unit_sum");
 }
 
 void TriangularBands::setWeightingFunctions(std::string weighting){
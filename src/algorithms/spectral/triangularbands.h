@@ -22,6 +22,7 @@
 
 #include "algorithm.h"
 #include "essentiautil.h"
+#include "utils/filterbank.h"
 
 using namespace std;
 
@@ -39,10 +40,10 @@ class TriangularBands : public Algorithm {
   int _nBands;
   Real _sampleRate;
   bool _isLog;
-  std::vector<std::vector<Real> > _filterCoefficients;
+  util::Filterbank _filterbank;
   Real _inputSize;
   std::string _normalization;
-  std::string _type;
+  bool _isPower;
   void createFilters(int spectrumSize);
   void setWeightingFunctions(std::string weighting);
 
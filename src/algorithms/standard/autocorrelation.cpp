@@ -57,6 +57,8 @@ void AutoCorrelation::configure() {
 
   _fft->output("fft").set(_fftBuffer);
   _ifft->input("fft").set(_fftBuffer);
+  _fft->input("frame").set(_paddedSignal);
+  _ifft->output("frame").set(_corr);
 }
 
 void AutoCorrelation::compute() {
@@ -69,9 +71,6 @@ void AutoCorrelation::compute() {
     return;
   }
 
-  _fft->input("frame").set(_paddedSignal);
-  _ifft->output("frame").set(_corr);
-
   int size = int(signal.size());
   int sizeFFT = int(nextPowerTwo(2*size));
 
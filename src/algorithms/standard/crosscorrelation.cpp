@@ -18,7 +18,9 @@
  */
 
 #include "crosscorrelation.h"
+#include "essentiamath.h"
 
+using namespace std;
 using namespace essentia;
 using namespace standard;
 
@@ -26,6 +28,8 @@ const char* CrossCorrelation::name = "CrossCorrelation";
 const char* CrossCorrelation::category = "Standard";
 const char* CrossCorrelation::description = DOC("This algorithm computes the cross-correlation vector of two signals. It accepts 2 parameters, minLag and maxLag which define the range of the computation of the innerproduct.\n"
 "\n"
+"When many lags have to be computed on large inputs, the correlation is computed with FFTs instead of summing the products for each lag, which gives the same result up to rounding errors.\n"
+"\n"
 "An exception is thrown if \"minLag\" is larger than \"maxLag\". An exception is also thrown if the input vectors are empty.\n"
 "\n"
 "References:\n"
@@ -55,27 +59,84 @@ void CrossCorrelation::compute() {
 
   int size = wantedMaxLag - wantedMinLag + 1;
 
+  // lags for which the inputs do not overlap are left to zero
   correlation.resize(size);
+  std::fill(correlation.begin(), correlation.end(), Real(0));
 
-  int correlationIndex = 0;
+  if (minLag > maxLag) return;
+  Real* lagCorrelation = &correlation[minLag - wantedMinLag];
 
-  for (int i=0; i< minLag - wantedMinLag; i++) {
-    correlation[correlationIndex++] = 0;
+  // number of products to sum with the direct method, compared to the cost of
+  // the three FFTs (see computeFFT), with a constant measured so that both
+  // methods take about the same time at the threshold
+  double directCost = 0;
+  for (int lag = minLag; lag <= maxLag; lag++) {
+    directCost += min((int)signal_x.size(), (int)signal_y.size() + lag) - max(0, lag);
   }
+  int sizeFFT = max(2, nextPowerTwo(min((int)signal_x.size(), (int)signal_y.size() + maxLag) - max(0, minLag) +
+                             min((int)signal_y.size(), (int)signal_x.size() - minLag) - max(0, -maxLag) - 1));
+  double fftCost = 10. * sizeFFT * log2(double(sizeFFT));
 
+  if (directCost > fftCost) {
+    computeFFT(signal_x, signal_y, minLag, maxLag, lagCorrelation);
+  }
+  else {
+    computeDirect(signal_x, signal_y, minLag, maxLag, lagCorrelation);
+  }
+}
+
+void CrossCorrelation::computeDirect(const vector<Real>& x, const vector<Real>& y,
+                                     int minLag, int maxLag, Real* correlation) {
   for (int lag = minLag; lag <= maxLag; lag++) {
-    int i_start = std::max(0,lag);
-    int i_end = std::min((int)signal_x.size(),(int)signal_y.size() + lag);
+    int i_start = max(0,lag);
+    int i_end = min((int)x.size(),(int)y.size() + lag);
     Real corr = 0;
 
     for (int i=i_start; i<i_end; i++) {
-      corr += signal_x[i] * signal_y[i - lag];
+      corr += x[i] * y[i - lag];
     }
 
-    correlation[correlationIndex++] = corr;
+    *correlation++ = corr;
+  }
+}
+
+// Only the parts of the inputs which are multiplied for some lag in
+// [minLag, maxLag] are transformed: x[xStart, xEnd) and y[yStart, yEnd). The
+// correlation of these parts is computed as IFFT(X * conj(Y)), with FFTs large
+// enough for the circular correlation not to wrap around.
+void CrossCorrelation::computeFFT(const vector<Real>& x, const vector<Real>& y,
+                                  int minLag, int maxLag, Real* correlation) {
+  int xStart = max(0, minLag);
+  int xEnd = min((int)x.size(), (int)y.size() + maxLag);
+  int yStart = max(0, -maxLag);
+  int yEnd = min((int)y.size(), (int)x.size() - minLag);
+  // the FFT needs an even size
+  int sizeFFT = max(2, nextPowerTwo((xEnd - xStart) + (yEnd - yStart) - 1));
+
+  if (int(_paddedSignal.size()) != sizeFFT) {
+    _fft->configure("size", sizeFFT);
+    _ifft->configure("size", sizeFFT);
+    _paddedSignal.resize(sizeFFT);
   }
 
-  for (int i=0; i<wantedMaxLag - maxLag; i++) {
-    correlation[correlationIndex++] = 0;
+  fill(copy(x.begin() + xStart, x.begin() + xEnd, _paddedSignal.begin()), _paddedSignal.end(), Real(0));
+  _fftOutput.set(_fftX);
+  _fft->compute();
+
+  fill(copy(y.begin() + yStart, y.begin() + yEnd, _paddedSignal.begin()), _paddedSignal.end(), Real(0));
+  _fftOutput.set(_fftY);
+  _fft->compute();
+
+  for (int i=0; i<int(_fftX.size()); i++) {
+    _fftX[i] *= conj(_fftY[i]);
+  }
+  _ifft->compute();
+
+  // sum_i x[i] y[i-lag] is at index lag + yStart - xStart, modulo sizeFFT
+  Real scale = 1.0 / sizeFFT;
+  for (int lag = minLag; lag <= maxLag; lag++) {
+    int idx = lag + yStart - xStart;
+    if (idx < 0) idx += sizeFFT;
+    *correlation++ = _corr[idx] * scale;
   }
 }
@@ -20,7 +20,8 @@
 #ifndef ESSENTIA_CROSSCORRELATION_H
 #define ESSENTIA_CROSSCORRELATION_H
 
-#include "algorithm.h"
+#include "algorithmfactory.h"
+#include <complex>
 
 namespace essentia {
 namespace standard {
@@ -32,11 +33,40 @@ class CrossCorrelation : public Algorithm {
   Input<std::vector<Real> > _signal_y;
   Output<std::vector<Real> > _correlation;
 
+  std::vector<Real> _paddedSignal;
+  std::vector<std::complex<Real> > _fftX;
+  std::vector<std::complex<Real> > _fftY;
+  std::vector<Real> _corr;
+
+  // kept across calls, so that their plans are only computed once per size
+  Algorithm* _fft;
+  Algorithm* _ifft;
+  OutputHandle<std::vector<std::complex<Real> > > _fftOutput;
+
+  void computeDirect(const std::vector<Real>& x, const std::vector<Real>& y,
+                     int minLag, int maxLag, Real* correlation);
+  void computeFFT(const std::vector<Real>& x, const std::vector<Real>& y,
+                  int minLag, int maxLag, Real* correlation);
+
  public:
   CrossCorrelation() {
     declareInput(_signal_x, "arrayX", "the first input array");
     declareInput(_signal_y, "arrayY", "the second input array");
     declareOutput(_correlation, "crossCorrelation", "the cross-correlation vector between the two input arrays (its size is equal to maxLag - minLag + 1)");
+
+    _fft = AlgorithmFactory::create("FFT");
+    _ifft = AlgorithmFactory::create("IFFT");
+
+    // the buffers are members, only the output of the FFT changes afterwards
+    _fft->input("frame").set(_paddedSignal);
+    _ifft->input("fft").set(_fftX);
+    _ifft->output("frame").set(_corr);
+    _fftOutput.attach(_fft, "fft");
+  }
+
+  ~CrossCorrelation() {
+    delete _fft;
+    delete _ifft;
   }
 
   void declareParameters() {
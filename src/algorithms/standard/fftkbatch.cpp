@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "fftkbatch.h"
+#include "essentia.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* FFTKBatch::name = "FFTBatch";
+const char* FFTKBatch::category = "Standard";
+const char* FFTKBatch::description = DOC("This algorithm computes the positive complex short-term Fourier transform (STFT) of several frames at once. The result is the same as applying the FFT algorithm to each of the frames, but the FFT configuration is shared by all the frames and each transform is written directly into its output frame. In streaming mode, frames are processed in batches of 16.\n"
+"All the frames need to have the same size, which must be even and non zero, otherwise an exception is thrown.\n"
+"\n"
+"FFT computation will be carried out using the KISS library [2]"
+"\n"
+"References:\n"
+"  [1] Fast Fourier transform - Wikipedia, the free encyclopedia,\n"
+"  http://en.wikipedia.org/wiki/Fft\n\n"
+"  [2] KISS -- Keep It Simple, Stupid.\n"
+"  http://kissfft.sourceforge.net/");
+
+
+FFTKBatch::~FFTKBatch() {
+  free(_fftCfg);
+}
+
+void FFTKBatch::compute() {
+
+  const vector<vector<Real> >& frames = _frames.get();
+  vector<vector<complex<Real> > >& ffts = _ffts.get();
+
+  int count = (int)frames.size();
+  ffts.resize(count);
+  if (count == 0) return;
+
+  // check if input is OK
+  int size = (int)frames[0].size();
+  if (size == 0) {
+    throw EssentiaException("FFTBatch: Input size cannot be 0");
+  }
+  for (int i=1; i<count; i++) {
+    if ((int)frames[i].size() != size) {
+      throw EssentiaException("FFTBatch: all the input frames must have the same size");
+    }
+  }
+
+  if (_fftCfg == 0 || _fftPlanSize != size) {
+    createFFTObject(size);
+  }
+
+  // kiss_fftr doesn't modify its input, and kiss_fft_cpx has the same layout
+  // as complex<Real>, so there is no need for temporary buffers
+  for (int i=0; i<count; i++) {
+    ffts[i].resize(size/2+1);
+    kiss_fftr(_fftCfg, (const kiss_fft_scalar*)&frames[i][0], (kiss_fft_cpx*)&ffts[i][0]);
+  }
+}
+
+void FFTKBatch::configure() {
+  createFFTObject(parameter("size").toInt());
+}
+
+void FFTKBatch::createFFTObject(int size) {
+  // This is only needed because at the moment we return half of the spectrum,
+  // which means that there are 2 different input signals that could yield the
+  // same FFT...
+  if (size % 2 == 1) {
+    throw EssentiaException("FFTBatch: can only compute FFT of arrays which have an even size");
+  }
+
+  free(_fftCfg);
+  _fftCfg = kiss_fftr_alloc(size, 0, NULL, NULL);
+  _fftPlanSize = size;
+}
@@ -19,6 +19,7 @@
 
 #include "fftw.h"
 #include "essentia.h"
+#include <cstdlib>
 
 using namespace std;
 using namespace essentia;
@@ -29,26 +30,161 @@ const char* FFTW::category = "Standard";
 const char* FFTW::description = DOC("This algorithm computes the positive complex short-term Fourier transform (STFT) of an array using the FFT algorithm. The resulting fft has a size of (s/2)+1, where s is the size of the input frame.\n"
 "At the moment FFT can only be computed on frames which size is even and non zero, otherwise an exception is thrown.\n"
 "\n"
+"FFTW plans are shared by all the instances of this algorithm. The FFTW planner mode can be set to \"estimate\" (default), \"measure\" or \"patient\" with the ESSENTIA_FFTW_PLANNER environment variable, and FFTW wisdom is loaded from and saved to the file given by the ESSENTIA_FFTW_WISDOM environment variable.\n"
+"\n"
 "References:\n"
 "  [1] Fast Fourier transform - Wikipedia, the free encyclopedia,\n"
 "  http://en.wikipedia.org/wiki/Fft\n\n"
 "  [2] Fast Fourier Transform -- from Wolfram MathWorld,\n"
 "  http://mathworld.wolfram.com/FastFourierTransform.html");
 
-ForcedMutex FFTW::globalFFTWMutex;
+ForcedMutex FFTWPlanCache::mutex;
+bool FFTWPlanCache::_initialized = false;
+unsigned FFTWPlanCache::_flags = FFTW_ESTIMATE;
+string FFTWPlanCache::_wisdomFile;
+map<pair<int, int>, fftwf_plan> FFTWPlanCache::_plans;
+map<pair<int, int>, fftwf_plan> FFTWPlanCache::_manyPlans;
 
-FFTW::~FFTW() {
-  ForcedMutexLocker lock(globalFFTWMutex);
-
-  // we might have called essentia::shutdown() before this algorithm goes out
-  // of scope, so make sure we're not doing stupid things here
-  // This will cause a memory leak then, but it is definitely a better choice
-  // than a crash (right, right??? :-) )
-  if (essentia::isInitialized()) {
-    fftwf_destroy_plan(_fftPlan);
-    fftwf_free(_input);
-    fftwf_free(_output);
+
+unsigned FFTWPlanCache::plannerFlags(const string& mode) {
+  string m = toLower(mode);
+  if (m == "estimate") return FFTW_ESTIMATE;
+  if (m == "measure")  return FFTW_MEASURE;
+  if (m == "patient")  return FFTW_PATIENT;
+  throw EssentiaException("FFTW: unknown planner mode '", mode, "', should be one of: estimate, measure, patient");
+}
+
+// needs to be called with the mutex held
+void FFTWPlanCache::init() {
+  if (_initialized) return;
+  _initialized = true;
+
+  const char* mode = getenv("ESSENTIA_FFTW_PLANNER");
+  if (mode && *mode) _flags = plannerFlags(mode);
+
+  const char* wisdom = getenv("ESSENTIA_FFTW_WISDOM");
+  if (wisdom && *wisdom) {
+    _wisdomFile = wisdom;
+    if (!fftwf_import_wisdom_from_filename(_wisdomFile.c_str())) {
+      E_DEBUG(EAlgorithm, "FFTW: could not load wisdom from " << _wisdomFile);
+    }
+  }
+}
+
+void FFTWPlanCache::setPlannerMode(const string& mode) {
+  ForcedMutexLocker lock(mutex);
+  init();
+  _flags = plannerFlags(mode);
+}
+
+string FFTWPlanCache::plannerMode() {
+  ForcedMutexLocker lock(mutex);
+  init();
+  if (_flags == FFTW_MEASURE) return "measure";
+  if (_flags == FFTW_PATIENT) return "patient";
+  return "estimate";
+}
+
+void FFTWPlanCache::setWisdomFile(const string& filename) {
+  ForcedMutexLocker lock(mutex);
+  init();
+  _wisdomFile = filename;
+  if (!_wisdomFile.empty()) fftwf_import_wisdom_from_filename(_wisdomFile.c_str());
+}
+
+bool FFTWPlanCache::loadWisdom(const string& filename) {
+  ForcedMutexLocker lock(mutex);
+  return fftwf_import_wisdom_from_filename(filename.c_str()) != 0;
+}
+
+bool FFTWPlanCache::saveWisdom(const string& filename) {
+  ForcedMutexLocker lock(mutex);
+  return fftwf_export_wisdom_to_filename(filename.c_str()) != 0;
+}
+
+fftwf_plan FFTWPlanCache::plan(Kind kind, int size) {
+  ForcedMutexLocker lock(mutex);
+  init();
+
+  pair<int, int> key(kind, size);
+  map<pair<int, int>, fftwf_plan>::const_iterator it = _plans.find(key);
+  if (it != _plans.end()) return it->second;
+
+  // plan on scratch buffers: measuring overwrites them, and the plan will be
+  // executed on the buffers of the algorithms anyway. fftwf_malloc guarantees
+  // they all have the same alignment
+  fftwf_complex* in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*size);
+  fftwf_complex* out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*size);
+
+  fftwf_plan p = 0;
+  switch (kind) {
+    case REAL_FORWARD:
+      p = fftwf_plan_dft_r2c_1d(size, (float*)in, out, _flags);
+      break;
+    case REAL_INVERSE:
+      p = fftwf_plan_dft_c2r_1d(size, in, (float*)out, _flags);
+      break;
+    case COMPLEX_FORWARD:
+      p = fftwf_plan_dft_1d(size, in, out, FFTW_FORWARD, _flags);
+      break;
+  }
+
+  fftwf_free(in);
+  fftwf_free(out);
+
+  if (!p) {
+    throw EssentiaException("FFTW: could not create plan for size ", size);
   }
+
+  _plans[key] = p;
+  planCreated();
+
+  return p;
+}
+
+fftwf_plan FFTWPlanCache::planMany(int size, int howmany) {
+  ForcedMutexLocker lock(mutex);
+  init();
+
+  pair<int, int> key(size, howmany);
+  map<pair<int, int>, fftwf_plan>::const_iterator it = _manyPlans.find(key);
+  if (it != _manyPlans.end()) return it->second;
+
+  int osize = size/2 + 1;
+  float* in = (float*)fftwf_malloc(sizeof(float)*size*howmany);
+  fftwf_complex* out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*osize*howmany);
+
+  fftwf_plan p = fftwf_plan_many_dft_r2c(1, &size, howmany,
+                                         in, NULL, 1, size,
+                                         out, NULL, 1, osize,
+                                         _flags);
+  fftwf_free(in);
+  fftwf_free(out);
+
+  if (!p) {
+    throw EssentiaException("FFTW: could not create plan for ", howmany, " frames of size ", size);
+  }
+
+  _manyPlans[key] = p;
+  planCreated();
+
+  return p;
+}
+
+// needs to be called with the mutex held
+void FFTWPlanCache::planCreated() {
+  // estimated plans are cheap, only measured ones are worth being saved
+  if (_flags != FFTW_ESTIMATE && !_wisdomFile.empty()) {
+    if (!fftwf_export_wisdom_to_filename(_wisdomFile.c_str())) {
+      E_WARNING("FFTW: could not save wisdom to " << _wisdomFile);
+    }
+  }
+}
+
+
+FFTW::~FFTW() {
+  fftwf_free(_input);
+  fftwf_free(_output);
 }
 
 void FFTW::compute() {
@@ -71,7 +207,7 @@ void FFTW::compute() {
   memcpy(_input, &signal[0], size*sizeof(Real));
 
   // calculate the fft
-  fftwf_execute(_fftPlan);
+  fftwf_execute_dft_r2c(_fftPlan, _input, (fftwf_complex*)_output);
 
   // copy result from plan to output vector
   fft.resize(size/2+1);
@@ -84,8 +220,6 @@ void FFTW::configure() {
 }
 
 void FFTW::createFFTObject(int size) {
-  ForcedMutexLocker lock(globalFFTWMutex);
-
   // This is only needed because at the moment we return half of the spectrum,
   // which means that there are 2 different input signals that could yield the
   // same FFT...
@@ -99,10 +233,6 @@ void FFTW::createFFTObject(int size) {
   _input = (Real*)fftwf_malloc(sizeof(Real)*size);
   _output = (complex<Real>*)fftwf_malloc(sizeof(complex<Real>)*size);
 
-  if (_fftPlan != 0) {
-    fftwf_destroy_plan(_fftPlan);
-  }
-
-  _fftPlan = fftwf_plan_dft_r2c_1d(size, _input, (fftwf_complex*)_output, FFTW_ESTIMATE);
+  _fftPlan = FFTWPlanCache::plan(FFTWPlanCache::REAL_FORWARD, size);
   _fftPlanSize = size;
 }
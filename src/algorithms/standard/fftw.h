@@ -23,11 +23,68 @@
 #include "algorithm.h"
 #include "threading.h"
 #include <complex>
+#include <map>
 #include <fftw3.h>
 
 namespace essentia {
 namespace standard {
 
+/**
+ * Process-wide cache of FFTW plans, shared by the FFT, IFFT and FFTC
+ * algorithms. Plans are created once per size and transform kind, and are
+ * then executed by each algorithm on its own buffers using the new-array
+ * execute functions of FFTW, which are thread-safe.
+ *
+ * The planner mode and the wisdom file can be set programmatically or with
+ * the ESSENTIA_FFTW_PLANNER ("estimate", "measure" or "patient") and
+ * ESSENTIA_FFTW_WISDOM environment variables, which are read when the cache
+ * is first used. Wisdom is loaded at that time and saved back each time a new
+ * plan has been measured.
+ */
+class FFTWPlanCache {
+ public:
+  enum Kind { REAL_FORWARD, REAL_INVERSE, COMPLEX_FORWARD };
+
+  /**
+   * Returns the plan for the given kind and size, creating it if needed.
+   */
+  static fftwf_plan plan(Kind kind, int size);
+
+  /**
+   * Returns the plan computing the real forward transform of @c howmany
+   * contiguous frames of the given size at once.
+   */
+  static fftwf_plan planMany(int size, int howmany);
+
+  static void setPlannerMode(const std::string& mode);
+  static std::string plannerMode();
+
+  /**
+   * Sets the file from which wisdom is loaded and to which it is saved when
+   * new plans are measured. An empty filename disables wisdom persistence.
+   */
+  static void setWisdomFile(const std::string& filename);
+
+  static bool loadWisdom(const std::string& filename);
+  static bool saveWisdom(const std::string& filename);
+
+  // all calls to the FFTW planner need to be serialized
+  static ForcedMutex mutex;
+
+ protected:
+  static void init();
+  static unsigned plannerFlags(const std::string& mode);
+
+  static bool _initialized;
+  static unsigned _flags;
+  static std::string _wisdomFile;
+  static std::map<std::pair<int, int>, fftwf_plan> _plans;
+  static std::map<std::pair<int, int>, fftwf_plan> _manyPlans;
+
+  static void planCreated();
+};
+
+
 class FFTW : public Algorithm {
 
  protected:
@@ -35,7 +92,7 @@ class FFTW : public Algorithm {
   Output<std::vector<std::complex<Real> > > _fft;
 
  public:
-  FFTW() : _fftPlan(0), _input(0), _output(0) {
+  FFTW() : _fftPlan(0), _fftPlanSize(0), _input(0), _output(0) {
     declareInput(_signal, "frame", "the input audio frame");
     declareOutput(_fft, "fft", "the FFT of the input frame");
   }
@@ -54,9 +111,6 @@ class FFTW : public Algorithm {
   static const char* description;
 
  protected:
-  friend class IFFTW;
-  static ForcedMutex globalFFTWMutex;
-
   fftwf_plan _fftPlan;
   int _fftPlanSize;
   Real* _input;
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "fftwbatch.h"
+#include "fftw.h"
+#include "essentia.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* FFTWBatch::name = "FFTBatch";
+const char* FFTWBatch::category = "Standard";
+const char* FFTWBatch::description = DOC("This algorithm computes the positive complex short-term Fourier transform (STFT) of several frames at once. The result is the same as applying the FFT algorithm to each of the frames, but all the transforms are computed by a single call to the FFT library, which makes better use of the cache and of SIMD instructions. In streaming mode, frames are processed in batches of 16.\n"
+"All the frames need to have the same size, which must be even and non zero, otherwise an exception is thrown.\n"
+"\n"
+"References:\n"
+"  [1] Fast Fourier transform - Wikipedia, the free encyclopedia,\n"
+"  http://en.wikipedia.org/wiki/Fft\n\n"
+"  [2] FFTW, Advanced Interface,\n"
+"  http://www.fftw.org/fftw3_doc/Advanced-Interface.html");
+
+
+FFTWBatch::~FFTWBatch() {
+  fftwf_free(_input);
+  fftwf_free(_output);
+}
+
+void FFTWBatch::compute() {
+
+  const vector<vector<Real> >& frames = _frames.get();
+  vector<vector<complex<Real> > >& ffts = _ffts.get();
+
+  int count = (int)frames.size();
+  ffts.resize(count);
+  if (count == 0) return;
+
+  // check if input is OK
+  int size = (int)frames[0].size();
+  if (size == 0) {
+    throw EssentiaException("FFTBatch: Input size cannot be 0");
+  }
+  for (int i=1; i<count; i++) {
+    if ((int)frames[i].size() != size) {
+      throw EssentiaException("FFTBatch: all the input frames must have the same size");
+    }
+  }
+
+  if (_fftPlan == 0 || _fftPlanSize != size || _fftPlanCount != count) {
+    createFFTObject(size, count);
+  }
+
+  // copy input into plan
+  for (int i=0; i<count; i++) {
+    memcpy(_input + i*size, &frames[i][0], size*sizeof(Real));
+  }
+
+  // calculate all the ffts
+  fftwf_execute_dft_r2c(_fftPlan, _input, (fftwf_complex*)_output);
+
+  // copy result from plan to output vectors
+  int osize = size/2 + 1;
+  for (int i=0; i<count; i++) {
+    ffts[i].resize(osize);
+    memcpy(&ffts[i][0], _output + i*osize, osize*sizeof(complex<Real>));
+  }
+}
+
+void FFTWBatch::configure() {
+  _fftPlan = 0;
+}
+
+void FFTWBatch::createFFTObject(int size, int count) {
+  // This is only needed because at the moment we return half of the spectrum,
+  // which means that there are 2 different input signals that could yield the
+  // same FFT...
+  if (size % 2 == 1) {
+    throw EssentiaException("FFTBatch: can only compute FFT of arrays which have an even size");
+  }
+
+  // only grow the temporary storage arrays; the output holds size/2+1
+  // complexes per frame, so it may need to grow even if the input doesn't
+  if (size*count > _inputCapacity) {
+    fftwf_free(_input);
+    _inputCapacity = size*count;
+    _input = (Real*)fftwf_malloc(sizeof(Real)*_inputCapacity);
+  }
+  if ((size/2+1)*count > _outputCapacity) {
+    fftwf_free(_output);
+    _outputCapacity = (size/2+1)*count;
+    _output = (complex<Real>*)fftwf_malloc(sizeof(complex<Real>)*_outputCapacity);
+  }
+
+  _fftPlan = FFTWPlanCache::planMany(size, count);
+  _fftPlanSize = size;
+  _fftPlanCount = count;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_FFTWBATCH_H
+#define ESSENTIA_FFTWBATCH_H
+
+#include "algorithm.h"
+#include <complex>
+#include <fftw3.h>
+
+namespace essentia {
+namespace standard {
+
+class FFTWBatch : public Algorithm {
+
+ protected:
+  Input<std::vector<std::vector<Real> > > _frames;
+  Output<std::vector<std::vector<std::complex<Real> > > > _ffts;
+
+ public:
+  FFTWBatch() : _fftPlan(0), _fftPlanSize(0), _fftPlanCount(0),
+                _input(0), _output(0), _inputCapacity(0), _outputCapacity(0) {
+    declareInput(_frames, "frame", "the input audio frames");
+    declareOutput(_ffts, "fft", "the FFT of each of the input frames");
+  }
+
+  ~FFTWBatch();
+
+  void declareParameters() {
+    declareParameter("size", "the expected size of the input frames. This is purely optional and only targeted at optimizing the creation time of the FFT object", "[1,inf)", 1024);
+  }
+
+  void compute();
+  void configure();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+ protected:
+  fftwf_plan _fftPlan;
+  int _fftPlanSize;
+  int _fftPlanCount;
+  Real* _input;
+  std::complex<Real>* _output;
+  int _inputCapacity;
+  int _outputCapacity;
+
+  void createFFTObject(int size, int count);
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "streamingalgorithmwrapper.h"
+
+namespace essentia {
+namespace streaming {
+
+class FFTWBatch : public StreamingAlgorithmWrapper {
+
+ protected:
+  Sink<std::vector<Real> > _frames;
+  Source<std::vector<std::complex<Real> > > _ffts;
+
+  static const int batchSize = 16;
+
+ public:
+  FFTWBatch() {
+    declareAlgorithm("FFTBatch");
+    declareInput(_frames, STREAM, batchSize, "frame");
+    declareOutput(_ffts, STREAM, batchSize, "fft");
+  }
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_FFTWBATCH_H
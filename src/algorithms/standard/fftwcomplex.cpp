@@ -18,6 +18,7 @@
  */
 
 #include "fftwcomplex.h"
+#include "fftw.h"
 #include "essentia.h"
 
 using namespace std;
@@ -35,20 +36,9 @@ const char* FFTWComplex::description = DOC("This algorithm computes the positive
 "  [2] Fast Fourier Transform -- from Wolfram MathWorld,\n"
 "  http://mathworld.wolfram.com/FastFourierTransform.html");
 
-ForcedMutex FFTWComplex::globalFFTWCOMPLEXMutex;
-
 FFTWComplex::~FFTWComplex() {
-  ForcedMutexLocker lock(globalFFTWCOMPLEXMutex);
-
-  // we might have called essentia::shutdown() before this algorithm goes out
-  // of scope, so make sure we're not doing stupid things here
-  // This will cause a memory leak then, but it is definitely a better choice
-  // than a crash (right, right??? :-) )
-  if (essentia::isInitialized()) {
-    fftwf_destroy_plan(_fftPlan);
-    fftwf_free(_input);
-    fftwf_free(_output);
-  }
+  fftwf_free(_input);
+  fftwf_free(_output);
 }
 
 void FFTWComplex::compute() {
@@ -71,7 +61,7 @@ void FFTWComplex::compute() {
   memcpy(_input, &signal[0], size*sizeof(complex<Real>));
 
   // calculate the fft
-  fftwf_execute(_fftPlan);
+  fftwf_execute_dft(_fftPlan, (fftwf_complex*)_input, (fftwf_complex*)_output);
 
   // copy result from plan to output vector
   fft.resize(size/2+1);
@@ -84,8 +74,6 @@ void FFTWComplex::configure() {
 }
 
 void FFTWComplex::createFFTObject(int size) {
-  ForcedMutexLocker lock(globalFFTWCOMPLEXMutex);
-
   // This is only needed because at the moment we return half of the spectrum,
   // which means that there are 2 different input signals that could yield the
   // same FFT...
@@ -99,10 +87,6 @@ void FFTWComplex::createFFTObject(int size) {
   _input = (complex<Real>*)fftwf_malloc(sizeof(complex<Real>)*size);
   _output = (complex<Real>*)fftwf_malloc(sizeof(complex<Real>)*size);
 
-  if (_fftPlan != 0) {
-    fftwf_destroy_plan(_fftPlan);
-  }
-
-  _fftPlan = fftwf_plan_dft_1d(size, (fftwf_complex*)_input, (fftwf_complex*)_output, FFTW_FORWARD, FFTW_ESTIMATE);
+  _fftPlan = FFTWPlanCache::plan(FFTWPlanCache::COMPLEX_FORWARD, size);
   _fftPlanSize = size;
 }
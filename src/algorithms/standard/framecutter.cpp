@@ -162,6 +162,7 @@ void FrameCutter::reset() {
   _streamIndex = 0;
   if (_startFromZero) _startIndex = 0;
   else                _startIndex = -(_frameSize+1)/2;
+  _noiseAdder->reset();
 
   _audio.setAcquireSize(_frameSize);
   _audio.setReleaseSize(_hopSize);
@@ -201,8 +202,11 @@ void FrameCutter::configure() {
   // Adding noise to avoid divisions by zero (in case the user chooses to do so
   // by setting the silentFrames parameter to ADD_NOISE).  The level of such noise
   // is chosen to be -100dB because it will still be detected as a silent frame
-  // by essentia::isSilent() and is unhearable by humans
-  _noiseAdder->configure("fixSeed", false, "level", -100);
+  // by essentia::isSilent() and is unhearable by humans. The seed is fixed so
+  // that the output only depends on the input and the parameters, which allows
+  // the Network to merge identical FrameCutters
+  _noiseAdder->configure("fixSeed", true, "level", -100);
+  _silentFrame.reserve(_frameSize);
   reset();
 }
 
@@ -371,10 +375,10 @@ AlgorithmStatus FrameCutter::process() {
       return OK;
 
     case ADD_NOISE: {
-      vector<AudioSample> inputFrame(_frameSize, 0.0);
-      fastcopy(&inputFrame[0]+zeropadSize, &frame[0], acquireSize);
-      _noiseAdder->input("signal").set(inputFrame);
-      _noiseAdder->output("signal").set(frame);
+      _silentFrame.assign(_frameSize, 0.0);
+      fastcopy(&_silentFrame[0]+zeropadSize, &frame[0], acquireSize);
+      _noiseInput.set(_silentFrame);
+      _noiseOutput.set(frame);
       _noiseAdder->compute();
       break;
     }
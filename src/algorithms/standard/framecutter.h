@@ -99,6 +99,9 @@ class FrameCutter : public Algorithm {
   enum SilenceType {KEEP, DROP, ADD_NOISE};
   SilenceType typeFromString(const std::string& name) const;
   standard::Algorithm * _noiseAdder;
+  standard::InputHandle<std::vector<AudioSample> > _noiseInput;
+  standard::OutputHandle<std::vector<AudioSample> > _noiseOutput;
+  std::vector<AudioSample> _silentFrame;
 
   SilenceType _silentFrames;
 
@@ -110,6 +113,8 @@ class FrameCutter : public Algorithm {
     declareInput(_audio, _frameSize, 0, "signal", "the input audio signal");
     declareOutput(_frames, 1, "frame", "the frames of the audio signal");
     _noiseAdder = standard::AlgorithmFactory::create("NoiseAdder");
+    _noiseInput.attach(_noiseAdder, "signal");
+    _noiseOutput.attach(_noiseAdder, "signal");
   }
   ~FrameCutter() {
     delete _noiseAdder;
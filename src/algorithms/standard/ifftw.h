@@ -35,7 +35,7 @@ class IFFTW : public Algorithm {
   Output<std::vector<Real> > _signal;
 
  public:
-  IFFTW() : _fftPlan(0), _input(0), _output(0) {
+  IFFTW() : _fftPlan(0), _fftPlanSize(0), _input(0), _output(0) {
     declareInput(_fft, "fft", "the input frame");
     declareOutput(_signal, "frame", "the IFFT of the input frame");
   }
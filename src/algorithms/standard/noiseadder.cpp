@@ -36,11 +36,15 @@ const char* NoiseAdder::description = DOC("This algorithm adds noise to an input
 
 void NoiseAdder::configure() {
   _level = db2pow(parameter("level").toReal());
+  reset();
+}
+
+void NoiseAdder::reset() {
+  // with a fixed seed, the same noise is generated again after a reset
   if (parameter("fixSeed").toBool()) {
     unsigned long seed = 0;
     _mtrand.seed(seed);
   }
-
 }
 
 void NoiseAdder::compute() {
@@ -65,6 +65,7 @@ class NoiseAdder : public Algorithm {
 
   void configure();
   void compute();
+  void reset();
 
   static const char* name;
   static const char* category;
@@ -49,6 +49,16 @@ void PeakDetection::configure() {
     throw EssentiaException("PeakDetection: The minimum position has to be less than the maximum position");
   }
 
+  if (_orderBy == "amplitude") {
+    _orderByAmplitude = true;
+  }
+  else if (_orderBy == "position") {
+    _orderByAmplitude = false;
+  }
+  else {
+    throw EssentiaException("PeakDetection: Unsupported ordering type: '" + _orderBy + "'");
+  }
+
   // blunt test to make sure some compiler which we won't name isn't going berserk...
   std::vector<Peak> v;
   v.resize(1);
@@ -72,7 +82,8 @@ void PeakDetection::compute() {
   // which makes more sense in general?
   const Real scale = _range / (Real)(size - 1);
 
-  std::vector<Peak> peaks;
+  std::vector<Peak>& peaks = _peaks;
+  peaks.clear();
   peaks.reserve(size);
 
   // we want to round up to the next integer instead of simple truncation,
@@ -168,18 +179,19 @@ void PeakDetection::compute() {
   // we only want this many peaks
   int nWantedPeaks = std::min((int)_maxPeaks, (int)peaks.size());
 
-  if (_orderBy == "amplitude") {
+  if (_orderByAmplitude) {
     // sort peaks by magnitude, in case of equality,
     // return the one having smaller position
     std::sort(peaks.begin(), peaks.end(),
               ComparePeakMagnitude<std::greater<Real>, std::less<Real> >());
   }
-  else if (_orderBy == "position") {
-    // they're already sorted by position
-  }
-  else {
-    throw EssentiaException("PeakDetection: Unsupported ordering type: '" + _orderBy + "'");
-  }
+  // otherwise they're already sorted by position
+
+  // reserve room for as many peaks as we could ever output, so that the
+  // outputs do not grow each time a frame has more peaks than the previous ones
+  int maxPeaks = std::min(_maxPeaks, size);
+  peakPosition.reserve(maxPeaks);
+  peakValue.reserve(maxPeaks);
 
   peakPosition.resize(nWantedPeaks);
   peakValue.resize(nWantedPeaks);
@@ -21,6 +21,7 @@
 #define ESSENTIA_PEAKDETECTION_H
 
 #include "algorithm.h"
+#include "peak.h"
 
 namespace essentia {
 namespace standard {
@@ -39,6 +40,10 @@ class PeakDetection : public Algorithm {
   Real _range;
   bool _interpolate;
   std::string _orderBy;
+  bool _orderByAmplitude;
+
+  // kept between calls, so that compute() does not allocate it each time
+  std::vector<util::Peak> _peaks;
 
  public:
   PeakDetection() {
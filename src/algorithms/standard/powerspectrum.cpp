@@ -18,6 +18,7 @@
  */
 
 #include "powerspectrum.h"
+#include "essentiamath.h"
 
 using namespace essentia;
 using namespace standard;
@@ -48,13 +49,10 @@ void PowerSpectrum::compute() {
   // will be checked anyway in the FFT algorithm.
 
   // compute FFT first...
-  _fft->input("frame").set(signal);
+  _fftInput.set(signal);
   _fft->compute();
 
   // ...and then the square magnitude of it
   powerSpectrum.resize(_fftBuffer.size());
-  for (int i=0; i<int(_fftBuffer.size()); ++i) {
-    powerSpectrum[i] = _fftBuffer[i].real()*_fftBuffer[i].real() +
-                       _fftBuffer[i].imag()*_fftBuffer[i].imag();
-  }
+  util::squaredMagnitude(&_fftBuffer[0], &powerSpectrum[0], (int)_fftBuffer.size());
 }
@@ -34,6 +34,7 @@ class PowerSpectrum : public Algorithm {
 
   Algorithm* _fft;
   std::vector<std::complex<Real> > _fftBuffer;
+  InputHandle<std::vector<Real> > _fftInput;
 
  public:
   PowerSpectrum() {
@@ -42,6 +43,7 @@ class PowerSpectrum : public Algorithm {
 
     // creation of the FFT algorithm
     _fft = AlgorithmFactory::create("FFT");
+    _fftInput.attach(_fft, "frame");
   }
 
   ~PowerSpectrum() {
@@ -50,11 +50,11 @@ void Spectrum::compute() {
   // will be checked anyway in the FFT algorithm.
 
   // compute FFT first...
-  _fft->input("frame").set(signal);
+  _fftInput.set(signal);
   _fft->compute();
 
   // ...and then the magnitude of it
-  _magnitude->output("magnitude").set(spectrum);
+  _magnitudeOutput.set(spectrum);
   _magnitude->compute();
 
 }
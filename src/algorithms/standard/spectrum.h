@@ -36,6 +36,9 @@ class Spectrum : public Algorithm {
   Algorithm* _magnitude;
   std::vector<std::complex<Real> > _fftBuffer;
 
+  InputHandle<std::vector<Real> > _fftInput;
+  OutputHandle<std::vector<Real> > _magnitudeOutput;
+
  public:
   Spectrum() {
     declareInput(_signal, "frame", "the input audio frame");
@@ -43,6 +46,9 @@ class Spectrum : public Algorithm {
 
     _fft = AlgorithmFactory::create("FFT");
     _magnitude = AlgorithmFactory::create("Magnitude");
+
+    _fftInput.attach(_fft, "frame");
+    _magnitudeOutput.attach(_magnitude, "magnitude");
   }
 
   ~Spectrum() {
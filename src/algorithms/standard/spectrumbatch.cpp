@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "spectrumbatch.h"
+#include "essentiamath.h"
+
+using namespace std;
+using namespace essentia;
+using namespace standard;
+
+const char* SpectrumBatch::name = "SpectrumBatch";
+const char* SpectrumBatch::category = "Spectral";
+const char* SpectrumBatch::description = DOC("This algorithm computes the magnitude spectrum of several frames at once. The result is the same as applying the Spectrum algorithm to each of the frames, but the FFTs are computed in a single call using the FFTBatch algorithm. In streaming mode, frames are processed in batches of 16.\n"
+"All the frames need to have the same size. Each resulting magnitude spectrum has a size which is half the size of the input frames plus one.\n"
+"\n"
+"References:\n"
+"  [1] Frequency spectrum - Wikipedia, the free encyclopedia,\n"
+"  http://en.wikipedia.org/wiki/Frequency_spectrum");
+
+void SpectrumBatch::configure() {
+  // FFT configuration
+  _fft->configure("size", this->parameter("size"));
+
+  // set temp port here as it's not gonna change between consecutive calls
+  // to compute()
+  _fft->output("fft").set(_fftBuffer);
+}
+
+void SpectrumBatch::compute() {
+
+  const vector<vector<Real> >& frames = _frames.get();
+  vector<vector<Real> >& spectrums = _spectrums.get();
+
+  // no need to make checks regarding the size of the input here, as they
+  // will be checked anyway in the FFTBatch algorithm.
+
+  // compute all the FFTs first...
+  _fft->input("frame").set(frames);
+  _fft->compute();
+
+  // ...and then their magnitude, in the same way as the Magnitude algorithm
+  spectrums.resize(_fftBuffer.size());
+  for (int i=0; i<(int)_fftBuffer.size(); i++) {
+    const vector<complex<Real> >& fft = _fftBuffer[i];
+    vector<Real>& spectrum = spectrums[i];
+    spectrum.resize(fft.size());
+    if (!fft.empty()) util::magnitude(&fft[0], &spectrum[0], (int)fft.size());
+  }
+}
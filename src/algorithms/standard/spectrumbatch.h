@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_SPECTRUMBATCH_H
+#define ESSENTIA_SPECTRUMBATCH_H
+
+#include "algorithmfactory.h"
+#include <complex>
+
+namespace essentia {
+namespace standard {
+
+class SpectrumBatch : public Algorithm {
+
+ protected:
+  Input<std::vector<std::vector<Real> > > _frames;
+  Output<std::vector<std::vector<Real> > > _spectrums;
+
+  Algorithm* _fft;
+  std::vector<std::vector<std::complex<Real> > > _fftBuffer;
+
+ public:
+  SpectrumBatch() {
+    declareInput(_frames, "frame", "the input audio frames");
+    declareOutput(_spectrums, "spectrum", "the magnitude spectrum of each of the input frames");
+
+    _fft = AlgorithmFactory::create("FFTBatch");
+  }
+
+  ~SpectrumBatch() {
+    delete _fft;
+  }
+
+  void declareParameters() {
+    declareParameter("size", "the expected size of the input audio frames (this is an optional parameter to optimize memory allocation)", "[1,inf)", 2048);
+  }
+
+  void configure();
+  void compute();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+
+};
+
+} // namespace standard
+} // namespace essentia
+
+#include "streamingalgorithmwrapper.h"
+
+namespace essentia {
+namespace streaming {
+
+class SpectrumBatch : public StreamingAlgorithmWrapper {
+
+ protected:
+  Sink<std::vector<Real> > _frames;
+  Source<std::vector<Real> > _spectrums;
+
+  static const int batchSize = 16;
+
+ public:
+  SpectrumBatch() {
+    declareAlgorithm("SpectrumBatch");
+    declareInput(_frames, STREAM, batchSize, "frame");
+    declareOutput(_spectrums, STREAM, batchSize, "spectrum");
+  }
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_SPECTRUMBATCH_H
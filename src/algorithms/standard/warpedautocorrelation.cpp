@@ -62,9 +62,6 @@ void WarpedAutoCorrelation::compute() {
   // copy the input to tmp
   _tmp = signal;
 
-  // don't remove the 'std::', it will use the wrong fill otherwise
-  std::fill(warpedAutoCorrelation.begin(), warpedAutoCorrelation.end(), Real(0.0));
-
   // The following implementation matches exactly the following system, which
   // is exactly what is in the paper:
   //
@@ -82,19 +79,39 @@ void WarpedAutoCorrelation::compute() {
   //
   //
 
-  for(int lag=0; lag<maxLag; ++lag) {
-    Real previous_in = 0.0;
+  // Each lag needs the signal warped once more than for the previous one, i.e.
+  // a cascade of allpass filters. Instead of going through the whole signal
+  // for each lag, the filters for a block of lags are applied one after the
+  // other on each sample, which gives exactly the same results while reading
+  // and writing _tmp only once per block.
+  const int blockSize = 8;
+  Real previousIn[blockSize];   // unfiltered sample i-1, for each filter
+  Real previousOut[blockSize];  // filtered sample i-1, for each filter
+  Real correlation[blockSize];
+
+  for (int firstLag=0; firstLag<maxLag; firstLag+=blockSize) {
+    int nLags = min(blockSize, maxLag - firstLag);
+    for (int k=0; k<nLags; ++k) {
+      previousIn[k] = previousOut[k] = correlation[k] = 0.0;
+    }
 
-    for(int i=0; i<int(signal.size()); ++i) {
-      // the auto correlation
-      warpedAutoCorrelation[lag] += _tmp[i] * signal[i];
+    for (int i=0; i<int(signal.size()); ++i) {
+      Real x = _tmp[i];
+      for (int k=0; k<nLags; ++k) {
+        // the auto correlation
+        correlation[k] += x * signal[i];
+
+        // warp the correlation vector by applying the allpass filter
+        Real y = (previousOut[k] - x)*_lambda + previousIn[k];
+        previousIn[k] = x;
+        previousOut[k] = y;
+        x = y;
+      }
+      _tmp[i] = x;
+    }
 
-      // warp the correlation vector by applying the allpass filter
-      Real tmp;
-      if (i==0) tmp = -_lambda * _tmp[i];
-      else tmp = (_tmp[i-1] - _tmp[i])*_lambda + previous_in;
-      previous_in = _tmp[i];
-      _tmp[i] = tmp;
+    for (int k=0; k<nLags; ++k) {
+      warpedAutoCorrelation[firstLag + k] = correlation[k];
     }
   }
 }
@@ -84,9 +84,9 @@ void Windowing::compute() {
   if (_zeroPhase) {
     // first half of the windowed signal is the
     // second half of the signal with windowing!
-    for (int j=signalSize/2; j<signalSize; j++) {
-      windowedSignal[i++] = signal[j] * _window[j];
-    }
+    int half = signalSize/2;
+    util::multiply(&signal[half], &_window[half], &windowedSignal[0], signalSize - half);
+    i += signalSize - half;
 
     // zero padding
     for (int j=0; j<_zeroPadding; j++) {
@@ -94,15 +94,12 @@ void Windowing::compute() {
     }
 
     // second half of the signal
-    for (int j=0; j<signalSize/2; j++) {
-      windowedSignal[i++] = signal[j] * _window[j];
-    }
+    util::multiply(&signal[0], &_window[0], &windowedSignal[i], half);
   }
   else {
     // windowed signal
-    for (int j=0; j<signalSize; j++) {
-      windowedSignal[i++] = signal[j] * _window[j];
-    }
+    util::multiply(&signal[0], &_window[0], &windowedSignal[0], signalSize);
+    i += signalSize;
 
     // zero padding
     for (int j=0; j<_zeroPadding; j++) {
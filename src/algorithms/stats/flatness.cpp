@@ -52,8 +52,8 @@ void Flatness::compute() {
 
   Real geometricMean;
 
-  _geometricMean->input("array").set(array);
-  _geometricMean->output("geometricMean").set(geometricMean);
+  _geometricMeanInput.set(array);
+  _geometricMeanOutput.set(geometricMean);
   _geometricMean->compute();
 
   if (geometricMean == 0.0) {
@@ -31,6 +31,8 @@ class Flatness : public Algorithm {
   Input<std::vector<Real> > _array;
   Output<Real> _flatness;
   Algorithm* _geometricMean;
+  InputHandle<std::vector<Real> > _geometricMeanInput;
+  OutputHandle<Real> _geometricMeanOutput;
 
  public:
   Flatness() {
@@ -38,6 +40,8 @@ class Flatness : public Algorithm {
     declareOutput(_flatness, "flatness", "the flatness (ratio between the geometric and the arithmetic mean of the input array)");
 
     _geometricMean = AlgorithmFactory::create("GeometricMean");
+    _geometricMeanInput.attach(_geometricMean, "array");
+    _geometricMeanOutput.attach(_geometricMean, "geometricMean");
   }
 
   ~Flatness() {
@@ -87,13 +87,13 @@ void PoolAggregator::aggregateSingleRealPool(const Pool& input, Pool& output) {
 }
 
 void PoolAggregator::aggregateRealPool(const Pool& input, Pool& output) {
-  PoolOf(Real) realPool = input.getRealPool();
+  const PoolOf(Real)& realPool = input.getRealPool();
 
   for (PoolOf(Real)::const_iterator it = realPool.begin();
        it != realPool.end();
        ++it) {
-    string key = it->first;
-    vector<Real> data = it->second;
+    const string& key = it->first;
+    const vector<Real>& data = it->second;
     int dsize = int(data.size());
 
     // mean, variance, and standard deviation
@@ -174,21 +174,21 @@ void PoolAggregator::aggregateSingleVectorRealPool(const Pool& input, Pool& outp
        it != vectorRealPool.end();
        ++it) {
 
-    string key = it->first;
-    vector<Real> data = it->second;
+    const string& key = it->first;
+    const vector<Real>& data = it->second;
     output.set(key, data);
   }
 }
 
 void PoolAggregator::aggregateVectorRealPool(const Pool& input, Pool& output) {
-  PoolOf(vector<Real>) vectorRealPool = input.getVectorRealPool();
+  const PoolOf(vector<Real>)& vectorRealPool = input.getVectorRealPool();
 
   for (PoolOf(vector<Real>)::const_iterator it = vectorRealPool.begin();
        it != vectorRealPool.end();
        ++it) {
 
-    string key = it->first;
-    vector<vector<Real> > data = it->second;
+    const string& key = it->first;
+    const vector<vector<Real> >& data = it->second;
     int dsize = data.size();
 
     if (dsize == 0) continue;
@@ -390,8 +390,8 @@ void PoolAggregator::aggregateStringPool(const Pool& input, Pool& output) {
   for (PoolOf(string)::const_iterator it = stringPool.begin();
        it != stringPool.end();
        ++it) {
-    string key = it->first;
-    vector<string> data = it->second;
+    const string& key = it->first;
+    const vector<string>& data = it->second;
 
     for (int i=0; i<(int)data.size(); ++i) {
       output.add(key, data[i]);
@@ -406,8 +406,8 @@ void PoolAggregator::aggregateVectorStringPool(const Pool& input, Pool& output)
   for (PoolOf(vector<string>)::const_iterator it = vectorStringPool.begin();
        it != vectorStringPool.end();
        ++it) {
-    string key = it->first;
-    vector<vector<string> > data = it->second;
+    const string& key = it->first;
+    const vector<vector<string> >& data = it->second;
 
     for (int i=0; i<(int)data.size(); ++i) {
       output.add(key, data[i]);
@@ -416,14 +416,14 @@ void PoolAggregator::aggregateVectorStringPool(const Pool& input, Pool& output)
 }
 
 void PoolAggregator::aggregateArray2DRealPool(const Pool& input, Pool& output) {
-  PoolOf(TNT::Array2D<Real>) Array2DRealPool = input.getArray2DRealPool();
+  const PoolOf(TNT::Array2D<Real>)& Array2DRealPool = input.getArray2DRealPool();
 
   for (PoolOf(TNT::Array2D<Real>)::const_iterator it = Array2DRealPool.begin();
        it != Array2DRealPool.end();
        ++it) {
 
-    string key = it->first;
-    vector<TNT::Array2D<Real> > data = it->second;
+    const string& key = it->first;
+    const vector<TNT::Array2D<Real> >& data = it->second;
     // get frames:
     int dsize = data.size();
 
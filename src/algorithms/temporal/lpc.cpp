@@ -52,6 +52,7 @@ void LPC::configure() {
     _correlation = AlgorithmFactory::create("AutoCorrelation");
     _correlation->output("autoCorrelation").set(_r);
   }
+  _correlationInput.attach(_correlation, "array");
 }
 
 void LPC::compute() {
@@ -73,7 +74,7 @@ void LPC::compute() {
   lpc.resize(_p+1);
   reflection.resize(_p);
 
-  _correlation->input("array").set(signal);
+  _correlationInput.set(signal);
   _correlation->compute();
 
   // Levinson-Durbin algorithm
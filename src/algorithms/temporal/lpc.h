@@ -32,6 +32,7 @@ class LPC : public Algorithm {
   Output<std::vector<Real> > _lpc;
   Output<std::vector<Real> > _reflection;
   Algorithm* _correlation;
+  InputHandle<std::vector<Real> > _correlationInput;
   std::vector<Real> _r;
   int _p;
 
@@ -46,6 +46,7 @@ void PitchYin::configure() {
   _sampleRate = parameter("sampleRate").toReal();
   _tolerance = parameter("tolerance").toReal();
   _interpolate = parameter("interpolate").toBool();
+  _fftDifference = parameter("differenceMethod").toString() == "fft";
 
   _yin.resize(_frameSize/2+1);
 
@@ -70,6 +71,83 @@ void PitchYin::configure() {
                               "minPosition", _tauMin,
                               "maxPosition", _tauMax,
                               "orderBy", "amplitude");
+
+  if (_fftDifference) {
+    // the correlation with all the lags but the last one can be computed
+    // without the circular convolution wrapping around (see computeDifferenceFFT)
+    int sizeFFT = int(nextPowerTwo(2 * (int(_yin.size()) - 1)));
+    _fft->configure("size", sizeFFT);
+    _ifft->configure("size", sizeFFT);
+    _fftFrame.resize(sizeFFT);
+    _correlation.resize(sizeFFT);
+  }
+}
+
+
+// The difference function d(tau) = sum_{j=0}^{W-1} (x[j] - x[j+tau])^2, W being
+// the size of _yin. Samples after the end of the frame are taken as zeros, which
+// only happens for the last lag of frames of even size.
+void PitchYin::computeDifference(const vector<Real>& signal) {
+  int size = signal.size();
+  for (int tau=1; tau < (int) _yin.size(); ++tau) {
+    _yin[tau] = 0.;
+    int end = min((int) _yin.size(), size - tau);
+    for (int j=0; j < end; ++j) {
+      _yin[tau] += pow(signal[j] - signal[j+tau], 2);
+    }
+    for (int j=end; j < (int) _yin.size(); ++j) {
+      _yin[tau] += pow(signal[j], 2);
+    }
+  }
+}
+
+// Same as computeDifference(), using d(tau) = e(0) + e(tau) - 2 r(tau), where
+// e(tau) is the energy of x[tau..tau+W-1] and r(tau) = sum_{j=0}^{W-1} x[j] x[j+tau]
+// is the correlation of the first W samples with the frame. r is computed with
+// FFTs of size M >= 2W-2, so that j+tau < M for all the lags but the last one,
+// which is computed directly.
+void PitchYin::computeDifferenceFFT(const vector<Real>& signal) {
+  int size = signal.size();
+  int w = _yin.size();
+  int sizeFFT = _fftFrame.size();
+
+  // spectrum of the first W samples
+  fill(copy(signal.begin(), signal.begin() + w, _fftFrame.begin()), _fftFrame.end(), Real(0));
+  _fftOutput.set(_fftHead);
+  _fft->compute();
+
+  // spectrum of the frame
+  int n = min(size, sizeFFT);
+  fill(copy(signal.begin(), signal.begin() + n, _fftFrame.begin()), _fftFrame.end(), Real(0));
+  _fftOutput.set(_fftSignal);
+  _fft->compute();
+
+  for (int i=0; i < (int) _fftSignal.size(); ++i) {
+    _fftSignal[i] *= conj(_fftHead[i]);
+  }
+  _ifft->compute();
+
+  // energies in double precision, as they are updated incrementally
+  double energy0 = 0.;
+  for (int j=0; j < w; ++j) energy0 += double(signal[j]) * signal[j];
+
+  double energy = energy0;
+  Real scale = 1. / sizeFFT;
+  for (int tau=1; tau < w; ++tau) {
+    energy -= double(signal[tau-1]) * signal[tau-1];
+    if (tau + w - 1 < size) energy += double(signal[tau+w-1]) * signal[tau+w-1];
+
+    Real correlation = 0.;
+    if (tau < w - 1) {
+      correlation = _correlation[tau] * scale;
+    }
+    else {
+      for (int j=0; j < w && j + tau < size; ++j) correlation += signal[j] * signal[j+tau];
+    }
+
+    // rounding errors could make it slightly negative when it should be zero
+    _yin[tau] = max(Real(energy0 + energy - 2. * correlation), Real(0));
+  }
 }
 
 
@@ -88,12 +166,8 @@ void PitchYin::compute() {
   _yin[0] = 1.;
 
   // Compute difference function
-  for (int tau=1; tau < (int) _yin.size(); ++tau) {
-    _yin[tau] = 0.;
-    for (int j=0; j < (int) _yin.size(); ++j) {
-      _yin[tau] += pow(signal[j] - signal[j+tau], 2);
-    }
-  }
+  if (_fftDifference) computeDifferenceFFT(signal);
+  else computeDifference(signal);
 
   // Compute a cumulative mean normalized difference function
   Real sum = 0.; 
@@ -125,9 +199,6 @@ void PitchYin::compute() {
     _yin[tau] = -_yin[tau];
   }
 
-  _peakDetectLocal->input("array").set(_yin);
-  _peakDetectLocal->output("positions").set(_positions);
-  _peakDetectLocal->output("amplitudes").set(_amplitudes);
   _peakDetectLocal->compute();    
    
   if (_positions.size()) {
@@ -136,9 +207,6 @@ void PitchYin::compute() {
   }
   else {
     // no minima found below the threshold --> find the global minima
-    _peakDetectGlobal->input("array").set(_yin);
-    _peakDetectGlobal->output("positions").set(_positions);
-    _peakDetectGlobal->output("amplitudes").set(_amplitudes);
     _peakDetectGlobal->compute();    
 
     if (_positions.size()) {
@@ -20,6 +20,7 @@
 #ifndef ESSENTIA_PITCHYIN_H
 #define ESSENTIA_PITCHYIN_H
 
+#include <complex>
 #include "algorithmfactory.h"
 
 namespace essentia {
@@ -34,17 +35,30 @@ class PitchYin : public Algorithm {
 
   Algorithm* _peakDetectLocal;
   Algorithm* _peakDetectGlobal;
+  Algorithm* _fft;
+  Algorithm* _ifft;
+  OutputHandle<std::vector<std::complex<Real> > > _fftOutput;
 
   std::vector<Real> _yin;         // Yin function (cumulative mean normalized difference)
   std::vector<Real> _positions;   // Yin function peak positions
   std::vector<Real> _amplitudes;  // Yin function peak amplitudes
 
+  // buffers for computing the difference function from the autocorrelation
+  std::vector<Real> _fftFrame;
+  std::vector<std::complex<Real> > _fftHead;    // spectrum of the first half of the frame
+  std::vector<std::complex<Real> > _fftSignal;  // spectrum of the whole frame
+  std::vector<Real> _correlation;
+
   int _frameSize;
   Real _sampleRate;               
   bool _interpolate;  // whether to use peak interpolation
   Real _tolerance;
   int _tauMin;
   int _tauMax;
+  bool _fftDifference;  // whether to compute the difference function with FFTs
+
+  void computeDifference(const std::vector<Real>& signal);
+  void computeDifferenceFFT(const std::vector<Real>& signal);
 
 
  public:
@@ -55,11 +69,27 @@ class PitchYin : public Algorithm {
 
     _peakDetectLocal = AlgorithmFactory::create("PeakDetection");
     _peakDetectGlobal = AlgorithmFactory::create("PeakDetection");
+    _fft = AlgorithmFactory::create("FFT");
+    _ifft = AlgorithmFactory::create("IFFT");
+
+    // all the buffers are members, so they are bound only once
+    _peakDetectLocal->input("array").set(_yin);
+    _peakDetectLocal->output("positions").set(_positions);
+    _peakDetectLocal->output("amplitudes").set(_amplitudes);
+    _peakDetectGlobal->input("array").set(_yin);
+    _peakDetectGlobal->output("positions").set(_positions);
+    _peakDetectGlobal->output("amplitudes").set(_amplitudes);
+    _fft->input("frame").set(_fftFrame);
+    _ifft->input("fft").set(_fftSignal);
+    _ifft->output("frame").set(_correlation);
+    _fftOutput.attach(_fft, "fft");
   }
 
   ~PitchYin() {
     delete _peakDetectLocal;
     delete _peakDetectGlobal;
+    delete _fft;
+    delete _ifft;
   };
 
   void declareParameters() {
@@ -71,6 +101,7 @@ class PitchYin : public Algorithm {
     declareParameter("tolerance", "tolerance for peak detection", "[0,1]", 0.15);
     // NOTE: default tolerance value is taken from aubio yin implementation
     // https://github.com/piem/aubio/blob/master/src/pitch/pitchyin.c
+    declareParameter("differenceMethod", "how to compute the difference function: 'direct' sums the squared differences for each lag, 'fft' derives them from the autocorrelation computed with FFTs, which is much faster for large frames and equal up to rounding errors", "{direct,fft}", "direct");
   }
 
   void configure();
@@ -125,15 +125,6 @@ void PitchYinFFT::compute() {
 
   // build modified squared difference function using a weighted
   // input norm spectrum
-  vector<complex<Real> > frameFFT;
-  _fft->input("frame").set(_sqrMag);
-  _fft->output("fft").set(frameFFT);
-
-  // used to get phase and norm
-  _cart2polar->input("complex").set(frameFFT);
-  _cart2polar->output("magnitude").set(_resNorm);
-  _cart2polar->output("phase").set(_resPhase);
-
   _sqrMag[0] = spectrum[0]*spectrum[0]*_weight[0];
   sum += _sqrMag[0];
   for (l=1; l < (int)spectrum.size(); l++) {
@@ -168,9 +159,6 @@ void PitchYinFFT::compute() {
       _yin[n] = -_yin[n];
     }
     // use interal peak detection algorithm
-    _peakDetect->input("array").set(_yin);
-    _peakDetect->output("positions").set(_positions);
-    _peakDetect->output("amplitudes").set(_amplitudes);
     _peakDetect->compute();    
     try {
       tau = _positions[0];
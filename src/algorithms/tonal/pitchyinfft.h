@@ -44,6 +44,7 @@ class PitchYinFFT : public Algorithm {
   Algorithm* _cart2polar;
   Algorithm* _peakDetect;
 
+  std::vector<std::complex<Real> > _frameFFT;
   std::vector<Real> _resPhase;    /** complex vector to compute square difference function */
   std::vector<Real> _resNorm;
   std::vector<Real> _sqrMag;      /** square difference function */
@@ -68,6 +69,16 @@ class PitchYinFFT : public Algorithm {
     _fft = AlgorithmFactory::create("FFT");
     _cart2polar = AlgorithmFactory::create("CartesianToPolar");
     _peakDetect = AlgorithmFactory::create("PeakDetection");
+
+    // all the buffers are members, so they are bound only once
+    _fft->input("frame").set(_sqrMag);
+    _fft->output("fft").set(_frameFFT);
+    _cart2polar->input("complex").set(_frameFFT);
+    _cart2polar->output("magnitude").set(_resNorm);
+    _cart2polar->output("phase").set(_resPhase);
+    _peakDetect->input("array").set(_yin);
+    _peakDetect->output("positions").set(_positions);
+    _peakDetect->output("amplitudes").set(_amplitudes);
   }
 
   ~PitchYinFFT() {
@@ -36,6 +36,7 @@
 #include "types.h"
 #include "utils/tnt/tnt.h"
 #include "utils/tnt/tnt2essentiautils.h"
+#include "utils/vectorkernels.h"
 
 #define M_2PI (2 * M_PI)
 
@@ -122,6 +123,14 @@ template <typename T> T sum(const std::vector<T>& array, int start, int end) {
   return sum;
 }
 
+/**
+ * returns the sum of an array of Reals, vectorized version.
+ */
+template <> inline Real sum(const std::vector<Real>& array, int start, int end) {
+  if (end <= start) return 0.0;
+  return util::sum(&array[start], end - start);
+}
+
 /**
  * returns the mean of an array, unrolled version.
  */
@@ -371,6 +380,14 @@ template <typename T> T energy(const std::vector<T>& array) {
   return inner_product(array.begin(), array.end(), array.begin(), (T)0.0);
 }
 
+// vectorized version for arrays of Reals
+template <> inline Real energy(const std::vector<Real>& array) {
+  if (array.empty())
+    throw EssentiaException("trying to calculate energy of empty array");
+
+  return util::dot(&array[0], &array[0], array.size());
+}
+
 // returns the instantaneous power of an array
 template <typename T> T instantPower(const std::vector<T>& array) {
   return energy(array) / array.size();
@@ -442,6 +459,14 @@ template <typename T> T variance(const std::vector<T>& array, const T mean) {
   return variance / array.size();
 }
 
+// vectorized version for arrays of Reals
+template <> inline Real variance(const std::vector<Real>& array, const Real mean) {
+  if (array.empty())
+    throw EssentiaException("trying to calculate variance of empty array");
+
+  return util::sumSquaredDifferences(&array[0], mean, array.size()) / array.size();
+}
+
 // returns the skewness of an array
 template <typename T> T skewness(const std::vector<T>& array, const T mean) {
   if (array.empty())
@@ -30,6 +30,8 @@ namespace standard {
 
 
 class Algorithm;
+template <typename Type> class InputHandle;
+template <typename Type> class OutputHandle;
 
 
 class ESSENTIA_API InputBase : public TypeProxy {
@@ -37,6 +39,7 @@ class ESSENTIA_API InputBase : public TypeProxy {
  protected:
   Algorithm* _parent;
   friend class Algorithm;
+  template <typename Type> friend class InputHandle;
 
  public:
   InputBase() : _parent(0), _data(0) {}
@@ -68,6 +71,7 @@ class ESSENTIA_API OutputBase : public TypeProxy {
  protected:
   Algorithm* _parent;
   friend class Algorithm;
+  template <typename Type> friend class OutputHandle;
 
  public:
   OutputBase() : _parent(0), _data(0) {}
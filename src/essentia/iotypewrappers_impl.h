@@ -91,6 +91,65 @@ class Output : public OutputBase {
 };
 
 
+/**
+ * Typed handle on an input of another algorithm. The input is looked up by
+ * name and its type is checked only once, when attaching the handle, so
+ * that set() then only stores a pointer. This is meant for algorithms which
+ * wrap others and bind new data to them at each call to compute(): attach
+ * the handles once the wrapped algorithms have been created and use them
+ * instead of algo->input("name").set(data).
+ */
+template <typename Type>
+class InputHandle {
+ public:
+  InputHandle() : _input(0) {}
+  InputHandle(Algorithm* algo, const std::string& name) : _input(0) { attach(algo, name); }
+
+  void attach(Algorithm* algo, const std::string& name) {
+    InputBase& input = algo->input(name);
+    try {
+      input.checkType<Type>();
+    }
+    catch (EssentiaException& e) {
+      throw EssentiaException("In ", input.fullName(), "::attach(): ", e.what());
+    }
+    _input = &input;
+  }
+
+  void set(const Type& data) { _input->_data = &data; }
+
+ protected:
+  InputBase* _input;
+};
+
+
+/**
+ * Typed handle on an output of another algorithm, see InputHandle.
+ */
+template <typename Type>
+class OutputHandle {
+ public:
+  OutputHandle() : _output(0) {}
+  OutputHandle(Algorithm* algo, const std::string& name) : _output(0) { attach(algo, name); }
+
+  void attach(Algorithm* algo, const std::string& name) {
+    OutputBase& output = algo->output(name);
+    try {
+      output.checkType<Type>();
+    }
+    catch (EssentiaException& e) {
+      throw EssentiaException("In ", output.fullName(), "::attach(): ", e.what());
+    }
+    _output = &output;
+  }
+
+  void set(Type& data) { _output->_data = &data; }
+
+ protected:
+  OutputBase* _output;
+};
+
+
 } // namespace standard
 } // namespace essentia
 
@@ -27,9 +27,81 @@ using namespace TNT;
 
 namespace essentia {
 
+Pool::Pool() {
+  for (int i=0; i<SubPoolCount; i++) _generation[i] = 0;
+}
+
+Pool::Pool(const Pool& pool) :
+  _poolSingleReal(pool._poolSingleReal),
+  _poolSingleString(pool._poolSingleString),
+  _poolSingleVectorReal(pool._poolSingleVectorReal),
+  _poolReal(pool._poolReal),
+  _poolVectorReal(pool._poolVectorReal),
+  _poolString(pool._poolString),
+  _poolVectorString(pool._poolVectorString),
+  _poolArray2DReal(pool._poolArray2DReal),
+  _poolStereoSample(pool._poolStereoSample),
+  _descriptorIndex(pool._descriptorIndex),
+  _namespaceIndex(pool._namespaceIndex) {
+  for (int i=0; i<SubPoolCount; i++) _generation[i] = 0;
+}
+
+Pool& Pool::operator=(const Pool& pool) {
+  if (&pool == this) return *this;
+
+  GLOBAL_LOCK;
+
+  // our keys are kept, but the locations they cached are gone
+  for (int i=0; i<SubPoolCount; i++) ++_generation[i];
+  waitForWriters();
+
+  _poolSingleReal = pool._poolSingleReal;
+  _poolSingleString = pool._poolSingleString;
+  _poolSingleVectorReal = pool._poolSingleVectorReal;
+  _poolReal = pool._poolReal;
+  _poolVectorReal = pool._poolVectorReal;
+  _poolString = pool._poolString;
+  _poolVectorString = pool._poolVectorString;
+  _poolArray2DReal = pool._poolArray2DReal;
+  _poolStereoSample = pool._poolStereoSample;
+  _descriptorIndex = pool._descriptorIndex;
+  _namespaceIndex = pool._namespaceIndex;
+
+  return *this;
+}
+
+const Pool::Key& Pool::key(const string& name) {
+  MutexLocker lock(_mutexKeys);
+  PoolIndex(Key)::iterator it = _keys.find(name);
+  if (it == _keys.end()) {
+    it = _keys.insert(make_pair(name, Key(name))).first;
+  }
+  return it->second;
+}
+
+void Pool::waitForWriters(const string& name) {
+  MutexLocker lock(_mutexKeys);
+  PoolIndex(Key)::iterator it = _keys.find(name);
+  if (it != _keys.end()) {
+    MutexLocker keyLock(it->second._mutex);
+  }
+}
+
+void Pool::waitForWriters() {
+  MutexLocker lock(_mutexKeys);
+  for (PoolIndex(Key)::iterator it = _keys.begin(); it != _keys.end(); ++it) {
+    MutexLocker keyLock(it->second._mutex);
+  }
+}
+
 void Pool::clear() {
   GLOBAL_LOCK;
 
+  _descriptorIndex.clear();
+  _namespaceIndex.clear();
+  for (int i=0; i<SubPoolCount; i++) ++_generation[i];
+  waitForWriters();
+
   _poolReal.clear();
   _poolVectorReal.clear();
   _poolString.clear();
@@ -63,13 +135,17 @@ void Pool::checkIntegrity() const {
 // this implementation makes the assumption that the key 'name' only exists in
 // one of the sub-pools, as enforced by checkIntegrity
 void Pool::remove(const string& name) {
+  // removing a descriptor also needs to update the index, acquire a global lock
+  GLOBAL_LOCK
 
   #define SEARCH_AND_DESTROY(t, tname)                                         \
   {                                                                            \
-    MutexLocker lock(mutex##tname);                                            \
     map<string, t >::iterator i = _pool##tname.find(name);                     \
     if (i != _pool##tname.end()) {                                             \
+      ++_generation[SubPool##tname];                                           \
+      waitForWriters(name);                                                    \
       _pool##tname.erase(i);                                                   \
+      unindexKey(name);                                                        \
       return;                                                                  \
     }                                                                          \
   }
@@ -90,28 +166,19 @@ void Pool::remove(const string& name) {
 }
 
 void Pool::removeNamespace(const string& ns) {
+  // removing descriptors also needs to update the index, acquire a global lock
+  GLOBAL_LOCK
 
-  #define SEARCH_AND_DESTROY(t, tname)                              \
-  {                                                                 \
-    MutexLocker lock(mutex##tname);                                 \
-    map<string, t >::iterator it = _pool##tname.begin();            \
-    int pos = 0;                                                    \
-    /*temp iterator that keeps track of the position in the map*/   \
-    /*so we dont start from the beginning on the next iteration*/   \
-    map<string, t>::iterator tmpIt = _pool##tname.begin();          \
-    while (it != _pool##tname.end()) {                              \
-      string::size_type strIdx = it->first.find(ns+".");            \
-      if (strIdx==0) {                                              \
-        _pool##tname.erase(it);                                     \
-        if (pos == 0) it = _pool##tname.begin();                    \
-        else it = tmpIt;                                            \
-      }                                                             \
-      else {                                                        \
-        tmpIt = it;                                                 \
-        ++pos;                                                      \
-        ++it;                                                       \
-      }                                                             \
-    }                                                               \
+  // all the descriptors of the namespace are contiguous in the sorted maps
+  #define SEARCH_AND_DESTROY(t, tname)                                \
+  {                                                                   \
+    map<string, t >::iterator it = _pool##tname.lower_bound(ns+".");  \
+    while (it != _pool##tname.end() && it->first.find(ns+".") == 0) { \
+      ++_generation[SubPool##tname];                                  \
+      waitForWriters(it->first);                                      \
+      unindexKey(it->first);                                          \
+      _pool##tname.erase(it++);                                       \
+    }                                                                 \
   }
 
   SEARCH_AND_DESTROY(Real, SingleReal);
@@ -225,50 +292,67 @@ vector<string> Pool::descriptorNamesNoLocking() const {
 }
 
 void Pool::validateKey(const string& name) {
-  std::vector<std::string> allNames = descriptorNamesNoLocking();
-  for (int i=0; i<int(allNames.size()); ++i) {
-    /* first check if name already exists in another sub-pool */
-    if (name == allNames[i]) {
-      throw EssentiaException("Pool: Cannot set/add/merge value to the pool under "
-                              "the name '"+name+"' because that name already exists but "
-                              "contains a different data type than value");
-    }
-    /* now check if adding this new key will result in a parent descriptor
-     * having a value and child descriptors (there are 2 cases where this can
-     * happen)*/
-    if ( name.find(allNames[i] + ".") == 0 ) {
+  /* first check if name already exists in another sub-pool */
+  if (_descriptorIndex.find(name) != _descriptorIndex.end()) {
+    throw EssentiaException("Pool: Cannot set/add/merge value to the pool under "
+                            "the name '"+name+"' because that name already exists but "
+                            "contains a different data type than value");
+  }
+
+  /* now check if adding this new key will result in a parent descriptor
+   * having a value and child descriptors (there are 2 cases where this can
+   * happen)*/
+  for (string::size_type pos = name.find('.'); pos != string::npos; pos = name.find('.', pos+1)) {
+    string parent = name.substr(0, pos);
+    if (_descriptorIndex.find(parent) != _descriptorIndex.end()) {
       throw EssentiaException("Pool: Cannot set/add/merge value to the pool under the name '"+name+
                               "' because '"+name+"' has a parent descriptor name already in "
-                              "the pool (e.g. '"+allNames[i]+"')");
+                              "the pool (e.g. '"+parent+"')");
     }
+  }
 
-    if ( allNames[i].find(name+".") == 0 ) {
-      throw EssentiaException("Pool: Cannot add/set/merge value to the pool under "
-                              "the name '"+name+"' because '"+name+"' has child descriptor "
-                              "names (e.g. '"+allNames[i]+"')");
+  if (_namespaceIndex.find(name) != _namespaceIndex.end()) {
+    // look for one of the children, only for the error message
+    string child;
+    std::vector<std::string> allNames = descriptorNamesNoLocking();
+    for (int i=0; i<int(allNames.size()); ++i) {
+      if (allNames[i].find(name+".") == 0) {
+        child = allNames[i];
+        break;
+      }
+    }
+    throw EssentiaException("Pool: Cannot add/set/merge value to the pool under "
+                            "the name '"+name+"' because '"+name+"' has child descriptor "
+                            "names (e.g. '"+child+"')");
+  }
+
+  _descriptorIndex[name] = 1;
+  for (string::size_type pos = name.find('.'); pos != string::npos; pos = name.find('.', pos+1)) {
+    _namespaceIndex[name.substr(0, pos)]++;
+  }
+}
+
+void Pool::unindexKey(const string& name) {
+  _descriptorIndex.erase(name);
+  for (string::size_type pos = name.find('.'); pos != string::npos; pos = name.find('.', pos+1)) {
+    PoolIndex(int)::iterator it = _namespaceIndex.find(name.substr(0, pos));
+    if (it != _namespaceIndex.end() && --(it->second) == 0) {
+      _namespaceIndex.erase(it);
     }
   }
 }
 
 #define SPECIALIZE_ADD_IMPL(type, tname)                                     \
 void Pool::add(const string& name, const type& value, bool validityCheck) {  \
+  add(key(name), value, validityCheck);                                      \
+}                                                                            \
                                                                              \
-  /* first check if the pool has ever seen this key before, if it has, we can
-   * just add it, if not, we need to run some validation tests */            \
-  {                                                                          \
-    MutexLocker lock(mutex##tname);                                          \
-    if (validityCheck && !isValid(value)) {                                  \
-      throw EssentiaException("Pool::add value contains invalid numbers (NaN or inf)");\
-    }                                                                        \
-    if (_pool##tname.find(name) != _pool##tname.end()) {                     \
-      _pool##tname[name].push_back(value);                                   \
-      return;                                                                \
-    }                                                                        \
+void Pool::add(const Key& key, const type& value, bool validityCheck) {      \
+  if (validityCheck && !isValid(value)) {                                    \
+    throw EssentiaException("Pool::add value contains invalid numbers (NaN or inf)");\
   }                                                                          \
-  /* validating will require checking all sub-pools, acquire a global lock*/ \
-  GLOBAL_LOCK                                                                \
-  validateKey(name);                                                         \
-  _pool##tname[name].push_back(value);                                       \
+  MutexLocker lock(key._mutex);                                              \
+  lockValues(key, _pool##tname, mutex##tname, SubPool##tname, lock).push_back(value);\
 }
 
 
@@ -282,41 +366,28 @@ SPECIALIZE_ADD_IMPL(StereoSample, StereoSample);
 // Array2D needs a special add that cannot be implemented in the macro because
 // we need to call the function copy(), or otherwise we only get references
 void Pool::add(const string& name, const Array2D<Real>& value, bool validityCheck) {
-  /* first check if the pool has ever seen this key before, if it has, we can
-   * just add it, if not, we need to run some validation tests */
-  {
-    MutexLocker lock(mutexArray2DReal);
-    if (validityCheck && !isValid(value)) {
-      throw EssentiaException("Pool::add array contains invalid numbers (NaN or inf)");
-    }
-    if (_poolArray2DReal.find(name) != _poolArray2DReal.end()) {
-      _poolArray2DReal[name].push_back(value.copy());
-      return;
-    }
+  add(key(name), value, validityCheck);
+}
+
+void Pool::add(const Key& key, const Array2D<Real>& value, bool validityCheck) {
+  if (validityCheck && !isValid(value)) {
+    throw EssentiaException("Pool::add array contains invalid numbers (NaN or inf)");
   }
-  GLOBAL_LOCK
-  validateKey(name);
-  _poolArray2DReal[name].push_back(value.copy());
+  MutexLocker lock(key._mutex);
+  lockValues(key, _poolArray2DReal, mutexArray2DReal, SubPoolArray2DReal, lock).push_back(value.copy());
 }
 
 #define SPECIALIZE_SET_IMPL(type, tname)                                     \
 void Pool::set(const string& name, const type& value, bool validityCheck) {  \
+  set(key(name), value, validityCheck);                                      \
+}                                                                            \
                                                                              \
-  /* first check if the pool has ever seen this key before, if it has, we can
-   * just set it, if not, we need to run some validation tests */            \
-  {                                                                          \
-    MutexLocker lock(mutexSingle##tname);                                    \
-    if (validityCheck && !isValid(value)) {                                  \
-      throw EssentiaException("Pool::set value contains invalid numbers (NaN or inf)");\
-    }                                                                        \
-    if (_poolSingle##tname.find(name) != _poolSingle##tname.end()) {         \
-      _poolSingle##tname[name] = value;                                      \
-      return;                                                                \
-    }                                                                        \
+void Pool::set(const Key& key, const type& value, bool validityCheck) {      \
+  if (validityCheck && !isValid(value)) {                                    \
+    throw EssentiaException("Pool::set value contains invalid numbers (NaN or inf)");\
   }                                                                          \
-  GLOBAL_LOCK                                                                \
-  validateKey(name);                                                         \
-  _poolSingle##tname[name] = value;                                          \
+  MutexLocker lock(key._mutex);                                              \
+  lockValues(key, _poolSingle##tname, mutexSingle##tname, SubPoolSingle##tname, lock) = value;\
 }
 
 SPECIALIZE_SET_IMPL(Real, Real)
@@ -384,6 +455,8 @@ void Pool::merge(const string& name, const vector<type>& value, const string& me
     MutexLocker lock(mutex##tname);                                                                    \
     map<string, vector<type> >::iterator it = _pool##tname.find(name);                                 \
     if (it != _pool##tname.end()) {                                                                    \
+      ++_generation[SubPool##tname];                                                                   \
+      waitForWriters(name);                                                                            \
       if (mergeType == "") {                                                                           \
         throw EssentiaException("Pool::merge, cannot merge descriptor names with the same name:" +     \
                                 name + " unless a merge type (\"append\", \"replace\" or " +           \
@@ -444,6 +517,8 @@ void Pool::mergeSingle(const string& name, const type& value, const string& merg
     MutexLocker lock(mutexSingle##tname);                                                              \
     map<string, type>::iterator it = _poolSingle##tname.find(name);                                    \
     if (it != _poolSingle##tname.end()) {                                                              \
+      ++_generation[SubPoolSingle##tname];                                                             \
+      waitForWriters(name);                                                                            \
       if (mergeType == "replace") {                                                                    \
         _poolSingle##tname.erase(it);                                                                  \
         _poolSingle##tname.insert(make_pair(name, value));                                             \
@@ -472,6 +547,8 @@ void Pool::merge(const string& name, const vector<Array2D<Real> >& value, const
     MutexLocker lock(mutexArray2DReal);
     map<string, vector<Array2D<Real> > >::iterator it = _poolArray2DReal.find(name);
     if (it != _poolArray2DReal.end()) {
+      ++_generation[SubPoolArray2DReal];
+      waitForWriters(name);
       if (mergeType == "") {
         throw EssentiaException("Pool::merge, cannot merge descriptor names with the same name:" +
                                 name + " unless a merge type (\"append\", \"replace\" or " +
@@ -22,9 +22,14 @@
 
 #include "types.h"
 #include "threading.h"
+#include "utils/atomic.h"
 #include "utils/tnt/tnt.h"
 #include "essentiautil.h"
 
+#if __cplusplus >= 201103L
+#include <unordered_map>
+#endif
+
 namespace essentia {
 
 // standard map and not EssentiaMap because we want a new element
@@ -32,6 +37,14 @@ namespace essentia {
 /** @todo use intel's tbb concurrent_map */
 #define PoolOf(type) std::map<std::string, std::vector<type > >
 
+// hash map used for indexing descriptor names, when the order in which they
+// are stored doesn't matter
+#if __cplusplus >= 201103L
+#define PoolIndex(type) std::unordered_map<std::string, type >
+#else
+#define PoolIndex(type) std::map<std::string, type >
+#endif
+
 typedef std::string DescriptorName;
 
 /**
@@ -91,9 +104,70 @@ typedef std::string DescriptorName;
  *
  * To release the locks, the order should be reversed!
  *
+ * When values are repeatedly added under the same descriptor name (e.g. once
+ * per frame), the descriptor name can be interned once using the key() method.
+ * The returned Pool::Key can then be used in place of the name when calling
+ * add(), set() and append(), which then skip the lookup of the name.
+ *
+ * Besides the mutexes of the sub-pools, which protect the structure of the
+ * maps, each descriptor has its own lock protecting its values. Adding values
+ * to an existing descriptor only takes the lock of that descriptor, so that
+ * several threads (e.g. several networks sharing the same output pool) can add
+ * values to different descriptors at the same time without waiting for each
+ * other. The sub-pool mutexes are only taken when a descriptor is created,
+ * removed or merged. Reading the values of a descriptor while another thread
+ * is adding values to that same descriptor is not safe.
+ *
  */
 class Pool {
 
+ public:
+
+  /**
+   * Identifies the sub-pools, used for indexing the locations cached in a Key.
+   */
+  enum SubPool {
+    SubPoolReal, SubPoolVectorReal, SubPoolString, SubPoolVectorString,
+    SubPoolArray2DReal, SubPoolStereoSample,
+    SubPoolSingleReal, SubPoolSingleString, SubPoolSingleVectorReal,
+    SubPoolCount
+  };
+
+  /**
+   * An interned descriptor name, as returned by Pool::key(). A key caches the
+   * location of the values of its descriptor in each of the sub-pools, so
+   * that adding values through it doesn't need to look up the name. It also
+   * holds the lock of the descriptor.
+   * Keys are owned by the pool which created them and can only be used with
+   * it. They stay valid for the whole lifetime of the pool, even if the
+   * descriptor is removed from it or if the pool is cleared.
+   */
+  class Key {
+   public:
+    const std::string& name() const { return _name; }
+
+   protected:
+    friend class Pool;
+
+    explicit Key(const std::string& name) : _name(name) {
+      for (int i=0; i<SubPoolCount; i++) {
+        _values[i] = 0;
+        _generation[i] = 0;
+      }
+    }
+
+    std::string _name;
+
+    // lock of the descriptor, held while adding values to it. It also
+    // protects the cached locations below.
+    mutable Mutex _mutex;
+
+    // cached location of the values in each sub-pool, only valid while the
+    // generation matches the one of the sub-pool
+    mutable void* _values[SubPoolCount];
+    mutable int _generation[SubPoolCount];
+  };
+
  protected:
   // maps for single values:
   std::map<std::string, Real> _poolSingleReal;
@@ -108,15 +182,64 @@ class Pool {
   PoolOf(TNT::Array2D<Real>) _poolArray2DReal;
   PoolOf(StereoSample) _poolStereoSample;
 
+  // index of all the descriptor names in the pool, and of all the namespaces
+  // they belong to (with the number of descriptors in each namespace). They
+  // are protected by the global lock.
+  PoolIndex(int) _descriptorIndex;
+  PoolIndex(int) _namespaceIndex;
+
+  // incremented each time values of a sub-pool are erased or modified other
+  // than through a key, which invalidates the locations cached by the keys.
+  // It is read without locking the sub-pool, so that adding values through a
+  // key only needs the lock of the descriptor.
+  Atomic _generation[SubPoolCount];
+
+  // interned descriptor names, see key(). Lock ordering is: sub-pools, then
+  // _mutexKeys, then the locks of the descriptors.
+  PoolIndex(Key) _keys;
+  Mutex _mutexKeys;
+
   // WARNING: this function assumes that all sub-pools are locked
   std::vector<std::string> descriptorNamesNoLocking() const;
 
   /**
    * helper function for key validation when adding/setting/merging values to
-   * the pool
+   * the pool. As the value is always inserted right after the validation,
+   * this also adds the name to the descriptor index.
+   * WARNING: this function assumes that all sub-pools are locked
    */
    void validateKey(const std::string& name);
 
+  /**
+   * removes the name from the descriptor index, after its values have been
+   * erased from the pool.
+   * WARNING: this function assumes that all sub-pools are locked
+   */
+  void unindexKey(const std::string& name);
+
+  /**
+   * Waits for all the threads currently adding values to the descriptor
+   * @e name. Modifying the values of a descriptor other than through its key
+   * needs to lock the sub-pool, increment its generation and then call this,
+   * after which no thread can access the values until the sub-pool is
+   * unlocked.
+   */
+  void waitForWriters(const std::string& name);
+
+  /** Waits for all the threads currently adding values to the pool. */
+  void waitForWriters();
+
+  /**
+   * @returns the values stored under @e key in the given sub-pool. The
+   *          descriptor is validated and created if it doesn't exist yet.
+   * @param lock must hold the lock of the descriptor when calling this
+   *             function, which can be released and re-acquired while
+   *             looking up the values. It still holds it when returning.
+   */
+  template <typename T>
+  T& lockValues(const Key& key, std::map<std::string, T>& pool, Mutex& poolMutex,
+                SubPool subPool, MutexLocker& lock);
+
 
  public:
 
@@ -124,6 +247,27 @@ class Pool {
                 mutexArray2DReal, mutexStereoSample,
                 mutexSingleReal, mutexSingleString, mutexSingleVectorReal;
 
+  Pool();
+
+  /**
+   * Copies the descriptors of @e pool. The keys are not copied, as they are
+   * bound to the pool which created them.
+   */
+  Pool(const Pool& pool);
+
+  /** @copydoc Pool(const Pool&) */
+  Pool& operator=(const Pool& pool);
+
+  /**
+   * @returns the interned key for the descriptor name @e name, which can be
+   *          used instead of the name for adding values to the pool. The
+   *          same key is returned each time the same name is given.
+   * @remark The key doesn't add the descriptor to the pool, nor does it
+   *         check the validity of the name: this happens when the first
+   *         value is added through it.
+   */
+  const Key& key(const std::string& name);
+
   /**
    * Adds @e value to the Pool under @e name
    * @param name a descriptor name that identifies the collection of data to add
@@ -163,6 +307,27 @@ class Pool {
   /** @copydoc add(const std::string&,const Real&,bool) */
   void add(const std::string& name, const StereoSample& value, bool validityCheck = false);
 
+  /**
+   * Adds @e value to the Pool under the descriptor name interned in @e key.
+   * @copydetails add(const std::string&,const Real&,bool)
+   */
+  void add(const Key& key, const Real& value, bool validityCheck = false);
+
+  /** @copydoc add(const Key&,const Real&,bool) */
+  void add(const Key& key, const std::vector<Real>& value, bool validityCheck = false);
+
+  /** @copydoc add(const Key&,const Real&,bool) */
+  void add(const Key& key, const std::string& value, bool validityCheck = false);
+
+  /** @copydoc add(const Key&,const Real&,bool) */
+  void add(const Key& key, const std::vector<std::string>& value, bool validityCheck = false);
+
+  /** @copydoc add(const Key&,const Real&,bool) */
+  void add(const Key& key, const TNT::Array2D<Real>& value, bool validityCheck = false);
+
+  /** @copydoc add(const Key&,const Real&,bool) */
+  void add(const Key& key, const StereoSample& value, bool validityCheck = false);
+
   /**
    * WARNING: this is an utility method that might fail in weird ways if not used
    * correctly. When in doubt, always use the add() method. This is provided for
@@ -171,6 +336,10 @@ class Pool {
   template <typename T>
   void append(const std::string& name, const std::vector<T>& values);
 
+  /** @copydoc append(const std::string&,const std::vector<T>&) */
+  template <typename T>
+  void append(const Key& key, const std::vector<T>& values);
+
   /**
    * \brief Sets the value of a descriptor name.
    *
@@ -197,6 +366,18 @@ class Pool {
   /** @copydoc set(const std::string&,const Real&i, bool) */
   void set(const std::string& name, const std::string& value, bool validityCheck=false);
 
+  /**
+   * Sets the value of the descriptor name interned in @e key.
+   * @copydetails set(const std::string&,const Real&, bool)
+   */
+  void set(const Key& key, const Real& value, bool validityCheck=false);
+
+  /** @copydoc set(const Key&,const Real&, bool) */
+  void set(const Key& key, const std::vector<Real>& value, bool validityCheck=false);
+
+  /** @copydoc set(const Key&,const Real&, bool) */
+  void set(const Key& key, const std::string& value, bool validityCheck=false);
+
   /**
    * \brief Merges the current pool with the given one @e p.
    *
@@ -479,39 +660,69 @@ MutexLocker lockSingleVectorReal(mutexSingleVectorReal);
 
 
 
+template <typename T>
+inline T& Pool::lockValues(const Key& key, std::map<std::string, T>& pool, Mutex& poolMutex,
+                           SubPool subPool, MutexLocker& lock) {
+  if (key._values[subPool] && key._generation[subPool] == _generation[subPool]) {
+    return *(T*)key._values[subPool];
+  }
+  lock.release();
+
+  /* the descriptor may already exist, in which case only its location needs
+   * to be cached in the key */
+  {
+    MutexLocker poolLock(poolMutex);
+    typename std::map<std::string, T>::iterator it = pool.find(key._name);
+    if (it != pool.end()) {
+      lock.acquire(key._mutex);
+      key._values[subPool] = &it->second;
+      key._generation[subPool] = _generation[subPool];
+      return it->second;
+    }
+  }
+
+  /* validating will require checking all sub-pools, acquire a global lock.
+   * Another thread may have created the descriptor in the meantime */
+  GLOBAL_LOCK
+  typename std::map<std::string, T>::iterator it = pool.find(key._name);
+  if (it == pool.end()) {
+    validateKey(key._name);
+    it = pool.insert(std::make_pair(key._name, T())).first;
+  }
+  lock.acquire(key._mutex);
+  key._values[subPool] = &it->second;
+  key._generation[subPool] = _generation[subPool];
+  return it->second;
+}
+
+
 template<typename T>
-inline void Pool::append(const std::string& name, const std::vector<T>& values) {
+inline void Pool::append(const Key& key, const std::vector<T>& values) {
   throw EssentiaException("Pool::append not implemented for type: ", nameOfType(typeid(T)));
 }
 
 #define SPECIALIZE_APPEND(type, tname)                                                \
 template <>                                                                           \
-inline void Pool::append(const std::string& name, const std::vector<type>& values) {  \
-  {                                                                                   \
-    MutexLocker lock(mutex##tname);                                                   \
-    PoolOf(type)::iterator result = _pool##tname.find(name);                          \
-    if (result != _pool##tname.end()) {                                               \
-                                                                                      \
-      std::vector<type>& v = result->second;                                          \
-      int vsize = v.size();                                                           \
-      v.resize(vsize + values.size());                                                \
-      fastcopy(&v[vsize], &values[0], values.size());                                 \
-      return;                                                                         \
-    }                                                                                 \
-  }                                                                                   \
-                                                                                      \
-  GLOBAL_LOCK                                                                         \
-  validateKey(name);                                                                  \
-  _pool##tname[name] = values;                                                        \
+inline void Pool::append(const Key& key, const std::vector<type>& values) {           \
+  MutexLocker lock(key._mutex);                                                       \
+  std::vector<type>& v = lockValues(key, _pool##tname, mutex##tname,                  \
+                                    SubPool##tname, lock);                            \
+  int vsize = v.size();                                                               \
+  v.resize(vsize + values.size());                                                    \
+  fastcopy(&v[vsize], &values[0], values.size());                                     \
 }
 
-
 SPECIALIZE_APPEND(Real, Real);
 SPECIALIZE_APPEND(std::vector<Real>, VectorReal);
 SPECIALIZE_APPEND(std::string, String);
 SPECIALIZE_APPEND(std::vector<std::string>, VectorString);
 SPECIALIZE_APPEND(StereoSample, StereoSample);
 
+template<typename T>
+inline void Pool::append(const std::string& name, const std::vector<T>& values) {
+  append(key(name), values);
+}
+
 /// @endcond
 
 } // namespace essentia
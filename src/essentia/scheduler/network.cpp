@@ -18,8 +18,13 @@
  */
 
 #include <stack>
+#include <fstream>
+#include <sstream>
 #include "network.h"
 #include "graphutils.h"
+#include "threadpool.h"
+#include "networkprofiler.h"
+#include "allocationguard.h"
 #include "../streaming/streamingalgorithm.h"
 #include "../streaming/streamingalgorithmcomposite.h"
 using namespace std;
@@ -160,7 +165,18 @@ Network* Network::lastCreated = 0;
 Network::Network(Algorithm* generator, bool takeOwnership) : _takeOwnership(takeOwnership),
                                                              _generator(generator),
                                                              _visibleNetworkRoot(0),
-                                                             _executionNetworkRoot(0) {
+                                                             _executionNetworkRoot(0),
+                                                             _nThreads(1),
+                                                             _threadPool(0),
+                                                             _mergeIdentical(false),
+                                                             _profiling(false),
+                                                             _trace(false),
+                                                             _profiler(0),
+                                                             _realTime(false),
+                                                             _warmUpSteps(64),
+                                                             _steps(0),
+                                                             _schedulerAllocations(0),
+                                                             _adaptiveBuffers(false) {
   lastCreated = this;
 
   // 1- find the simple list of algorithms connected in this network
@@ -175,9 +191,57 @@ Network::Network(Algorithm* generator, bool takeOwnership) : _takeOwnership(take
 Network::~Network() {
   if (lastCreated == this) lastCreated = 0;
   clear();
+  delete _threadPool;
+  delete _profiler;
+}
+
+void Network::setNumberOfThreads(int nThreads) {
+  if (nThreads < 1) {
+    throw EssentiaException("Network: number of threads should be at least 1, got ", nThreads);
+  }
+  if (nThreads == _nThreads) return;
+
+  delete _threadPool;
+  _threadPool = 0;
+  _nThreads = nThreads;
+
+  if (_nThreads > 1) _threadPool = new ThreadPool(_nThreads);
+}
+
+void Network::setProfiling(bool enabled, bool trace) {
+  _profiling = enabled;
+  _trace = enabled && trace;
+}
+
+void Network::setRealTime(bool realTime, int warmUpSteps) {
+  if (warmUpSteps < 0) {
+    throw EssentiaException("Network: number of warm-up steps should be positive, got ", warmUpSteps);
+  }
+  _realTime = realTime;
+  _warmUpSteps = warmUpSteps;
+}
+
+bool Network::countingAllocations() const {
+  return _realTime && _steps >= _warmUpSteps && AllocationGuard::enabled();
+}
+
+void Network::reportAllocations() {
+  for (int i=0; i<(int)_allocations.size(); i++) {
+    if (_allocations[i] > 0 && !_allocationReported[i]) {
+      E_WARNING("Network: " << _toposortedNetwork[i]->name() << " allocated memory after "
+                << _warmUpSteps << " warm-up steps in real-time mode");
+      _allocationReported[i] = 1;
+    }
+  }
 }
 
 void Network::clear() {
+  if (_profiler) {
+    // keep the results, but the profiler can't look at the algorithms anymore
+    _profiler->updateTokenCounts();
+    _profiler->detachAlgorithms();
+  }
+
   if (_takeOwnership) {
     deleteAlgorithms();
   }
@@ -227,6 +291,8 @@ void Network::run() {
   runPrepare();
   while (runStep());
 
+  if (_adaptiveBuffers) fitBufferSizes();
+
   string dash(24, '-');
   E_DEBUG(ENetwork, dash << " Final buffer states " << dash);
   printBufferFillState();
@@ -243,8 +309,22 @@ void Network::runPrepare() {
   // 3- make sure all inputs/outputs are correctly connected
   checkConnections();
 
-  // 4- resize the buffers depending on the requirements of the connected sinks
+  // 4- resize the buffers depending on the requirements of the connected sinks,
+  //    or to the sizes which have been fitted on a previous run
   checkBufferSizes();
+  applyBufferSizes();
+
+  // 5- start measuring from here, if asked to
+  delete _profiler;
+  _profiler = _profiling ? new NetworkProfiler(_toposortedNetwork, _trace) : 0;
+
+  // 6- allocate what the scheduler needs while running
+  _runStack.clear();
+  _runStack.reserve(_toposortedNetwork.size());
+  _steps = 0;
+  _allocations.assign(_toposortedNetwork.size(), 0);
+  _allocationReported.assign(_toposortedNetwork.size(), 0);
+  _schedulerAllocations = 0;
 
 #if DEBUGGING_ENABLED
   for (int i=0; i<(int)_toposortedNetwork.size(); i++) _toposortedNetwork[i]->nProcess = 0;
@@ -254,15 +334,22 @@ void Network::runPrepare() {
 
 // returns False when there are no more steps to run
 bool Network::runStep() {
-  // 5- actually run the network
+  // 7- actually run the network
   if (_toposortedNetwork.empty()) return false;
 
   streaming::Algorithm* gen = _toposortedNetwork[0];
 
-  if(gen->shouldStop()) return false;
+  if(gen->shouldStop()) {
+    if (_profiler) _profiler->updateTokenCounts();
+    return false;
+  }
+
+  bool counting = countingAllocations();
+  sint64 stepStart = AllocationGuard::allocations();
+  sint64 inProcess = 0;
 
 #if DEBUGGING_ENABLED
-  string dash(24, '-');
+  static const string dash(24, '-');
 
   restoreDebugLevels();
   setDebugLevelForTimeIndex(gen->nProcess);
@@ -273,7 +360,19 @@ bool Network::runStep() {
 #endif
 
   // first run the generator once
-  gen->process();
+  AlgorithmStatus genStatus;
+  if (_profiler) genStatus = _profiler->process(0);
+  else genStatus = gen->process();
+
+  // only the steps where the generator produced data count for the warm-up
+  // (a real-time generator which is polled returns NO_INPUT when it has
+  // nothing), and there is no need to count any further once it is over
+  if (genStatus == OK && _steps < _warmUpSteps) _steps++;
+
+  if (counting) {
+    inProcess = AllocationGuard::allocations() - stepStart;
+    _allocations[0] += inProcess;
+  }
 
   bool endOfStream = gen->shouldStop();
 
@@ -288,20 +387,39 @@ bool Network::runStep() {
   //printBufferFillState();
 #endif
 
+  if (_threadPool) {
+    // then run all the other algorithms, with independent branches running concurrently
+    runStepParallel(endOfStream, counting);
+
+    E_DEBUG(EScheduler, dash << " Buffer states after running the generator and all the nodes " << dash);
+    printBufferFillState();
+
+    if (counting) reportAllocations();
+    return true;
+  }
+
   // then run each algorithm as many times as needed for them to consume everything on their input
-  stack<int> runStack;
-  runStack.push(1);
-  while (!runStack.empty()) {
-    int startIndex = runStack.top();
-    runStack.pop();
+  _runStack.push_back(1);
+  while (!_runStack.empty()) {
+    int startIndex = _runStack.back();
+    _runStack.pop_back();
 
     for (int i=startIndex; i<(int)_toposortedNetwork.size(); i++) {
       // only propagate the end of stream marker as long as we don't have any
       // algorithm rescheduled to run
-      _toposortedNetwork[i]->shouldStop(endOfStream && runStack.empty());
+      _toposortedNetwork[i]->shouldStop(endOfStream && _runStack.empty());
       AlgorithmStatus status;
       do {
-        status = _toposortedNetwork[i]->process();
+        sint64 before = counting ? AllocationGuard::allocations() : 0;
+
+        if (_profiler) status = _profiler->process(i);
+        else status = _toposortedNetwork[i]->process();
+
+        if (counting) {
+          sint64 allocated = AllocationGuard::allocations() - before;
+          _allocations[i] += allocated;
+          inProcess += allocated;
+        }
 
 #if DEBUGGING_ENABLED
         if (status == OK || status == FINISHED) _toposortedNetwork[i]->nProcess++;
@@ -313,7 +431,7 @@ bool Network::runStep() {
         // NOTE: be careful with endOfStream, it should not be propagated
         // as long as we have at least 1 index value on the stack
         if (status == NO_OUTPUT) {
-          runStack.push(i);
+          _runStack.push_back(i);
           E_DEBUG(EScheduler, "Rescheduling algorithm " << _toposortedNetwork[i]->name() <<
                   " on generator frame " << gen->nProcess <<
                   " to run later, output buffers temporarily full");
@@ -332,9 +450,131 @@ bool Network::runStep() {
   }
   E_DEBUG(EScheduler, dash << " Buffer states after running the generator and all the nodes " << dash);
   printBufferFillState();
+
+  if (counting) {
+    _schedulerAllocations += AllocationGuard::allocations() - stepStart - inProcess;
+    reportAllocations();
+  }
   return true;
 }
 
+
+/**
+ * Runs one pass of the parallel scheduler over a subset of the algorithms of
+ * the network. Each algorithm is run (as many times as it can consume data)
+ * once all its parents in the pass have been run.
+ *
+ * The end of stream is only propagated to an algorithm if none of its parents
+ * in this pass had to be rescheduled (ie: they all managed to flush all their
+ * output), which mirrors the behavior of the sequential scheduler.
+ */
+class ParallelStep : public TaskList {
+ public:
+  ParallelStep(const vector<Algorithm*>& algos,
+               const vector<vector<int> >& children,
+               const vector<char>& inStep,
+               bool endOfStream,
+               NetworkProfiler* profiler,
+               vector<sint64>* allocations) :
+    _algos(algos), _children(children), _inStep(inStep), _endOfStream(endOfStream),
+    _profiler(profiler), _allocations(allocations),
+    _pending(algos.size(), 0), _tainted(algos.size(), 0), _status(algos.size(), OK) {
+
+    for (int i=0; i<(int)_algos.size(); i++) {
+      if (!_inStep[i]) continue;
+      for (int j=0; j<(int)_children[i].size(); j++) _pending[_children[i][j]]++;
+    }
+  }
+
+  // algorithms which can be run straight away
+  vector<int> roots() const {
+    vector<int> result;
+    for (int i=(int)_algos.size()-1; i>=0; i--) {
+      if (_inStep[i] && _pending[i] == 0) result.push_back(i);
+    }
+    return result;
+  }
+
+  void run(int idx) {
+    Algorithm* algo = _algos[idx];
+    algo->shouldStop(_endOfStream && !_tainted[idx]);
+
+    // each algorithm is run by a single thread, so that the per-thread
+    // allocation count tells what it allocated
+    sint64 before = AllocationGuard::allocations();
+
+    AlgorithmStatus status;
+    do {
+      if (_profiler) status = _profiler->process(idx);
+      else status = algo->process();
+
+#if DEBUGGING_ENABLED
+      if (status == OK || status == FINISHED) algo->nProcess++;
+#endif
+    } while (status == OK);
+
+    if (_allocations) (*_allocations)[idx] += AllocationGuard::allocations() - before;
+    _status[idx] = status;
+  }
+
+  void done(int idx, vector<int>& ready) {
+    bool taint = _tainted[idx] || _status[idx] == NO_OUTPUT;
+    const vector<int>& children = _children[idx];
+    for (int i=0; i<(int)children.size(); i++) {
+      int c = children[i];
+      if (taint) _tainted[c] = 1;
+      if (--_pending[c] == 0) ready.push_back(c);
+    }
+  }
+
+  // algorithms which need to be run again in a new pass, along with
+  // all the algorithms that depend on them
+  bool nextStep(vector<char>& inStep) const {
+    bool rescheduled = false;
+    inStep.assign(_algos.size(), 0);
+    for (int i=0; i<(int)_algos.size(); i++) {
+      if (_inStep[i] && _status[i] == NO_OUTPUT) {
+        E_DEBUG(EScheduler, "Rescheduling algorithm " << _algos[i]->name() <<
+                " to run later, output buffers temporarily full");
+        inStep[i] = 1;
+        rescheduled = true;
+      }
+      if (inStep[i]) {
+        for (int j=0; j<(int)_children[i].size(); j++) inStep[_children[i][j]] = 1;
+      }
+    }
+    return rescheduled;
+  }
+
+ protected:
+  const vector<Algorithm*>& _algos;
+  const vector<vector<int> >& _children;
+  const vector<char>& _inStep;
+  bool _endOfStream;
+  NetworkProfiler* _profiler;
+  vector<sint64>* _allocations;
+
+  vector<int> _pending;
+  vector<char> _tainted;
+  vector<AlgorithmStatus> _status;
+};
+
+
+void Network::runStepParallel(bool endOfStream, bool countAllocations) {
+  // the first pass runs everything but the generator
+  vector<char> inStep(_toposortedNetwork.size(), 1);
+  inStep[0] = 0;
+
+  while (true) {
+    ParallelStep step(_toposortedNetwork, _toposortedChildren, inStep, endOfStream, _profiler,
+                      countAllocations ? &_allocations : 0);
+    _threadPool->run(step, step.roots());
+
+    if (!step.nextStep(inStep)) break;
+  }
+}
+
+
 Algorithm* Network::findAlgorithm(const std::string& name) {
   NodeVector nodes = depthFirstSearch(_visibleNetworkRoot);
   for (NodeVector::iterator node = nodes.begin(); node != nodes.end(); ++node) {
@@ -367,6 +607,12 @@ void Network::deleteAlgorithms() {
     delete (*node)->algorithm();
   }
 
+  for (int i=0; i<(int)_mergedAlgorithms.size(); i++) {
+    E_DEBUG(ENetwork, "deleting merged " << _mergedAlgorithms[i]->name());
+    delete _mergedAlgorithms[i];
+  }
+  _mergedAlgorithms.clear();
+
   // we need to set this to false anyway, because it doesn't make sense anymore
   // to have it to true and it would cause the destructor to crash
   _takeOwnership = false;
@@ -785,10 +1031,149 @@ FractalNode* expandNode(FractalNode* node) {
 }
 
 
+/**
+ * Returns whether the outputs of the given algorithm are not a pure function
+ * of its inputs and parameters, because it draws random numbers. Two such
+ * algorithms compute different things even when they are configured and
+ * connected in the same way.
+ */
+bool isNonDeterministic(Algorithm* algo) {
+  const string& name = algo->name();
+
+  // this one can use a fixed seed (FrameCutter always does when adding noise
+  // to silent frames)
+  if (name == "NoiseAdder") return !algo->parameter("fixSeed").toBool();
+
+  static const char* random[3] = { "AudioOnsetsMarker", "StochasticModelSynth", "TempoTapDegara" };
+  for (int i=0; i<(int)ARRAY_SIZE(random); i++) {
+    if (name == random[i]) return true;
+  }
+  return false;
+}
+
+/**
+ * Returns whether the given algorithm can be merged with an identical one, ie:
+ * it is a simple, deterministic algorithm, fully connected to other visible
+ * algorithms and which has some outputs (storage algorithms should never be
+ * merged).
+ */
+bool isMergeable(Algorithm* algo) {
+  if (dynamic_cast<AlgorithmComposite*>(algo)) return false;
+  if (isNonDeterministic(algo)) return false;
+  if (algo->inputs().empty() || algo->outputs().empty()) return false;
+
+  for (int i=0; i<(int)algo->inputs().size(); i++) {
+    if (!algo->input(i).source()) return false;
+  }
+  for (int i=0; i<(int)algo->outputs().size(); i++) {
+    if (algo->output(i).isProxied()) return false;
+  }
+  return true;
+}
+
+bool identicalAlgorithms(Algorithm* algo1, Algorithm* algo2) {
+  if (algo1->name() != algo2->name()) return false;
+  if (algo1->inputs().size() != algo2->inputs().size() ||
+      algo1->outputs().size() != algo2->outputs().size()) return false;
+
+  for (int i=0; i<(int)algo1->inputs().size(); i++) {
+    if (algo1->input(i).source() != algo2->input(i).source()) return false;
+  }
+
+  const ParameterMap& params = algo1->defaultParameters();
+  for (ParameterMap::const_iterator it = params.begin(); it != params.end(); ++it) {
+    if (algo1->parameter(it->first) != algo2->parameter(it->first)) return false;
+  }
+
+  return true;
+}
+
+/**
+ * Disconnects the duplicate algorithm from its sources, and moves all of the
+ * sinks it was feeding to the corresponding outputs of the given algorithm.
+ */
+void mergeAlgorithm(Algorithm* duplicate, Algorithm* algo) {
+  E_DEBUG(ENetwork, "merging " << duplicate->name() << " (" << duplicate << ") into " << algo->name() << " (" << algo << ")");
+
+  for (int i=0; i<(int)duplicate->inputs().size(); i++) {
+    SinkBase& sink = duplicate->input(i);
+    disconnect(*sink.source(), sink);
+  }
+
+  for (int i=0; i<(int)duplicate->outputs().size(); i++) {
+    SourceBase& source = duplicate->output(i);
+    vector<SinkBase*> sinks = source.sinks();
+    for (int j=0; j<(int)sinks.size(); j++) {
+      disconnect(source, *sinks[j]);
+      connect(algo->output(i), *sinks[j]);
+    }
+  }
+}
+
+void Network::mergeIdenticalVisibleAlgorithms() {
+  // visit the algorithms in topological order (ref-counted DFS, as in
+  // topologicalSortExecutionNetwork()), so that when we get to an algorithm,
+  // all of its parents have already been merged and its inputs are connected
+  // to the algorithms which are kept. Merging two algorithms can then make
+  // their children identical as well, and all of them get merged in one pass.
+  NodeVector nodes = depthFirstSearch(_visibleNetworkRoot);
+  map<NetworkNode*, int> refs;
+  for (int i=0; i<(int)nodes.size(); i++) {
+    const NodeVector& children = nodes[i]->children();
+    for (int j=0; j<(int)children.size(); j++) refs[children[j]] += 1;
+  }
+
+  // the algorithms kept so far, indexed by type and sources (identical
+  // algorithms also need to have the same parameters)
+  typedef pair<string, vector<SourceBase*> > MergeKey;
+  map<MergeKey, vector<Algorithm*> > kept;
+  bool merged = false;
+
+  NodeStack toVisit;
+  toVisit.push(_visibleNetworkRoot);
+  refs[_visibleNetworkRoot] = 1;
+
+  while (!toVisit.empty()) {
+    NetworkNode* node = toVisit.top();
+    toVisit.pop();
+    if (--refs[node] != 0) continue;
+
+    const NodeVector& children = node->children();
+    for (int i=0; i<(int)children.size(); i++) toVisit.push(children[i]);
+
+    Algorithm* algo = node->algorithm();
+    if (algo == _generator || !isMergeable(algo)) continue;
+
+    MergeKey key(algo->name(), vector<SourceBase*>(algo->inputs().size()));
+    for (int i=0; i<(int)algo->inputs().size(); i++) key.second[i] = algo->input(i).source();
+
+    vector<Algorithm*>& candidates = kept[key];
+    int j = 0;
+    while (j < (int)candidates.size() && !identicalAlgorithms(candidates[j], algo)) j++;
+
+    if (j < (int)candidates.size()) {
+      mergeAlgorithm(algo, candidates[j]);
+      _mergedAlgorithms.push_back(algo);
+      merged = true;
+    }
+    else {
+      candidates.push_back(algo);
+    }
+  }
+
+  if (merged) buildVisibleNetwork();
+}
+
+
 void Network::buildExecutionNetwork() {
   E_DEBUG(ENetwork, "building execution network");
   clearExecutionNetwork();
 
+  if (_mergeIdentical) {
+    E_DEBUG(ENetwork, "  0- merge identical algorithms");
+    mergeIdenticalVisibleAlgorithms();
+  }
+
   // 1- First build the visible network
   E_DEBUG(ENetwork, "  1- build visible network");
   E_DEBUG_INDENT;
@@ -879,6 +1264,10 @@ void Network::topologicalSortExecutionNetwork() {
   // 2- do DFS again, manually this time and only visit node which have no refs anymore
   _toposortedNetwork.clear();
 
+  _toposortedChildren.clear();
+  map<NetworkNode*, int> nodeIndex;
+  vector<NetworkNode*> toposortedNodes;
+
   NodeStack toVisit;
   toVisit.push(_executionNetworkRoot);
   refs[_executionNetworkRoot] = 1;
@@ -889,6 +1278,8 @@ void Network::topologicalSortExecutionNetwork() {
 
     if (--refs[currentNode] == 0) {
       _toposortedNetwork.push_back(currentNode->algorithm()); // keep this node, it is good
+      nodeIndex[currentNode] = (int)toposortedNodes.size();
+      toposortedNodes.push_back(currentNode);
 
       const NodeVector& children = currentNode->children();
       for (int i=0; i<(int)children.size(); i++) {
@@ -897,6 +1288,26 @@ void Network::topologicalSortExecutionNetwork() {
     }
   }
 
+  // 3- keep the dependencies between the sorted algorithms for the parallel scheduler
+  _toposortedChildren.resize(toposortedNodes.size());
+  map<Algorithm*, int> lastOccurrence;
+
+  for (int i=0; i<(int)toposortedNodes.size(); i++) {
+    const NodeVector& children = toposortedNodes[i]->children();
+    for (int j=0; j<(int)children.size(); j++) {
+      _toposortedChildren[i].push_back(nodeIndex[children[j]]);
+    }
+
+    // an algorithm might appear more than once in the execution network, make
+    // sure it is never run concurrently with itself
+    Algorithm* algo = toposortedNodes[i]->algorithm();
+    if (contains(lastOccurrence, algo)) {
+      vector<int>& prevChildren = _toposortedChildren[lastOccurrence[algo]];
+      if (!contains(prevChildren, i)) prevChildren.push_back(i);
+    }
+    lastOccurrence[algo] = i;
+  }
+
   E_DEBUG(ENetwork, "-------------------------------------------------------------------------------------------");
   for (int i=0; i<(int)_toposortedNetwork.size(); i++) {
     E_DEBUG_NONL(ENetwork, " → " << _toposortedNetwork[i]->name());
@@ -1044,5 +1455,125 @@ void Network::checkBufferSizes() {
 }
 
 
+
+/**
+ * Returns the smallest buffer with which the given source and its sinks can
+ * always make progress with their current acquire sizes: the writer always
+ * has room to write while a reader holds as many tokens as it requests (some
+ * readers, e.g. FrameCutter, wait for one more token than they acquire), and
+ * the phantom zone is large enough for them to see that many tokens.
+ */
+BufferInfo minimalBufferInfo(SourceBase* source) {
+  int maxRead = 0;
+  for (int i=0; i<(int)source->sinks().size(); i++) {
+    maxRead = max(maxRead, source->sinks()[i]->acquireSize());
+  }
+  int write = source->acquireSize();
+
+  int contiguous = max(write, maxRead);
+  return BufferInfo(max(contiguous + 1, maxRead + write), contiguous);
+}
+
+/**
+ * Returns the larger of the two buffers.
+ */
+BufferInfo maxBufferInfo(const BufferInfo& info1, const BufferInfo& info2) {
+  return BufferInfo(max(info1.size, info2.size),
+                    max(info1.maxContiguousElements, info2.maxContiguousElements));
+}
+
+void Network::fitBufferSizes() {
+  _bufferSizes.clear();
+
+  for (int i=0; i<(int)_toposortedNetwork.size(); i++) {
+    Algorithm* algo = _toposortedNetwork[i];
+
+    for (Algorithm::OutputMap::const_iterator output = algo->outputs().begin();
+         output != algo->outputs().end();
+         ++output) {
+
+      SourceBase* source = output->second;
+
+      // keep the buffer large enough for the declared acquire sizes, so that
+      // checkBufferSizes() doesn't need to grow it again
+      BufferInfo info = maxBufferInfo(source->requiredBufferInfo(), minimalBufferInfo(source));
+
+      BufferSize size;
+      size.algorithm = i;
+      size.algorithmName = algo->name();
+      size.output = output->first;
+      size.info = info;
+      _bufferSizes.push_back(size);
+
+      E_DEBUG(ENetwork, "fitted buffer of " << source->fullName() << ": "
+              << source->bufferInfo().size << "/" << source->bufferInfo().maxContiguousElements
+              << " -> " << info.size << "/" << info.maxContiguousElements);
+    }
+  }
+}
+
+void Network::applyBufferSizes() {
+  for (int i=0; i<(int)_bufferSizes.size(); i++) {
+    const BufferSize& size = _bufferSizes[i];
+
+    if (size.algorithm < 0 || size.algorithm >= (int)_toposortedNetwork.size() ||
+        _toposortedNetwork[size.algorithm]->name() != size.algorithmName ||
+        !contains(_toposortedNetwork[size.algorithm]->outputs(), size.output)) {
+      E_WARNING("Network: not resizing the buffer of " << size.algorithmName << "::" << size.output
+                << " as it is not in the network anymore");
+      continue;
+    }
+
+    // the acquire sizes may have changed since the sizes have been fitted
+    // (e.g. after a reconfigure, or if they have been fitted by another
+    // instance): never go below what they need now
+    SourceBase& source = _toposortedNetwork[size.algorithm]->output(size.output);
+    source.setBufferInfo(maxBufferInfo(size.info, minimalBufferInfo(&source)));
+  }
+}
+
+void Network::saveBufferSizes(const string& filename) const {
+  ofstream out(filename.c_str());
+  if (!out.is_open()) {
+    throw EssentiaException("Network: could not open file for writing: ", filename);
+  }
+
+  out << "# algorithm index, algorithm name, output name, buffer size, phantom size\n";
+  for (int i=0; i<(int)_bufferSizes.size(); i++) {
+    const BufferSize& size = _bufferSizes[i];
+    out << size.algorithm << " " << size.algorithmName << " " << size.output << " "
+        << size.info.size << " " << size.info.maxContiguousElements << "\n";
+  }
+
+  if (!out.good()) {
+    throw EssentiaException("Network: error while writing buffer sizes to ", filename);
+  }
+}
+
+void Network::loadBufferSizes(const string& filename) {
+  ifstream in(filename.c_str());
+  if (!in.is_open()) {
+    throw EssentiaException("Network: could not open file: ", filename);
+  }
+
+  vector<BufferSize> sizes;
+  string line;
+  while (getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+
+    istringstream fields(line);
+    BufferSize size;
+    if (!(fields >> size.algorithm >> size.algorithmName >> size.output
+                 >> size.info.size >> size.info.maxContiguousElements) ||
+        size.info.maxContiguousElements < 0 || size.info.size <= size.info.maxContiguousElements) {
+      throw EssentiaException("Network: invalid buffer size in ", filename, ": ", line);
+    }
+    sizes.push_back(size);
+  }
+
+  _bufferSizes = sizes;
+}
+
+
 } // namespace scheduler
 } // namespace essentia
@@ -41,6 +41,9 @@ class SourceBase;
 namespace essentia {
 namespace scheduler {
 
+class ThreadPool;
+class NetworkProfiler;
+
 typedef std::vector<streaming::Algorithm*> AlgoVector;
 typedef std::set<streaming::Algorithm*> AlgoSet;
 
@@ -131,6 +134,154 @@ class Network {
    */
   bool runStep();
 
+  /**
+   * Sets the number of threads used to run the network. With a single thread
+   * (the default), all algorithms are run one after the other following the
+   * linear execution order. With more threads, independent branches of the
+   * execution network are run concurrently, an algorithm being run as soon as
+   * all its parents in the execution network have been run. The data that
+   * flows through each connection is the same in both cases, so the results
+   * are identical to the ones obtained with a single thread.
+   */
+  void setNumberOfThreads(int nThreads);
+
+  int numberOfThreads() const { return _nThreads; }
+
+  /**
+   * Sets whether algorithms which compute exactly the same thing should be
+   * merged when building the execution network. Two algorithms are considered
+   * identical if they are of the same (non-composite) type, have the same
+   * parameters and have all their inputs connected to the same sources. The
+   * duplicate is then disconnected and all the inputs that were connected to
+   * it are connected to the algorithm it has been merged with instead.
+   *
+   * Algorithms which draw random numbers (e.g. NoiseAdder without a fixed
+   * seed) are never merged. Other algorithms are assumed to be deterministic,
+   * so an algorithm whose outputs are not a pure function of its inputs and
+   * parameters needs to be added to the list in isNonDeterministic()
+   * (network.cpp).
+   *
+   * This is disabled by default, as merging modifies the graph set up by the
+   * user, permanently: the duplicates are disconnected from their sources and
+   * their sinks, which stay connected to the algorithms they have been merged
+   * with, also once the network has run or has been deleted. The duplicates
+   * are deleted with the network if it has ownership of its algorithms.
+   */
+  void setMergeIdenticalAlgorithms(bool merge) { _mergeIdentical = merge; }
+
+  bool mergeIdenticalAlgorithms() const { return _mergeIdentical; }
+
+  /**
+   * Sets whether the calls to process() of each algorithm are measured (see
+   * NetworkProfiler). A new profiler is created each time the network is
+   * prepared to run, so this needs to be set before calling run() or
+   * runPrepare(). If @e trace is true, every single call is recorded too, so
+   * that the run can be exported as a Chrome trace; this takes memory
+   * proportional to the number of calls.
+   *
+   * Profiling is disabled by default, and costs four clock reads per call to
+   * process() when enabled.
+   */
+  void setProfiling(bool enabled, bool trace = false);
+
+  bool profiling() const { return _profiling; }
+
+  /**
+   * Returns the profiler of the current (or last) run, 0 if profiling is
+   * disabled or if the network has not been prepared to run yet.
+   */
+  NetworkProfiler* profiler() { return _profiler; }
+
+  /**
+   * Sets whether the network is run in real-time mode, where no memory should
+   * be allocated by runStep() once the network has been warmed up: all the
+   * buffers are sized in runPrepare(), and the algorithms are expected to
+   * allocate their working memory when configured or during the first
+   * @e warmUpSteps calls to runStep() in which the generator produced data
+   * (polling a generator which has nothing yet doesn't count). The tokens of
+   * the buffers between algorithms keep their memory once they have been
+   * written to, so the warm-up should be long enough for each buffer to have
+   * been filled once with frames as large as the ones to come.
+   *
+   * If the application counts allocations (see AllocationGuard), the ones
+   * made after the warm-up are counted for each algorithm and for the
+   * scheduler itself, and a warning is logged the first time each algorithm
+   * allocates. This is only guaranteed for the single-threaded scheduler,
+   * without profiling traces.
+   */
+  void setRealTime(bool realTime, int warmUpSteps = 64);
+
+  bool realTime() const { return _realTime; }
+
+  /**
+   * For each algorithm in linearExecutionOrder(), the number of allocations
+   * made by its process() method after the warm-up, since the network has
+   * last been prepared to run. Only counted in real-time mode.
+   */
+  const std::vector<sint64>& realTimeAllocations() const { return _allocations; }
+
+  /**
+   * Number of allocations made by the scheduler itself after the warm-up,
+   * outside of the calls to process() of the algorithms.
+   */
+  sint64 schedulerAllocations() const { return _schedulerAllocations; }
+
+  /**
+   * The size of the buffer of one output in the execution network. The
+   * output is identified by the index of its algorithm in the linear
+   * execution order, the name of the algorithm being kept to check that the
+   * network is still the same.
+   */
+  class BufferSize {
+   public:
+    int algorithm;
+    std::string algorithmName;
+    std::string output;
+    streaming::BufferInfo info;
+  };
+
+  /**
+   * Computes, for each output of the execution network, the smallest buffer
+   * with which the last run would have gone exactly the same way, i.e.
+   * without any algorithm having to be rescheduled because its output buffer
+   * was full (NO_OUTPUT). The buffers are resized to these sizes each time
+   * the network is prepared to run from then on, so the network should be
+   * reset before being run again. If another input needs larger buffers, the
+   * algorithms are simply rescheduled as before.
+   *
+   * The buffers are never made smaller than what the current acquire sizes
+   * of their source and sinks need to always make progress, i.e. a phantom
+   * zone of the largest request, and at least maxRead + maxWrite tokens.
+   */
+  void fitBufferSizes();
+
+  /**
+   * Sets whether fitBufferSizes() is called at the end of each run(), so that
+   * the first run serves as a warm-up phase for the following ones.
+   */
+  void setAdaptiveBufferSizes(bool adaptive) { _adaptiveBuffers = adaptive; }
+
+  bool adaptiveBufferSizes() const { return _adaptiveBuffers; }
+
+  const std::vector<BufferSize>& bufferSizes() const { return _bufferSizes; }
+
+  /**
+   * Sets the buffer sizes to use from the next run on; an empty list goes
+   * back to the sizes chosen by the algorithms themselves.
+   */
+  void setBufferSizes(const std::vector<BufferSize>& sizes) { _bufferSizes = sizes; }
+
+  /**
+   * Saves the buffer sizes to a text file, with one line per output.
+   */
+  void saveBufferSizes(const std::string& filename) const;
+
+  /**
+   * Loads the buffer sizes saved by saveBufferSizes(), possibly from
+   * another instance of the same network.
+   */
+  void loadBufferSizes(const std::string& filename);
+
   /**
    * Rebuilds the visible and execution network.
    */
@@ -209,6 +360,77 @@ class Network {
   NetworkNode* _executionNetworkRoot;
   std::vector<streaming::Algorithm*> _toposortedNetwork;
 
+  /**
+   * For each algorithm in @c _toposortedNetwork, the indices of the algorithms
+   * that depend on it. This is the execution network as used by the parallel
+   * scheduler.
+   */
+  std::vector<std::vector<int> > _toposortedChildren;
+
+  int _nThreads;
+  ThreadPool* _threadPool;
+
+  bool _mergeIdentical;
+
+  bool _profiling;
+  bool _trace;
+  NetworkProfiler* _profiler;
+
+  bool _realTime;
+  int _warmUpSteps;
+  int _steps;
+  std::vector<sint64> _allocations;
+  std::vector<char> _allocationReported;
+  sint64 _schedulerAllocations;
+
+  /**
+   * Algorithms still to be run in the current step, after having been
+   * rescheduled; kept here so that runStep() does not allocate it each time.
+   */
+  std::vector<int> _runStack;
+
+  /**
+   * Whether the allocations are counted in the current step.
+   */
+  bool countingAllocations() const;
+
+  /**
+   * Logs the algorithms that allocated memory for the first time after the
+   * warm-up.
+   */
+  void reportAllocations();
+
+  bool _adaptiveBuffers;
+  std::vector<BufferSize> _bufferSizes;
+
+  /**
+   * Resizes the buffers to the sizes in @c _bufferSizes, or to the sizes
+   * needed by the current acquire sizes if they are larger.
+   */
+  void applyBufferSizes();
+
+  /**
+   * Algorithms which have been taken out of the network because they were
+   * identical to another one. They still belong to the network if it has
+   * ownership of its algorithms.
+   */
+  std::vector<streaming::Algorithm*> _mergedAlgorithms;
+
+  /**
+   * Merges all the algorithms of the visible network which are identical, in
+   * a single pass over the network, and rebuilds the visible network if any
+   * of them has been merged. This rewires the connections of the algorithms.
+   */
+  void mergeIdenticalVisibleAlgorithms();
+
+  /**
+   * Runs all the algorithms (except the generator) as many times as needed for
+   * them to consume everything on their inputs, using the thread pool.
+   * The allocations made by each algorithm are counted if
+   * @e countAllocations is true.
+   */
+  void runStepParallel(bool endOfStream, bool countAllocations);
+
   /**
    * Build the network of visibly connected algorithms (ie: do not enter composite
    * algorithms) and stores its root in @c _visibleNetworkRoot.
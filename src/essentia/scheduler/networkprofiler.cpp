@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include "networkprofiler.h"
+#include "../threading.h"
+
+#ifndef OS_WIN32
+#  include <time.h>
+#endif // OS_WIN32
+
+using namespace std;
+using namespace essentia::streaming;
+
+namespace essentia {
+namespace scheduler {
+
+// the number of tokens which have gone through the ports of an algorithm so far
+static void tokenCounts(Algorithm* algo, sint64& consumed, sint64& produced) {
+  consumed = produced = 0;
+  for (int i=0; i<(int)algo->inputs().size(); i++) {
+    // ports of composites which are not attached have no buffer
+    try { consumed += algo->input(i).totalConsumed(); }
+    catch (EssentiaException&) {}
+  }
+  for (int i=0; i<(int)algo->outputs().size(); i++) {
+    try { produced += algo->output(i).totalProduced(); }
+    catch (EssentiaException&) {}
+  }
+}
+
+
+NetworkProfiler::NetworkProfiler(const vector<Algorithm*>& algos, bool trace) :
+  _algos(algos), _profiles(algos.size()), _trace(trace),
+  _events(trace ? algos.size() : 0),
+  _consumedBefore(algos.size()), _producedBefore(algos.size()) {
+
+  for (int i=0; i<(int)_algos.size(); i++) {
+    _profiles[i].name = _algos[i]->name();
+    tokenCounts(_algos[i], _consumedBefore[i], _producedBefore[i]);
+  }
+  _start = wallClock();
+}
+
+AlgorithmStatus NetworkProfiler::process(int idx) {
+  sint64 wallBefore = wallClock();
+  sint64 cpuBefore = cpuClock();
+
+  AlgorithmStatus status = _algos[idx]->process();
+
+  sint64 cpuAfter = cpuClock();
+  sint64 wallAfter = wallClock();
+
+  AlgorithmProfile& profile = _profiles[idx];
+  profile.calls++;
+  if (status == NO_INPUT) profile.noInput++;
+  else if (status == NO_OUTPUT) profile.noOutput++;
+  profile.wallTime += (wallAfter - wallBefore) * 1e-9;
+  profile.cpuTime += (cpuAfter - cpuBefore) * 1e-9;
+
+  if (_trace) {
+    TraceEvent event;
+    event.start = wallBefore - _start;
+    event.duration = wallAfter - wallBefore;
+    event.thread = threadId();
+    _events[idx].push_back(event);
+  }
+
+  return status;
+}
+
+void NetworkProfiler::updateTokenCounts() {
+  for (int i=0; i<(int)_algos.size(); i++) {
+    sint64 consumed, produced;
+    tokenCounts(_algos[i], consumed, produced);
+    _profiles[i].consumed = consumed - _consumedBefore[i];
+    _profiles[i].produced = produced - _producedBefore[i];
+  }
+}
+
+
+void NetworkProfiler::detachAlgorithms() {
+  _algos.clear();
+}
+
+
+static bool slowerThan(const AlgorithmProfile* p1, const AlgorithmProfile* p2) {
+  return p1->wallTime > p2->wallTime;
+}
+
+void NetworkProfiler::printReport(ostream& out) const {
+  vector<const AlgorithmProfile*> sorted(_profiles.size());
+  double totalTime = 0;
+  for (int i=0; i<(int)_profiles.size(); i++) {
+    sorted[i] = &_profiles[i];
+    totalTime += _profiles[i].wallTime;
+  }
+  stable_sort(sorted.begin(), sorted.end(), slowerThan);
+
+  out << left << setw(30) << "algorithm" << right
+      << setw(10) << "calls" << setw(10) << "noInput" << setw(10) << "noOutput"
+      << setw(12) << "wall (ms)" << setw(8) << "%" << setw(12) << "cpu (ms)"
+      << setw(12) << "consumed" << setw(12) << "produced" << "\n";
+
+  for (int i=0; i<(int)sorted.size(); i++) {
+    const AlgorithmProfile& p = *sorted[i];
+    out << left << setw(30) << p.name << right
+        << setw(10) << p.calls << setw(10) << p.noInput << setw(10) << p.noOutput
+        << fixed << setprecision(3) << setw(12) << p.wallTime * 1000
+        << setprecision(1) << setw(8) << (totalTime > 0 ? 100 * p.wallTime / totalTime : 0)
+        << setprecision(3) << setw(12) << p.cpuTime * 1000
+        << setw(12) << p.consumed << setw(12) << p.produced << "\n";
+  }
+  out.unsetf(ios::floatfield);
+}
+
+
+static string jsonEscape(const string& str) {
+  string result;
+  for (int i=0; i<(int)str.size(); i++) {
+    char c = str[i];
+    if (c == '"' || c == '\\') result += '\\';
+    if ((unsigned char)c < 0x20) result += ' ';
+    else result += c;
+  }
+  return result;
+}
+
+void NetworkProfiler::writeChromeTrace(const string& filename) const {
+  if (!_trace) {
+    throw EssentiaException("NetworkProfiler: cannot write a trace to ", filename,
+                            " because tracing was not enabled");
+  }
+
+  ofstream out(filename.c_str());
+  if (!out.is_open()) {
+    throw EssentiaException("NetworkProfiler: could not open file for writing: ", filename);
+  }
+
+  // threads are numbered in the order they appear, to get readable track names
+  map<uint64, int> threads;
+  for (int i=0; i<(int)_events.size(); i++) {
+    for (int j=0; j<(int)_events[i].size(); j++) {
+      if (threads.find(_events[i][j].thread) == threads.end()) {
+        int n = threads.size();
+        threads[_events[i][j].thread] = n;
+      }
+    }
+  }
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  for (map<uint64, int>::const_iterator it = threads.begin(); it != threads.end(); ++it) {
+    if (!first) out << ",\n";
+    first = false;
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << it->second
+        << ",\"args\":{\"name\":\"thread " << it->second << "\"}}";
+  }
+
+  // timestamps and durations are in microseconds
+  out << fixed << setprecision(3);
+  for (int i=0; i<(int)_events.size(); i++) {
+    string name = jsonEscape(_profiles[i].name);
+    for (int j=0; j<(int)_events[i].size(); j++) {
+      const TraceEvent& event = _events[i][j];
+      if (!first) out << ",\n";
+      first = false;
+      out << "{\"name\":\"" << name << "\",\"cat\":\"process\",\"ph\":\"X\",\"pid\":0"
+          << ",\"tid\":" << threads[event.thread]
+          << ",\"ts\":" << event.start * 1e-3 << ",\"dur\":" << event.duration * 1e-3 << "}";
+    }
+  }
+  out << "\n]}\n";
+
+  if (!out.good()) {
+    throw EssentiaException("NetworkProfiler: error while writing trace to ", filename);
+  }
+}
+
+
+#ifndef OS_WIN32
+
+sint64 NetworkProfiler::wallClock() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return sint64(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+sint64 NetworkProfiler::cpuClock() {
+  timespec t;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  return sint64(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+uint64 NetworkProfiler::threadId() {
+  return uint64(pthread_self());
+}
+
+#else // OS_WIN32
+
+sint64 NetworkProfiler::wallClock() {
+  LARGE_INTEGER counter, frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return sint64(double(counter.QuadPart) * 1e9 / frequency.QuadPart);
+}
+
+sint64 NetworkProfiler::cpuClock() {
+  FILETIME creation, exit, kernel, user;
+  GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+  // in units of 100ns
+  sint64 k = (sint64(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+  sint64 u = (sint64(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+  return (k + u) * 100;
+}
+
+uint64 NetworkProfiler::threadId() {
+  return GetCurrentThreadId();
+}
+
+#endif // OS_WIN32
+
+} // namespace scheduler
+} // namespace essentia
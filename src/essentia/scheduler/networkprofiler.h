@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_SCHEDULER_NETWORKPROFILER_H
+#define ESSENTIA_SCHEDULER_NETWORKPROFILER_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "../streaming/streamingalgorithm.h"
+
+namespace essentia {
+namespace scheduler {
+
+/**
+ * What has been measured for one algorithm of the execution network.
+ * Times are in seconds, the CPU time being the one of the thread which
+ * called process().
+ */
+class AlgorithmProfile {
+ public:
+  std::string name;
+  sint64 calls;       // number of calls to process()
+  sint64 noInput;     // calls which returned NO_INPUT
+  sint64 noOutput;    // calls which returned NO_OUTPUT, i.e. reschedules
+  double wallTime;
+  double cpuTime;
+  sint64 consumed;    // tokens released on all the inputs
+  sint64 produced;    // tokens produced on all the outputs
+
+  AlgorithmProfile() : calls(0), noInput(0), noOutput(0), wallTime(0), cpuTime(0),
+                       consumed(0), produced(0) {}
+};
+
+
+/**
+ * Collects per-algorithm statistics while a Network runs: calls to
+ * process(), their outcome, the wall-clock and CPU time spent in them and
+ * the number of tokens consumed and produced. If tracing is enabled, each
+ * call to process() is also recorded, so that the run can be exported as a
+ * Chrome trace (to be opened in chrome://tracing or Perfetto).
+ *
+ * The profiler is created by the Network (see Network::setProfiling()), the
+ * algorithms are identified by their index in the linear execution order.
+ * Calls for different algorithms can be recorded concurrently, but not calls
+ * for the same algorithm, which is what the schedulers guarantee.
+ */
+class NetworkProfiler {
+
+ public:
+  NetworkProfiler(const std::vector<streaming::Algorithm*>& algos, bool trace);
+
+  /**
+   * Calls process() on the given algorithm and records it.
+   */
+  streaming::AlgorithmStatus process(int idx);
+
+  /**
+   * Updates the number of tokens consumed and produced by each algorithm.
+   * This is done by the Network at the end of a run and before deleting its
+   * algorithms, it only needs to be called when stopping a run earlier.
+   */
+  void updateTokenCounts();
+
+  /**
+   * Forgets about the algorithms, when they are about to be deleted. The
+   * profiles are kept, but nothing can be recorded anymore.
+   */
+  void detachAlgorithms();
+
+  bool tracing() const { return _trace; }
+
+  const std::vector<AlgorithmProfile>& profiles() const { return _profiles; }
+
+  /**
+   * Prints a table with one line per algorithm, sorted by decreasing wall
+   * time.
+   */
+  void printReport(std::ostream& out) const;
+
+  /**
+   * Writes all the calls to process() in the Chrome trace event format.
+   * Throws an EssentiaException if tracing was not enabled.
+   */
+  void writeChromeTrace(const std::string& filename) const;
+
+ protected:
+  class TraceEvent {
+   public:
+    sint64 start;     // in ns since the creation of the profiler
+    sint64 duration;  // in ns
+    uint64 thread;
+  };
+
+  std::vector<streaming::Algorithm*> _algos;
+  std::vector<AlgorithmProfile> _profiles;
+  bool _trace;
+  std::vector<std::vector<TraceEvent> > _events;
+
+  // token counts of each algorithm when the profiler was created
+  std::vector<sint64> _consumedBefore;
+  std::vector<sint64> _producedBefore;
+
+  sint64 _start;
+
+  static sint64 wallClock();
+  static sint64 cpuClock();
+  static uint64 threadId();
+};
+
+} // namespace scheduler
+} // namespace essentia
+
+#endif // ESSENTIA_SCHEDULER_NETWORKPROFILER_H
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "threadpool.h"
+
+#ifndef OS_WIN32
+#  include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace essentia {
+namespace scheduler {
+
+
+ThreadPool::ThreadPool(int nThreads) : _tasks(0), _running(0), _stop(false) {
+  if (nThreads < 1) {
+    throw EssentiaException("ThreadPool: number of threads should be at least 1, got ", nThreads);
+  }
+
+#ifndef OS_WIN32
+  pthread_mutex_init(&_mutex, 0);
+  pthread_cond_init(&_cond, 0);
+
+  for (int i=1; i<nThreads; i++) {
+    pthread_t* thread = new pthread_t;
+    if (pthread_create(thread, 0, &ThreadPool::workerMain, this) != 0) {
+      delete thread;
+      E_WARNING("ThreadPool: could only start " << i << " threads out of the " << nThreads << " requested");
+      break;
+    }
+    _workers.push_back(thread);
+  }
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+#ifndef OS_WIN32
+  lock();
+  _stop = true;
+  broadcast();
+  unlock();
+
+  for (int i=0; i<(int)_workers.size(); i++) {
+    pthread_t* thread = (pthread_t*)_workers[i];
+    pthread_join(*thread, 0);
+    delete thread;
+  }
+
+  pthread_cond_destroy(&_cond);
+  pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+
+#ifndef OS_WIN32
+
+void ThreadPool::lock()      { pthread_mutex_lock(&_mutex); }
+void ThreadPool::unlock()    { pthread_mutex_unlock(&_mutex); }
+void ThreadPool::wait()      { pthread_cond_wait(&_cond, &_mutex); }
+void ThreadPool::broadcast() { pthread_cond_broadcast(&_cond); }
+
+#else // OS_WIN32
+
+// no worker threads, everything happens in the calling thread
+void ThreadPool::lock()      {}
+void ThreadPool::unlock()    {}
+void ThreadPool::wait()      {}
+void ThreadPool::broadcast() {}
+
+#endif // OS_WIN32
+
+
+int ThreadPool::hardwareConcurrency() {
+#ifndef OS_WIN32
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n > 0) return (int)n;
+#endif
+  return 1;
+}
+
+
+void ThreadPool::runNextTask() {
+  int task = _ready.back();
+  _ready.pop_back();
+  TaskList* tasks = _tasks;
+  _running++;
+  unlock();
+
+  string error;
+  try {
+    tasks->run(task);
+  }
+  catch (const std::exception& e) {
+    error = e.what();
+    if (error.empty()) error = "unknown error";
+  }
+  catch (...) {
+    error = "unknown exception";
+  }
+
+  lock();
+  _running--;
+
+  if (!error.empty()) {
+    // do not start any new task, just wait for the running ones to finish
+    if (_error.empty()) _error = error;
+    _ready.clear();
+  }
+  else if (_error.empty()) {
+    tasks->done(task, _ready);
+  }
+
+  // wake up everybody: either there are new tasks ready, or we might be finished
+  broadcast();
+}
+
+
+void ThreadPool::run(TaskList& tasks, const vector<int>& ready) {
+  lock();
+
+  _tasks = &tasks;
+  _ready = ready;
+  _running = 0;
+  _error.clear();
+  broadcast();
+
+  while (!finished()) {
+    if (!_ready.empty()) runNextTask();
+    else wait();
+  }
+
+  _tasks = 0;
+  string error = _error;
+
+  unlock();
+
+  if (!error.empty()) throw EssentiaException(error);
+}
+
+
+void* ThreadPool::workerMain(void* arg) {
+  ThreadPool* pool = (ThreadPool*)arg;
+
+  pool->lock();
+  while (!pool->_stop) {
+    if (pool->_tasks && !pool->_ready.empty()) pool->runNextTask();
+    else pool->wait();
+  }
+  pool->unlock();
+
+  return 0;
+}
+
+
+} // namespace scheduler
+} // namespace essentia
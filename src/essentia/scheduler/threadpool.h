@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_SCHEDULER_THREADPOOL_H
+#define ESSENTIA_SCHEDULER_THREADPOOL_H
+
+#include <vector>
+#include <string>
+#include "../types.h"
+#include "../threading.h"
+
+namespace essentia {
+namespace scheduler {
+
+
+/**
+ * Interface for a set of tasks that can be run by a ThreadPool. Tasks are
+ * identified by their index, and each task is run exactly once.
+ *
+ * Dependencies between tasks are expressed through the done() method: when a
+ * task has been run, done() is called and should append to @c ready the tasks
+ * which have no more unfinished dependencies. This allows to run a graph of
+ * tasks, where independent branches run concurrently.
+ */
+class TaskList {
+ public:
+  virtual ~TaskList() {}
+
+  /**
+   * Run the given task. This is called from one of the threads of the pool,
+   * without holding any lock, so different tasks can be run concurrently.
+   */
+  virtual void run(int task) = 0;
+
+  /**
+   * Called after the given task has been run, with the pool lock held (so
+   * calls to this method are always serialized). Tasks that can now be run
+   * should be appended to @c ready.
+   */
+  virtual void done(int task, std::vector<int>& ready) {}
+};
+
+
+/**
+ * A ThreadPool is a fixed set of worker threads which can run a TaskList.
+ * The thread calling run() also takes part in the computation, so a pool
+ * created for N threads only spawns N-1 workers.
+ *
+ * On platforms without pthreads (ie: windows), all tasks are run sequentially
+ * on the calling thread.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Create a pool which runs tasks on @c nThreads threads in total, the
+   * calling thread included.
+   */
+  ThreadPool(int nThreads);
+  ~ThreadPool();
+
+  int numberOfThreads() const { return (int)_workers.size() + 1; }
+
+  /**
+   * Run all the tasks of the given list, starting with the ones in @c ready,
+   * and return once there are no more tasks to run. If any of the tasks
+   * throws an exception, no new task is started and an EssentiaException
+   * with the same message is thrown once the running ones have finished.
+   */
+  void run(TaskList& tasks, const std::vector<int>& ready);
+
+  /**
+   * Return the number of processors available on this machine, or 1 if it
+   * cannot be determined.
+   */
+  static int hardwareConcurrency();
+
+ protected:
+  std::vector<void*> _workers; // opaque thread handles
+
+  TaskList* _tasks;            // list of tasks currently being run, 0 if idle
+  std::vector<int> _ready;     // tasks that can be started right away
+  int _running;                // number of tasks currently being run
+  std::string _error;          // message of the first exception thrown by a task
+  bool _stop;                  // whether the workers should exit
+
+#ifndef OS_WIN32
+  pthread_mutex_t _mutex;
+  pthread_cond_t _cond;
+#endif
+
+  void lock();
+  void unlock();
+  void wait();
+  void broadcast();
+
+  bool finished() const { return _ready.empty() && _running == 0; }
+
+  // takes the next ready task and runs it, lock should be held when calling
+  // this function and it is held again when it returns
+  void runNextTask();
+
+  static void* workerMain(void* arg);
+
+ private:
+  // not copyable
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+};
+
+
+} // namespace scheduler
+} // namespace essentia
+
+#endif // ESSENTIA_SCHEDULER_THREADPOOL_H
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <cmath>
+#include "aggregatedpoolstorage.h"
+#include "essentiautil.h"
+using namespace std;
+
+namespace essentia {
+namespace streaming {
+
+const vector<string>& onlineAggregationStats() {
+  static const char* statsC[] =
+    { "min", "max", "median", "mean", "var", "stdev", "skew", "kurt",
+      "dmean", "dvar", "dmean2", "dvar2", "cov", "icov" };
+  static const vector<string> stats = arrayToVector<string>(statsC);
+  return stats;
+}
+
+
+AggregatedPoolStorageBase::AggregatedPoolStorageBase(Pool* pool, const string& descriptorName,
+                                                     const vector<string>& stats, bool isVector) :
+  PoolStorageBase(pool, descriptorName), _stats(stats), _isVector(isVector) {
+  reset();
+}
+
+void AggregatedPoolStorageBase::reset() {
+  Algorithm::reset();
+  // the size of the vectors is only known once the first frame has arrived
+  _statistics.clear(_isVector ? 0 : 1);
+  _sizeMismatch = false;
+}
+
+void AggregatedPoolStorageBase::addFrame(const vector<Real>& frame) {
+  if (_sizeMismatch) return;
+
+  if (_statistics.size() == 0) {
+    bool covariance = contains(_stats, string("cov")) || contains(_stats, string("icov"));
+    _statistics.clear(frame.size(), covariance);
+  }
+  else if (int(frame.size()) != _statistics.dimension()) {
+    // as in the PoolAggregator, the descriptor is not aggregated
+    E_WARNING("AggregatedPoolStorage: not aggregating \"" << _descriptorName << "\" because it has frames of different sizes");
+    _sizeMismatch = true;
+    return;
+  }
+
+  _statistics.add(frame);
+}
+
+void AggregatedPoolStorageBase::addFrame(Real value) {
+  _statistics.add(value);
+}
+
+void AggregatedPoolStorageBase::addToPool() {
+  const OnlineStatistics& s = _statistics;
+  if (s.size() == 0 || _sizeMismatch) return;
+
+  if (!_isVector) {
+    for (int i=0; i<(int)_stats.size(); ++i) {
+      const string& stat = _stats[i];
+      Real value;
+      if      (stat == "mean")   value = s.mean()[0];
+      else if (stat == "median") value = s.median()[0];
+      else if (stat == "min")    value = s.min()[0];
+      else if (stat == "max")    value = s.max()[0];
+      else if (stat == "var")    value = s.variance()[0];
+      else if (stat == "stdev")  value = s.stdev()[0];
+      else if (stat == "skew")   value = s.skewness()[0];
+      else if (stat == "kurt")   value = s.kurtosis()[0];
+      else if (stat == "dmean")  value = s.dmean()[0];
+      else if (stat == "dvar")   value = s.dvar()[0];
+      else if (stat == "dmean2") value = s.dmean2()[0];
+      else if (stat == "dvar2")  value = s.dvar2()[0];
+      else continue; // no covariance for single dimensional descriptors
+
+      // skewness and kurtosis of constant values, as in essentiamath
+      if (std::isnan(value) || std::isinf(value)) value = 0;
+      _pool->set(_descriptorName + "." + stat, value);
+    }
+  }
+  else if (s.size() == 1) {
+    // a single vector is not aggregated, as in the PoolAggregator
+    _pool->add(_descriptorName, s.last());
+  }
+  else {
+    for (int i=0; i<(int)_stats.size(); ++i) {
+      const string& stat = _stats[i];
+      string subkey = _descriptorName + "." + stat;
+
+      if (stat == "cov" || stat == "icov") {
+        TNT::Array2D<Real> matrix = stat == "cov" ? s.covariance() : s.inverseCovariance();
+        vector<Real> row(matrix.dim2());
+        for (int r=0; r<matrix.dim1(); ++r) {
+          for (int c=0; c<matrix.dim2(); ++c) row[c] = matrix[r][c];
+          _pool->add(subkey, row);
+        }
+        continue;
+      }
+
+      vector<Real> values;
+      if      (stat == "mean")   values = s.mean();
+      else if (stat == "median") values = s.median();
+      else if (stat == "min")    values = s.min();
+      else if (stat == "max")    values = s.max();
+      else if (stat == "var")    values = s.variance();
+      else if (stat == "stdev")  values = s.stdev();
+      else if (stat == "skew")   values = s.skewness();
+      else if (stat == "kurt")   values = s.kurtosis();
+      else if (stat == "dmean")  values = s.dmean();
+      else if (stat == "dvar")   values = s.dvar();
+      else if (stat == "dmean2") values = s.dmean2();
+      else if (stat == "dvar2")  values = s.dvar2();
+
+      for (int j=0; j<(int)values.size(); ++j) _pool->add(subkey, values[j]);
+    }
+  }
+
+  // so that nothing is added twice if the end of the stream is seen again
+  _statistics.clear(_isVector ? 0 : 1);
+}
+
+
+void connectAggregated(SourceBase& source, Pool& pool, const string& descriptorName,
+                       const vector<string>& stats) {
+  for (int i=0; i<(int)stats.size(); ++i) {
+    if (!contains(onlineAggregationStats(), stats[i])) {
+      throw EssentiaException("connectAggregated: statistic '", stats[i],
+                              "' cannot be computed without storing the frames of ", descriptorName);
+    }
+  }
+
+  const type_info& sourceType = source.typeInfo();
+  Algorithm* ps = 0;
+
+  if (sameType(sourceType, typeid(Real))) {
+    ps = new AggregatedPoolStorage<Real>(&pool, descriptorName, stats, false);
+  }
+  else if (sameType(sourceType, typeid(int))) {
+    ps = new AggregatedPoolStorage<int, Real>(&pool, descriptorName, stats, false);
+  }
+  else if (sameType(sourceType, typeid(vector<Real>))) {
+    ps = new AggregatedPoolStorage<vector<Real> >(&pool, descriptorName, stats, true);
+  }
+  else {
+    throw EssentiaException("connectAggregated: cannot aggregate tokens of type ", nameOfType(sourceType));
+  }
+
+  try {
+    connect(source, ps->input("data"));
+  }
+  catch (EssentiaException& e) {
+    delete ps;
+    std::ostringstream msg;
+    msg << "While connecting " << source.fullName()
+        << " to Pool[" << descriptorName << "] (aggregated):\n"
+        << e.what();
+    throw EssentiaException(msg);
+  }
+}
+
+void connectAggregated(SourceBase& source, Pool& pool, const string& descriptorName) {
+  const char* defaultStatsC[] = { "mean", "stdev", "min", "max", "median" };
+  connectAggregated(source, pool, descriptorName, arrayToVector<string>(defaultStatsC));
+}
+
+} // namespace streaming
+} // namespace essentia
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_AGGREGATEDPOOLSTORAGE_H
+#define ESSENTIA_AGGREGATEDPOOLSTORAGE_H
+
+#include "poolstorage.h"
+#include "../../utils/onlinestatistics.h"
+
+namespace essentia {
+namespace streaming {
+
+/**
+ * Sink which aggregates the frames of a descriptor as they arrive, instead
+ * of storing them in the Pool like the PoolStorage does. When the end of the
+ * stream is reached, the statistics are added to the Pool under the same
+ * names and with the same types as the ones the PoolAggregator would have
+ * output for the descriptor, so the memory used does not depend on the
+ * number of frames. The median is estimated (see MedianEstimator), the
+ * other statistics are exact.
+ */
+class AggregatedPoolStorageBase : public PoolStorageBase {
+ protected:
+  std::vector<std::string> _stats;
+  OnlineStatistics _statistics;
+  bool _isVector;       // whether the descriptor is a vector<Real> one
+  bool _sizeMismatch;   // whether frames of different sizes have been received
+
+  void addFrame(const std::vector<Real>& frame);
+  void addFrame(Real value);
+  void addToPool();
+
+ public:
+  AggregatedPoolStorageBase(Pool* pool, const std::string& descriptorName,
+                            const std::vector<std::string>& stats, bool isVector);
+
+  void declareParameters() {}
+  void reset();
+};
+
+template <typename TokenType, typename StorageType = TokenType>
+class AggregatedPoolStorage : public AggregatedPoolStorageBase {
+ protected:
+  Sink<TokenType> _descriptor;
+
+ public:
+  AggregatedPoolStorage(Pool* pool, const std::string& descriptorName,
+                        const std::vector<std::string>& stats, bool isVector) :
+    AggregatedPoolStorageBase(pool, descriptorName, stats, isVector) {
+
+    setName("AggregatedPoolStorage");
+    declareInput(_descriptor, 1, "data", "the input data");
+  }
+
+  AlgorithmStatus process() {
+    int ntokens = std::min(_descriptor.available(),
+                           _descriptor.buffer().bufferInfo().maxContiguousElements);
+    ntokens = std::max(ntokens, 1);
+
+    if (!_descriptor.acquire(ntokens)) {
+      if (!shouldStop()) return NO_INPUT;
+
+      // all the frames have been aggregated
+      addToPool();
+      return FINISHED;
+    }
+
+    const std::vector<TokenType>& tokens = _descriptor.tokens();
+    for (int i=0; i<ntokens; ++i) addFrame(static_cast<const StorageType&>(tokens[i]));
+
+    _descriptor.release(ntokens);
+
+    return OK;
+  }
+};
+
+
+/**
+ * The statistics which can be computed without storing the frames, i.e. all
+ * the ones supported by the PoolAggregator except 'copy' and 'value'.
+ */
+const std::vector<std::string>& onlineAggregationStats();
+
+/**
+ * Connect a source to a Pool, so that only the given statistics of its
+ * tokens are stored in the Pool under the given descriptor name, as the
+ * PoolAggregator would have computed them. The source must output Real, int
+ * or vector<Real> tokens.
+ */
+void connectAggregated(SourceBase& source, Pool& pool,
+                       const std::string& descriptorName,
+                       const std::vector<std::string>& stats);
+
+/**
+ * Same as above, with the default statistics of the PoolAggregator: mean,
+ * stdev, min, max and median.
+ */
+void connectAggregated(SourceBase& source, Pool& pool,
+                       const std::string& descriptorName);
+
+} // namespace streaming
+} // namespace essentia
+
+#endif // ESSENTIA_AGGREGATEDPOOLSTORAGE_H
@@ -30,11 +30,14 @@ class PoolStorageBase : public Algorithm {
  protected:
   Pool* _pool;
   std::string _descriptorName;
+  // interned once here, so that storing the tokens doesn't look up the name
+  const Pool::Key& _key;
   bool _setSingle;
 
  public:
   PoolStorageBase(Pool* pool, const std::string& descriptorName, bool setSingle = false) :
-    _pool(pool), _descriptorName(descriptorName), _setSingle(setSingle) {}
+    _pool(pool), _descriptorName(descriptorName), _key(pool->key(descriptorName)),
+    _setSingle(setSingle) {}
 
   ~PoolStorageBase() {}
 
@@ -81,7 +84,7 @@ class PoolStorage : public PoolStorageBase {
 
     EXEC_DEBUG("appending tokens to pool");
     if (ntokens > 1) {
-      _pool->append(_descriptorName, _descriptor.tokens());
+      _pool->append(_key, _descriptor.tokens());
     }
     else {
       addToPool((StorageType)_descriptor.firstToken());
@@ -97,31 +100,31 @@ class PoolStorage : public PoolStorageBase {
   void addToPool(const std::vector<T>& value) {
     if (_setSingle) {
       for (int i=0; i<(int)value.size();++i)
-      _pool->add(_descriptorName, value[i]);
+      _pool->add(_key, value[i]);
     }
-    else _pool->add(_descriptorName, value);
+    else _pool->add(_key, value);
   }
 
   void addToPool(const std::vector<Real>& value) {
-    if (_setSingle) _pool->set(_descriptorName, value);
-    else            _pool->add(_descriptorName, value);
+    if (_setSingle) _pool->set(_key, value);
+    else            _pool->add(_key, value);
   }
 
   template <typename T>
   void addToPool(const T& value) {
-    if (_setSingle) _pool->set(_descriptorName, value);
-    else            _pool->add(_descriptorName, value);
+    if (_setSingle) _pool->set(_key, value);
+    else            _pool->add(_key, value);
    }
 
   template <typename T>
   void addToPool(const TNT::Array2D<T>& value) {
-    _pool->add(_descriptorName, value);
+    _pool->add(_key, value);
     /*
       if (_setSingle) {
       throw EssentiaException("PoolStorage::addToPool, setting Array2D as single value"
                               " is not supported by Pool.");
       }
-      else _pool->add(_descriptorName, value);
+      else _pool->add(_key, value);
     */
   }
 
@@ -131,7 +134,7 @@ class PoolStorage : public PoolStorageBase {
                               " is not supported by Pool.");
     }
     else {
-      _pool->add(_descriptorName, value);
+      _pool->add(_key, value);
     }
   }
 
@@ -29,10 +29,12 @@ namespace streaming {
 
 const char* RingBufferInput::name = "RingBufferInput";
 const char* RingBufferInput::description = DOC(
-"This algorithm gets data from an input ringbuffer of type Real that is fed into the essentia streaming mode."
+"This algorithm gets data from an input ringbuffer of type Real that is fed into the essentia streaming mode.\n"
+"\n"
+"In real-time mode, the ringbuffer is lock-free for one thread adding data and the one running the network: adding data never blocks, and when the ringbuffer is full the new data is either dropped or overwrites the oldest one, depending on the \"overflowPolicy\" parameter. Instead of waiting for data, process() then returns without producing anything when the ringbuffer is empty, so the network can be run step by step with Network::runStep(). The overruns(), underruns() and latency() methods give the number of samples lost, the number of times no data was available and the number of samples waiting in the ringbuffer."
 );
 
-RingBufferInput::RingBufferInput():_impl(0)
+RingBufferInput::RingBufferInput():_impl(0), _realTime(false), _underruns(0)
 {
   declareOutput(_output, 1024, "signal", "data source of what's coming from the ringbuffer");
   _output.setBufferType(BufferUsage::forAudioStream);
@@ -46,20 +48,43 @@ RingBufferInput::~RingBufferInput()
 void RingBufferInput::configure()
 {
 	delete _impl;
-	_impl = new RingBufferImpl(RingBufferImpl::kAvailable,parameter("bufferSize").toInt());
+	_realTime = parameter("realTime").toBool();
+	RingBufferImpl::OverflowPolicy policy = parameter("overflowPolicy").toString() == "overwrite" ?
+	  RingBufferImpl::kOverwrite : RingBufferImpl::kDrop;
+	_impl = new RingBufferImpl(RingBufferImpl::kAvailable,parameter("bufferSize").toInt(), _realTime, policy);
 }
 
 void RingBufferInput::add(Real* inputData, int size)
 {
-	//std::cerr << "adding " << size << " to ringbuffer with space " << _impl->_space << std::endl;
+	//std::cerr << "adding " << size << " to ringbuffer with space " << _impl->space() << std::endl;
 	int added = _impl->add(inputData,size);
-	if (added < size) throw EssentiaException("Not enough space in ringbuffer at input");
+	if (added < size && !_realTime) throw EssentiaException("Not enough space in ringbuffer at input");
+}
+
+int RingBufferInput::overruns() const {
+  return _impl->_overruns;
+}
+
+int RingBufferInput::latency() const {
+  return min(_impl->available(), _impl->_bufferSize);
+}
+
+int RingBufferInput::maxLatency() const {
+  return _impl->_maxLatency;
 }
 
 AlgorithmStatus RingBufferInput::process() {
-  //std::cerr << "ringbufferinput waiting" << std::endl;
-  _impl->waitAvailable();
-  //std::cerr << "ringbufferinput waiting done" << std::endl;
+  if (_realTime) {
+    if (_impl->available() == 0) {
+      _underruns++;
+      return NO_INPUT;
+    }
+  }
+  else {
+    //std::cerr << "ringbufferinput waiting" << std::endl;
+    _impl->waitAvailable();
+    //std::cerr << "ringbufferinput waiting done" << std::endl;
+  }
 
   AlgorithmStatus status = acquireData();
 
@@ -75,12 +100,13 @@ AlgorithmStatus RingBufferInput::process() {
 
   //std::cerr << "ringbufferinput getting" << outputSize << endl;
   int size = _impl->get(outputData, outputSize);
-  //std::cerr << "got " << size << " from ringbuffer with space " << _impl->_space << std::endl;
+  //std::cerr << "got " << size << " from ringbuffer with space " << _impl->space() << std::endl;
 
   _output.setReleaseSize(size);
   releaseData();
 
-  assert(size);
+  // in real-time mode, everything which was available may have been overwritten
+  if (size == 0) return NO_INPUT;
 
   return OK;
 }
@@ -88,6 +114,7 @@ AlgorithmStatus RingBufferInput::process() {
 void RingBufferInput::reset() {
   Algorithm::reset();
   _impl->reset();
+  _underruns = 0;
 }
 
 } // namespace streaming
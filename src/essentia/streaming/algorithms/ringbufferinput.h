@@ -29,13 +29,39 @@ class RingBufferInput : public Algorithm {
  protected:
   Source<Real> _output;
   class RingBufferImpl* _impl;
+  bool _realTime;
+  int _underruns;
 
  public:
   RingBufferInput();
   ~RingBufferInput();
 
+  /**
+   * Adds data to the ringbuffer, to be called from the thread producing it.
+   * In real-time mode, this never blocks nor allocates memory, and data which
+   * does not fit in the ringbuffer is handled according to the overflow
+   * policy instead of throwing an exception. Only one thread can add data.
+   */
   void add(Real* inputData, int size);
 
+  /**
+   * Number of samples which were dropped or overwritten because the
+   * ringbuffer was full.
+   */
+  int overruns() const;
+
+  /**
+   * Number of calls to process() which found no data in real-time mode.
+   */
+  int underruns() const { return _underruns; }
+
+  /**
+   * Number of samples currently waiting in the ringbuffer, and the largest
+   * one seen by process() since the last reset.
+   */
+  int latency() const;
+  int maxLatency() const;
+
   AlgorithmStatus process();
 
   void shouldStop(bool stop) {
@@ -44,6 +70,8 @@ class RingBufferInput : public Algorithm {
 
   void declareParameters() {
     declareParameter("bufferSize", "the size of the ringbuffer", "", 8192);
+    declareParameter("realTime", "whether to never wait nor take a lock, so that data can be added from a real-time thread (process() then returns immediately when there is no data)", "{true,false}", false);
+    declareParameter("overflowPolicy", "what to do in real-time mode with the data added when the ringbuffer is full: drop it, or overwrite the oldest data", "{drop,overwrite}", "drop");
   }
 
   void configure();
@@ -26,9 +26,11 @@ namespace essentia {
 namespace streaming {
 
 const char* RingBufferOutput::name = "RingBufferOutput";
-const char* RingBufferOutput::description = DOC("This algorithm fills an output ringbuffer of type Real that can be read from a different thread then.");
+const char* RingBufferOutput::description = DOC("This algorithm fills an output ringbuffer of type Real that can be read from a different thread then.\n"
+"\n"
+"In real-time mode, the ringbuffer is lock-free for the thread running the network and the one getting data: neither of them ever waits, and when the ringbuffer is full the new data is either dropped or overwrites the oldest one, depending on the \"overflowPolicy\" parameter. The overruns() and latency() methods give the number of samples lost and the number of samples waiting in the ringbuffer.");
 
-RingBufferOutput::RingBufferOutput() : _impl(0)
+RingBufferOutput::RingBufferOutput() : _impl(0), _realTime(false)
 {
   declareInput(_input, 1024, "signal", "the input signal that should go into the ringbuffer");
 }
@@ -41,7 +43,10 @@ RingBufferOutput::~RingBufferOutput()
 void RingBufferOutput::configure()
 {
 	delete _impl;
-	_impl = new RingBufferImpl(RingBufferImpl::kSpace,parameter("bufferSize").toInt());
+	_realTime = parameter("realTime").toBool();
+	RingBufferImpl::OverflowPolicy policy = parameter("overflowPolicy").toString() == "overwrite" ?
+	  RingBufferImpl::kOverwrite : RingBufferImpl::kDrop;
+	_impl = new RingBufferImpl(RingBufferImpl::kSpace,parameter("bufferSize").toInt(), _realTime, policy);
 }
 
 int RingBufferOutput::get(Real* outputData, int max)
@@ -49,8 +54,20 @@ int RingBufferOutput::get(Real* outputData, int max)
 	return _impl->get(outputData,max);
 }
 
+int RingBufferOutput::overruns() const {
+  return _impl->_overruns;
+}
+
+int RingBufferOutput::latency() const {
+  return min(_impl->available(), _impl->_bufferSize);
+}
+
+int RingBufferOutput::maxLatency() const {
+  return _impl->_maxLatency;
+}
+
 AlgorithmStatus RingBufferOutput::process() {
-  _impl->waitSpace();
+  if (!_realTime) _impl->waitSpace();
 
   AlgorithmStatus status = acquireData();
   if (status != OK) return status;
@@ -60,7 +77,7 @@ AlgorithmStatus RingBufferOutput::process() {
   int inputSize = inputSignal.size();
 
   int size = _impl->add(inputData, inputSize);
-  if (size != inputSize) throw EssentiaException("Not enough space in ringbuffer at output");
+  if (size != inputSize && !_realTime) throw EssentiaException("Not enough space in ringbuffer at output");
   releaseData();
 
   return OK;
@@ -29,17 +29,38 @@ class RingBufferOutput : public Algorithm {
  protected:
   Sink<Real> _input;
   class RingBufferImpl* _impl;
+  bool _realTime;
 
  public:
   RingBufferOutput();
   ~RingBufferOutput();
 
+  /**
+   * Gets at most max samples from the ringbuffer, to be called from the
+   * thread consuming them. In real-time mode, this never blocks nor allocates
+   * memory. Only one thread can get data.
+   */
   int get(Real* outputData, int max);
 
+  /**
+   * Number of samples which were dropped or overwritten because the
+   * ringbuffer was full.
+   */
+  int overruns() const;
+
+  /**
+   * Number of samples currently waiting in the ringbuffer, and the largest
+   * one seen by get() since the last reset.
+   */
+  int latency() const;
+  int maxLatency() const;
+
   AlgorithmStatus process();
 
   void declareParameters() {
     declareParameter("bufferSize", "the size of the ringbuffer", "", 8192);
+    declareParameter("realTime", "whether to never wait nor take a lock, so that data can be read from a real-time thread (process() then never waits for space in the ringbuffer)", "{true,false}", false);
+    declareParameter("overflowPolicy", "what to do in real-time mode with the data output when the ringbuffer is full: drop it, or overwrite the oldest data", "{drop,overwrite}", "drop");
   }
 
   void configure();
@@ -105,8 +105,6 @@ class VectorInput : public Algorithm {
   void reset() {
     Algorithm::reset();
     _idx = 0;
-    _output.setAcquireSize(acquireSize);
-    _output.setReleaseSize(acquireSize);
   }
 
   bool shouldStop() const {
@@ -122,8 +120,11 @@ class VectorInput : public Algorithm {
     }
 
     // if we're at the end of the vector, just acquire the necessary amount of
-    // tokens on the output source
-    if (_idx + _output.acquireSize() > (int)_inputVector->size()) {
+    // tokens on the output source. The acquire size, which may have been set
+    // when connecting (see connect() below), is restored afterwards so that
+    // the vector is fed in the same way when running again after a reset
+    int chunkSize = _output.acquireSize();
+    if (_idx + chunkSize > (int)_inputVector->size()) {
       int howmuch = (int)_inputVector->size() - _idx;
       _output.setAcquireSize(howmuch);
       _output.setReleaseSize(howmuch);
@@ -149,6 +150,9 @@ class VectorInput : public Algorithm {
     releaseData();
     EXEC_DEBUG("released " << _output.releaseSize() << " tokens");
 
+    _output.setAcquireSize(chunkSize);
+    _output.setReleaseSize(chunkSize);
+
     return OK;
   }
 
@@ -36,6 +36,14 @@ class MultiRateBuffer {
   virtual BufferInfo bufferInfo() const = 0;
   virtual void setBufferInfo(const BufferInfo& info) = 0;
 
+  // the smallest size and phantom size which would have been enough for
+  // everything that has been acquired since the last call to setBufferInfo(),
+  // and with which the largest read and write requests can't block each other
+  virtual BufferInfo requiredBufferInfo() const = 0;
+
+  virtual void setThreadingPolicy(BufferThreading::BufferThreadingPolicy policy) = 0;
+  virtual BufferThreading::BufferThreadingPolicy threadingPolicy() const = 0;
+
   // add/remove readers to/from the buffer
   // returns the id of the newly attached reader
   virtual ReaderID addReader(bool startFromZero = false) = 0;
@@ -24,6 +24,7 @@
 #include "multiratebuffer.h"
 #include "../roguevector.h"
 #include "../threading.h"
+#include "../utils/atomic.h"
 #include "../essentiautil.h"
 
 
@@ -51,7 +52,13 @@ class Window {
  * that retrieving any number of samples lower than the phantom size can be done
  * on a contiguous zone in memory.
  *
- * @todo class should be thread-safe, but make sure it really is
+ * The writer and the readers can run on different threads. By default, the
+ * read and write windows are protected by a mutex; with the LockFree threading
+ * policy and a single reader, the writer and the reader each own their window
+ * and only communicate through the atomic counters of tokens written and read,
+ * so that a producer and a consumer can run concurrently without ever locking.
+ * Adding or removing readers, resizing and resetting the buffer are not
+ * thread-safe and should only be done while the network is not running.
  *
  * NB: we can only guarantee that availableFor* returns a least the size of the phantom buffer, not more
  *     we have to choose the size of the phantom zone carefully, or make it dynamically resizable
@@ -61,7 +68,8 @@ class PhantomBuffer : public MultiRateBuffer<T> {
 
  public:
 
-  PhantomBuffer(SourceBase* parent, BufferUsage::BufferUsageType type) {
+  PhantomBuffer(SourceBase* parent, BufferUsage::BufferUsageType type) :
+    _policy(BufferThreading::Locked), _tokensWritten(0), _tokensRead(0) {
     _parent = parent;
     setBufferType(type);
   }
@@ -107,13 +115,40 @@ class PhantomBuffer : public MultiRateBuffer<T> {
     _bufferSize = info.size;
     _phantomSize = info.maxContiguousElements;
     _buffer.resize(_bufferSize + _phantomSize);
+    _peakUsage = _peakWriteRequest = 0;
+    std::fill(_peakReadRequest.begin(), _peakReadRequest.end(), 0);
+  }
+
+  BufferInfo requiredBufferInfo() const {
+    int peakRead = 0;
+    for (int i=0; i<(int)_peakReadRequest.size(); i++) {
+      peakRead = std::max(peakRead, _peakReadRequest[i]);
+    }
+    // some readers (e.g. FrameCutter) wait for one more token than they
+    // acquire, so they can hold peakRead tokens while the writer needs room
+    // for peakWrite ones
+    int contiguous = std::max(_peakWriteRequest, peakRead);
+    int size = std::max(_peakUsage, peakRead + _peakWriteRequest);
+    return BufferInfo(std::max(size, contiguous + 1), contiguous);
+  }
+
+  void setThreadingPolicy(BufferThreading::BufferThreadingPolicy policy) {
+    _policy = policy;
+  }
+
+  BufferThreading::BufferThreadingPolicy threadingPolicy() const {
+    return _policy;
   }
 
   PhantomBuffer(SourceBase* parent, int size, int phantomSize) :
     _parent(parent),
     _bufferSize(size),
     _phantomSize(phantomSize),
-    _buffer(size + phantomSize) {
+    _buffer(size + phantomSize),
+    _policy(BufferThreading::Locked),
+    _tokensWritten(0),
+    _tokensRead(0),
+    _peakUsage(0), _peakWriteRequest(0) {
     // initialize views and all??
   }
 
@@ -140,7 +175,6 @@ class PhantomBuffer : public MultiRateBuffer<T> {
   void releaseForWrite(int released);
   void releaseForRead(ReaderID id, int released);
 
-  // @todo mutex-lock these functions or not??
   /**
    * Add a new reader and return its ID. The reader will start at the point
    * where the write window is currently located.
@@ -166,16 +200,29 @@ class PhantomBuffer : public MultiRateBuffer<T> {
   }
 
   int totalTokensWritten() const {
-    MutexLocker lock(mutex); NOWARN_UNUSED(lock);
-    return _writeWindow.total(_bufferSize);
+    return _tokensWritten;
   }
 
   int totalTokensRead(ReaderID id) const {
+    if (lockFree()) return _tokensRead;
     MutexLocker lock(mutex); NOWARN_UNUSED(lock);
     return _readWindow[id].total(_bufferSize);
   }
 
   const T& lastTokenProduced() const {
+    if (lockFree()) {
+      // the reader can't look at the write window, but the last token is
+      // released and won't be overwritten before the reader releases it
+      int total = _tokensWritten;
+      if (total == 0) {
+        throw EssentiaException("Tried to call ::lastTokenProduced() on ", _parent->fullName(),
+                                " which hasn't produced any token yet");
+      }
+      int idx = total % _bufferSize;
+      if (idx == 0) return _buffer[_bufferSize-1];
+      return _buffer[idx-1];
+    }
+
     MutexLocker lock(mutex); NOWARN_UNUSED(lock);
     if (_writeWindow.total(_bufferSize) == 0) {
       throw EssentiaException("Tried to call ::lastTokenProduced() on ", _parent->fullName(),
@@ -199,11 +246,33 @@ class PhantomBuffer : public MultiRateBuffer<T> {
   Window _writeWindow;
   std::vector<Window> _readWindow;
 
+  // the largest request of each reader, kept next to its window as readers
+  // of the same buffer can run concurrently
+  std::vector<int> _peakReadRequest;
+
   RogueVector<T> _writeView;
   std::vector<RogueVector<T> > _readView; // @todo CAREFUL WHEN COPYING ROGUEVECTOR...
 
   // threading-related & locking structures
-  mutable Mutex mutex; // should be locked before any modification to the object
+  mutable Mutex mutex; // should be locked before any modification to the object,
+                       // unless the buffer is in lock-free mode
+
+  BufferThreading::BufferThreadingPolicy _policy;
+
+  // number of tokens written by the writer and read by the first reader, the
+  // only state shared by the writer and the reader in lock-free mode
+  Atomic _tokensWritten;
+  Atomic _tokensRead;
+
+  // the largest number of tokens the writer has needed in the buffer at once
+  // (unread ones plus the ones it asked for), and its largest request. They
+  // are only updated by the writer, so they need no synchronization.
+  int _peakUsage;
+  int _peakWriteRequest;
+
+  bool lockFree() const {
+    return _policy == BufferThreading::LockFree && _readWindow.size() == 1;
+  }
 
  protected:
   // this function is only here to make sure we do not overflow the window.turn variable
@@ -215,7 +284,15 @@ class PhantomBuffer : public MultiRateBuffer<T> {
   void updateReadView(ReaderID id);
   void updateWriteView();
 
-  // mutex should be locked before entering this function
+  // these do the actual work for the acquire/release methods, the mutex should
+  // be locked before entering them, unless the buffer is in lock-free mode
+  bool acquireReadWindow(ReaderID id, int requested);
+  bool acquireWriteWindow(int requested);
+  void releaseReadWindow(ReaderID id, int released);
+  void releaseWriteWindow(int released);
+
+  // mutex should be locked before entering this function, unless the buffer is
+  // in lock-free mode
   // make sure it doesn't overflow
   int availableForRead(ReaderID id) const;
   int availableForWrite(bool contiguous=true) const;
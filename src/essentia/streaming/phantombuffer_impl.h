@@ -39,8 +39,10 @@ ReaderID PhantomBuffer<T>::addReader(bool startFromZero) {
     w.end = w.begin = _writeWindow.begin;
   }
   _readWindow.push_back(w);
+  _peakReadRequest.push_back(0);
 
   ReaderID id = _readWindow.size() - 1; // index of last one
+  if (id == 0) _tokensRead = w.total(_bufferSize);
 
   _readView.push_back(RogueVector<T>());
   updateReadView(id);
@@ -52,6 +54,8 @@ template <typename T>
 void PhantomBuffer<T>::removeReader(ReaderID id) {
   _readView.erase(_readView.begin() + id);
   _readWindow.erase(_readWindow.begin() + id);
+  _peakReadRequest.erase(_peakReadRequest.begin() + id);
+  _tokensRead = _readWindow.empty() ? 0 : _readWindow[0].total(_bufferSize);
 }
 
 
@@ -82,13 +86,11 @@ bool PhantomBuffer<T>::acquireForRead(ReaderID id, int requested) {
     throw EssentiaException(msg);
   }
 
-  MutexLocker lock(mutex); NOWARN_UNUSED(lock);
-  if (availableForRead(id) < requested) return false;
+  // in lock-free mode, the read window is only ever touched by the reader
+  if (lockFree()) return acquireReadWindow(id, requested);
 
-  _readWindow[id].end = _readWindow[id].begin + requested;
-  updateReadView(id);
-
-  return true;
+  MutexLocker lock(mutex); NOWARN_UNUSED(lock);
+  return acquireReadWindow(id, requested);
 }
 
 /**
@@ -110,8 +112,59 @@ bool PhantomBuffer<T>::acquireForWrite(int requested) {
     throw EssentiaException(msg);
   }
 
+  // in lock-free mode, the write window is only ever touched by the writer
+  if (lockFree()) return acquireWriteWindow(requested);
+
   MutexLocker lock(mutex); NOWARN_UNUSED(lock);
-  if (availableForWrite() < requested) return false;
+  return acquireWriteWindow(requested);
+}
+
+template <typename T>
+void PhantomBuffer<T>::releaseForWrite(int released) {
+  if (lockFree()) {
+    releaseWriteWindow(released);
+    return;
+  }
+
+  MutexLocker lock(mutex); NOWARN_UNUSED(lock);
+  releaseWriteWindow(released);
+}
+
+template <typename T>
+void PhantomBuffer<T>::releaseForRead(ReaderID id, int released) {
+  if (lockFree()) {
+    releaseReadWindow(id, released);
+    return;
+  }
+
+  MutexLocker lock(mutex); NOWARN_UNUSED(lock);
+  releaseReadWindow(id, released);
+}
+
+
+////////// -- protected methods implementation
+
+
+template <typename T>
+bool PhantomBuffer<T>::acquireReadWindow(ReaderID id, int requested) {
+  _peakReadRequest[id] = std::max(_peakReadRequest[id], requested);
+  if (availableForRead(id) < requested) return false;
+
+  _readWindow[id].end = _readWindow[id].begin + requested;
+  updateReadView(id);
+
+  return true;
+}
+
+template <typename T>
+bool PhantomBuffer<T>::acquireWriteWindow(int requested) {
+  // same as availableForWrite(), but we need the non-contiguous value too
+  int available = availableForWrite(false);
+  _peakUsage = std::max(_peakUsage, _bufferSize - available + requested);
+  _peakWriteRequest = std::max(_peakWriteRequest, requested);
+
+  available = std::min(available, _bufferSize + _phantomSize - _writeWindow.begin);
+  if (available < requested) return false;
 
   _writeWindow.end = _writeWindow.begin + requested;
   updateWriteView();
@@ -120,9 +173,7 @@ bool PhantomBuffer<T>::acquireForWrite(int requested) {
 }
 
 template <typename T>
-void PhantomBuffer<T>::releaseForWrite(int released) {
-  MutexLocker lock(mutex); NOWARN_UNUSED(lock);
-
+void PhantomBuffer<T>::releaseWriteWindow(int released) {
   // error checking:
   if (released > _writeWindow.end - _writeWindow.begin) {
     std::ostringstream msg;
@@ -151,12 +202,15 @@ void PhantomBuffer<T>::releaseForWrite(int released) {
   relocateWriteWindow();
   updateWriteView();
 
+  // publish the new tokens only once they have been completely written,
+  // including their copy in the phantom zone
+  _tokensWritten += released;
+
   //DEBUG_NL(" - total written tokens: " << _writeWindow.total(_bufferSize));
 }
 
 template <typename T>
-void PhantomBuffer<T>::releaseForRead(ReaderID id, int released) {
-  MutexLocker lock(mutex); NOWARN_UNUSED(lock);
+void PhantomBuffer<T>::releaseReadWindow(ReaderID id, int released) {
   Window& w = _readWindow[id];
 
   // error checking:
@@ -171,13 +225,13 @@ void PhantomBuffer<T>::releaseForRead(ReaderID id, int released) {
   relocateReadWindow(id);
   updateReadView(id);
 
+  // the writer may overwrite these tokens as soon as they are published
+  if (id == 0) _tokensRead += released;
+
   //DEBUG_NL(" - total read tokens: " << w.total(_bufferSize));
 }
 
 
-////////// -- protected methods implementation
-
-
 template <typename T>
 inline void PhantomBuffer<T>::resetTurns() {
   // only do it when necessary
@@ -225,7 +279,9 @@ template <typename T>
 int PhantomBuffer<T>::availableForRead(ReaderID id) const {
   //relocateReadWindow(id); // this call should be useless, but it's a safety guard to have it
 
-  int theoretical = _writeWindow.total(_bufferSize) - _readWindow[id].total(_bufferSize);
+  // the number of tokens written is read from the atomic counter, which is
+  // only updated once the tokens are ready to be read
+  int theoretical = (int)_tokensWritten - _readWindow[id].total(_bufferSize);
   int contiguous = _bufferSize + _phantomSize - _readWindow[id].begin;
 
   /*
@@ -248,6 +304,13 @@ template <typename T>
 int PhantomBuffer<T>::availableForWrite(bool contiguous) const {
   //relocateWriteWindow(); // this call should be useless, but it's a safety guard to have it
 
+  if (lockFree()) {
+    // the reader only publishes the number of tokens it has released
+    int theoretical = (int)_tokensRead - _writeWindow.total(_bufferSize) + _bufferSize;
+    if (!contiguous) return theoretical;
+    return std::min(theoretical, _bufferSize + _phantomSize - _writeWindow.begin);
+  }
+
   int minTotal = _bufferSize;
   if (!_readWindow.empty()) { // someone is connected, take its value instead of bufferSize
     minTotal = _readWindow.begin()->total(_bufferSize);
@@ -304,6 +367,8 @@ void PhantomBuffer<T>::reset() {
   for (int i=0; i<(int)_readWindow.size(); i++) {
     _readWindow[i] = Window();
   }
+  _tokensWritten = 0;
+  _tokensRead = 0;
 }
 
 } // namespace streaming
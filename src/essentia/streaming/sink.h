@@ -93,6 +93,14 @@ class Sink : public SinkBase {
                               ", which has not been connected.");
   }
 
+  virtual int totalConsumed() const {
+    if (_source)      return buffer().totalTokensRead(_id);
+    else if (_sproxy) return _sproxy->totalConsumed();
+    else
+      throw EssentiaException("Cannot get number of consumed tokens for sink ", fullName(),
+                              ", which has not been connected.");
+  }
+
   virtual void reset() {}
 
   TokenType pop() {
@@ -85,6 +85,9 @@ class SinkBase : public Connector {
   // should return a TokenType*
   virtual const void* getFirstToken() const = 0;
 
+  // total number of tokens released by this sink since its buffer was reset
+  virtual int totalConsumed() const = 0;
+
  protected:
   // methods for standard connections
 
@@ -62,6 +62,18 @@ class Source : public SourceBase {
     _buffer->setBufferInfo(info);
   }
 
+  virtual BufferInfo requiredBufferInfo() const {
+    return _buffer->requiredBufferInfo();
+  }
+
+  virtual void setBufferThreadingPolicy(BufferThreading::BufferThreadingPolicy policy) {
+    _buffer->setThreadingPolicy(policy);
+  }
+
+  virtual BufferThreading::BufferThreadingPolicy bufferThreadingPolicy() const {
+    return _buffer->threadingPolicy();
+  }
+
   int totalProduced() const { return _buffer->totalTokensWritten(); }
 
   ReaderID addReader() {
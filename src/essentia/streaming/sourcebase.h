@@ -113,6 +113,15 @@ class SourceBase : public Connector {
   virtual BufferInfo bufferInfo() const = 0;
   virtual void setBufferInfo(const BufferInfo& info) = 0;
 
+  // smallest buffer with which the tokens would have flowed exactly as they
+  // did since the buffer was last resized, without the writer ever blocking
+  virtual BufferInfo requiredBufferInfo() const = 0;
+
+  // how the buffer is protected when its readers run on other threads than
+  // its writer (see BufferThreading::BufferThreadingPolicy)
+  virtual void setBufferThreadingPolicy(BufferThreading::BufferThreadingPolicy policy) = 0;
+  virtual BufferThreading::BufferThreadingPolicy bufferThreadingPolicy() const = 0;
+
  protected:
   // made those protected so that only our friend streaming::{dis}connect() functions can access these
   // @todo this function should probably be protected by a mutex (?)
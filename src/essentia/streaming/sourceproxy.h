@@ -80,6 +80,18 @@ class SourceProxyBase : public SourceBase {
     _proxiedSource->setBufferInfo(info);
   }
 
+  virtual BufferInfo requiredBufferInfo() const {
+    return _proxiedSource->requiredBufferInfo();
+  }
+
+  virtual void setBufferThreadingPolicy(BufferThreading::BufferThreadingPolicy policy) {
+    _proxiedSource->setBufferThreadingPolicy(policy);
+  }
+
+  virtual BufferThreading::BufferThreadingPolicy bufferThreadingPolicy() const {
+    return _proxiedSource->bufferThreadingPolicy();
+  }
+
 
   //---- StreamConnector interface hijacking for proxies ----------------------------------------//
 
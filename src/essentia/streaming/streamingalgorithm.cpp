@@ -253,10 +253,10 @@ void Algorithm::reset() {
 
 void Algorithm::shouldStop(bool stop) {
 #if DEBUGGING_ENABLED
-  std::ostringstream msg;
-  msg << "Streaming: " << name() << "::shouldStop[" << nProcess << "] = "
-      << (stop ? "true" : "false");
-  E_DEBUG(EAlgorithm, msg.str());
+  // only build the message when it is logged, the scheduler calls this
+  // for each algorithm at each step
+  E_DEBUG(EAlgorithm, "Streaming: " << name() << "::shouldStop[" << nProcess << "] = "
+          << (stop ? "true" : "false"));
 #else
   E_DEBUG(EAlgorithm, "Streaming: " << name() << "::shouldStop = " << (stop?"true":"false"));
 #endif
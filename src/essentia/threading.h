@@ -38,24 +38,6 @@ typedef tbb::spin_mutex ForcedMutex;
 typedef tbb::spin_mutex::scoped_lock ForcedMutexLocker;
 */
 
-// The mutex in essentia only needs to be a real mutex when it is possible
-// to call the algorithms in a multithreaded way.
-// If not, it can be replaced with a no-op mutex for performance reasons.
-
-class Mutex {
- public:
-  void lock() {}
-  void unlock() {}
-};
-
-class MutexLocker {
- public:
-  MutexLocker(Mutex& mutex) {}
-  void release() {}
-  void acquire(Mutex&) {}
-};
-
-
 // the ForcedMutex is a real Mutex, that should always lock properly
 // (ex: in FFTW, the plan creation/destruction needs to be protected no matter what)
 
@@ -101,6 +83,62 @@ class ForcedMutexLocker {
 };
 
 
+// The mutex in essentia only needs to be a real mutex when it is possible
+// to call the algorithms in a multithreaded way.
+// If not, it can be replaced with a no-op mutex for performance reasons.
+// As the scheduler can run independent branches of a Network on several
+// threads (see Network::setNumberOfThreads), it is a real mutex everywhere
+// except on platforms which are single-threaded anyway.
+
+#if defined(__EMSCRIPTEN__)
+
+class Mutex {
+ public:
+  void lock() {}
+  void unlock() {}
+};
+
+class MutexLocker {
+ public:
+  MutexLocker(Mutex& mutex) {}
+  void release() {}
+  void acquire(Mutex&) {}
+};
+
+#else // __EMSCRIPTEN__
+
+class Mutex : public ForcedMutex {
+ public:
+  Mutex() {}
+  // a copied object gets its own (unlocked) mutex, never a copy of the other one
+  Mutex(const Mutex&) : ForcedMutex() {}
+  Mutex& operator=(const Mutex&) { return *this; }
+};
+
+class MutexLocker {
+ protected:
+  Mutex* _mutex;
+ public:
+  MutexLocker(Mutex& mutex) : _mutex(&mutex) { _mutex->lock(); }
+  ~MutexLocker() { release(); }
+
+  void release() {
+    if (_mutex) {
+      _mutex->unlock();
+      _mutex = 0;
+    }
+  }
+
+  void acquire(Mutex& mutex) {
+    release();
+    _mutex = &mutex;
+    _mutex->lock();
+  }
+};
+
+#endif // __EMSCRIPTEN__
+
+
 } // namespace essentia
 
 #endif // ESSENTIA_THREADING_H
@@ -403,6 +403,24 @@ enum BufferUsageType {
 
 } // namespace BufferUsage
 
+namespace BufferThreading {
+
+/**
+ * Policy used by a buffer to protect its read and write windows when the
+ * writer and the readers run on different threads:
+ *  - Locked: all the accesses to the windows are serialized by a mutex
+ *  - LockFree: when there is a single reader, the writer and the reader only
+ *    share the number of tokens written and read so far, which are atomic
+ *    counters, and never lock. With several readers, the buffer falls back to
+ *    the Locked policy.
+ */
+enum BufferThreadingPolicy {
+  Locked,
+  LockFree
+};
+
+} // namespace BufferThreading
+
 } // namespace streaming
 } // namespace essentia
 
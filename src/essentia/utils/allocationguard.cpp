@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "allocationguard.h"
+
+namespace essentia {
+
+// thread-local, so that counting does not allocate nor need a lock
+#ifndef OS_WIN32
+static __thread sint64 allocationCount = 0;
+#else
+static __declspec(thread) sint64 allocationCount = 0;
+#endif
+
+static bool allocationGuardEnabled = false;
+
+sint64 AllocationGuard::allocations() {
+  return allocationCount;
+}
+
+bool AllocationGuard::enabled() {
+  return allocationGuardEnabled;
+}
+
+void AllocationGuard::countAllocation() {
+  ++allocationCount;
+}
+
+bool AllocationGuard::enable() {
+  allocationGuardEnabled = true;
+  return true;
+}
+
+} // namespace essentia
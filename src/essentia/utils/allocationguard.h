@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_ALLOCATIONGUARD_H
+#define ESSENTIA_ALLOCATIONGUARD_H
+
+#include <cstdlib>
+#include <new>
+#include "types.h"
+
+namespace essentia {
+
+/**
+ * Counts the heap allocations made by each thread, to check that code which
+ * must not allocate memory does not, e.g. a Network running in real-time mode
+ * (see Network::setRealTime()).
+ *
+ * Nothing is counted unless the application replaces the global operator new
+ * with the counting one, by writing ESSENTIA_COUNT_ALLOCATIONS at file scope
+ * in exactly one of its source files. This replaces all the forms of the
+ * global operator new (plain, nothrow and, in C++17, aligned) and costs a
+ * function call per allocation; it is meant for debug builds and tests.
+ *
+ * Memory obtained from the C allocators (malloc, realloc, fftwf_malloc, ...)
+ * is not counted.
+ */
+class AllocationGuard {
+ public:
+  /**
+   * Number of allocations made by the calling thread so far.
+   */
+  static sint64 allocations();
+
+  /**
+   * Whether allocations are counted, i.e. whether the counting operator new
+   * has been linked in.
+   */
+  static bool enabled();
+
+  // used by the counting operator new
+  static void countAllocation();
+  static bool enable();
+};
+
+} // namespace essentia
+
+
+#if __cplusplus >= 201103L
+#  define ESSENTIA_THROW_BAD_ALLOC
+#  define ESSENTIA_NOTHROW noexcept
+#else
+#  define ESSENTIA_THROW_BAD_ALLOC throw(std::bad_alloc)
+#  define ESSENTIA_NOTHROW throw()
+#endif
+
+// sized deallocation (C++14)
+#if __cplusplus >= 201402L
+#  define ESSENTIA_COUNT_SIZED_DELETE                                         \
+  void operator delete(void* p, std::size_t) noexcept { std::free(p); }       \
+  void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#else
+#  define ESSENTIA_COUNT_SIZED_DELETE
+#endif
+
+// over-aligned allocations (C++17)
+#if defined(__cpp_aligned_new) && !defined(OS_WIN32)
+#  define ESSENTIA_COUNT_ALIGNED_NEW                                          \
+  void* operator new(std::size_t size, std::align_val_t al,                   \
+                     const std::nothrow_t&) noexcept {                        \
+    essentia::AllocationGuard::countAllocation();                             \
+    std::size_t alignment = static_cast<std::size_t>(al);                     \
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);                 \
+    void* p = 0;                                                              \
+    if (posix_memalign(&p, alignment, size ? size : 1)) return 0;             \
+    return p;                                                                 \
+  }                                                                           \
+  void* operator new(std::size_t size, std::align_val_t al) {                 \
+    void* p = operator new(size, al, std::nothrow);                           \
+    if (!p) throw std::bad_alloc();                                           \
+    return p;                                                                 \
+  }                                                                           \
+  void* operator new[](std::size_t size, std::align_val_t al) {               \
+    return operator new(size, al);                                            \
+  }                                                                           \
+  void* operator new[](std::size_t size, std::align_val_t al,                 \
+                       const std::nothrow_t&) noexcept {                      \
+    return operator new(size, al, std::nothrow);                              \
+  }                                                                           \
+  void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }  \
+  void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }\
+  void operator delete(void* p, std::size_t, std::align_val_t) noexcept {     \
+    std::free(p);                                                             \
+  }                                                                           \
+  void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {   \
+    std::free(p);                                                             \
+  }                                                                           \
+  void operator delete(void* p, std::align_val_t,                             \
+                       const std::nothrow_t&) noexcept { std::free(p); }      \
+  void operator delete[](void* p, std::align_val_t,                           \
+                         const std::nothrow_t&) noexcept { std::free(p); }
+#else
+#  define ESSENTIA_COUNT_ALIGNED_NEW
+#endif
+
+#define ESSENTIA_COUNT_ALLOCATIONS                                            \
+  void* operator new(std::size_t size,                                        \
+                     const std::nothrow_t&) ESSENTIA_NOTHROW {                \
+    essentia::AllocationGuard::countAllocation();                             \
+    return std::malloc(size ? size : 1);                                      \
+  }                                                                           \
+  void* operator new(std::size_t size) ESSENTIA_THROW_BAD_ALLOC {             \
+    void* p = operator new(size, std::nothrow);                               \
+    if (!p) throw std::bad_alloc();                                           \
+    return p;                                                                 \
+  }                                                                           \
+  void* operator new[](std::size_t size) ESSENTIA_THROW_BAD_ALLOC {           \
+    return operator new(size);                                                \
+  }                                                                           \
+  void* operator new[](std::size_t size,                                      \
+                       const std::nothrow_t&) ESSENTIA_NOTHROW {              \
+    return operator new(size, std::nothrow);                                  \
+  }                                                                           \
+  void operator delete(void* p) ESSENTIA_NOTHROW { std::free(p); }            \
+  void operator delete[](void* p) ESSENTIA_NOTHROW { std::free(p); }          \
+  void operator delete(void* p, const std::nothrow_t&) ESSENTIA_NOTHROW {     \
+    std::free(p);                                                             \
+  }                                                                           \
+  void operator delete[](void* p, const std::nothrow_t&) ESSENTIA_NOTHROW {   \
+    std::free(p);                                                             \
+  }                                                                           \
+  ESSENTIA_COUNT_SIZED_DELETE                                                 \
+  ESSENTIA_COUNT_ALIGNED_NEW                                                  \
+  static bool essentiaAllocationGuardEnabled = essentia::AllocationGuard::enable();
+
+#endif // ESSENTIA_ALLOCATIONGUARD_H
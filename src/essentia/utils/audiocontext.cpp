@@ -18,11 +18,46 @@
  */
 
 #include "audiocontext.h"
+#include "threading.h"
 #include <iostream> // for warning cout
 
 using namespace std;
 using namespace essentia;
 
+
+static int lockFFmpeg(void** mutex, enum AVLockOp op) {
+  switch (op) {
+  case AV_LOCK_CREATE:
+    *mutex = new ForcedMutex();
+    break;
+  case AV_LOCK_OBTAIN:
+    ((ForcedMutex*)*mutex)->lock();
+    break;
+  case AV_LOCK_RELEASE:
+    ((ForcedMutex*)*mutex)->unlock();
+    break;
+  case AV_LOCK_DESTROY:
+    delete (ForcedMutex*)*mutex;
+    *mutex = 0;
+    break;
+  }
+  return 0;
+}
+
+static ForcedMutex ffmpegInitMutex;
+static bool ffmpegInitialized = false;
+
+void essentia::initFFmpeg() {
+  ForcedMutexLocker lock(ffmpegInitMutex);
+  if (ffmpegInitialized) return;
+
+  av_register_all();
+  if (av_lockmgr_register(lockFFmpeg) != 0) {
+    throw EssentiaException("Could not register the lock manager of FFmpeg");
+  }
+  ffmpegInitialized = true;
+}
+
 AudioContext::AudioContext()
   : _isOpen(false), _avStream(0), _muxCtx(0), _codecCtx(0),
     _inputBufSize(0), _buffer(0), _convertCtxAv(0) {
@@ -30,7 +65,7 @@ AudioContext::AudioContext()
   //av_log_set_level(AV_LOG_QUIET);
   
   // Register all formats and codecs
-  av_register_all(); // this should be done once only..
+  initFFmpeg();
 
   if (sizeof(float) != av_get_bytes_per_sample(AV_SAMPLE_FMT_FLT)) {
     throw EssentiaException("Unsupported float size");
@@ -43,5 +43,19 @@ extern "C" {
 #endif
 
 
+namespace essentia {
+
+/**
+ * Registers all the formats and codecs, along with a lock manager so that
+ * libavcodec can be used from several threads at once (this also protects
+ * the codecs that avformat_find_stream_info() opens and closes internally).
+ * Only the first call does anything; it is implemented in audiocontext.cpp,
+ * which is only compiled with FFmpeg.
+ */
+void initFFmpeg();
+
+} // namespace essentia
+
+
 #endif // ESSENTIA_FFMPEGAPI_H
 
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <cmath>
+#include "filterbank.h"
+#include "vectorkernels.h"
+
+using namespace std;
+
+namespace essentia {
+namespace util {
+
+void Filterbank::clear(int spectrumSize) {
+  _spectrumSize = spectrumSize;
+  _coefficients.clear();
+  _offsets.assign(1, 0);
+  _begins.clear();
+}
+
+void Filterbank::addBand(const vector<Real>& coefficients) {
+  if (int(coefficients.size()) != _spectrumSize) {
+    throw EssentiaException("Filterbank: the size of the band (", coefficients.size(),
+                            ") does not correspond to the size of the spectrum: ", _spectrumSize);
+  }
+
+  int begin = 0;
+  int end = _spectrumSize;
+  while (begin < end && coefficients[begin] == 0) ++begin;
+  while (end > begin && coefficients[end-1] == 0) --end;
+
+  addBand(begin, end > begin ? &coefficients[begin] : 0, end - begin);
+}
+
+void Filterbank::addBand(int begin, const Real* coefficients, int size) {
+  if (begin < 0 || size < 0 || begin + size > _spectrumSize) {
+    throw EssentiaException("Filterbank: the band starting at bin ", begin,
+                            " is outside of the spectrum, or has a negative size: ", size);
+  }
+
+  _coefficients.insert(_coefficients.end(), coefficients, coefficients + size);
+  _offsets.push_back(int(_coefficients.size()));
+  _begins.push_back(begin);
+}
+
+void Filterbank::createTriangularBands(const vector<Real>& frequencies,
+                                       Real sampleRate, int spectrumSize,
+                                       Real (*weighting)(Real), bool unitSum) {
+  /*
+  Every filter is a triangle starting at frequency [i] and going to frequency
+  [i+2]. This way we have overlap for each filter with the next and the
+  previous one.
+
+        /\
+  _____/  \_________
+      i    i+2
+  */
+
+  if (spectrumSize < 2) {
+    throw EssentiaException("TriangularBands: Filter bank cannot be computed from a spectrum with less than 2 bins");
+  }
+
+  clear(spectrumSize);
+
+  int filterSize = int(frequencies.size()) - 2;
+  Real frequencyScale = (sampleRate / 2.0) / (spectrumSize - 1);
+  vector<Real> band;
+
+  for (int i=0; i<filterSize; ++i) {
+    Real fstep1 = (*weighting)(frequencies[i+1]) - (*weighting)(frequencies[i]);
+    Real fstep2 = (*weighting)(frequencies[i+2]) - (*weighting)(frequencies[i+1]);
+
+    int jbegin = int(frequencies[i] / frequencyScale + 0.5);
+    int jend = int(frequencies[i+2] / frequencyScale + 0.5);
+
+    if (jend-jbegin <= 1) {
+      throw EssentiaException("TriangularBands: the number of spectrum bins is insufficient for the specified number of triangular bands. Use zero padding to increase the number of FFT bins.");
+    }
+
+    // bands above the Nyquist frequency are cut
+    jbegin = min(jbegin, spectrumSize);
+    jend = min(jend, spectrumSize);
+
+    band.assign(jend - jbegin, 0.0);
+
+    for (int j=jbegin; j<jend; ++j) {
+      Real binfreq = j*frequencyScale;
+      // in the ascending part of the triangle...
+      if ((binfreq >= frequencies[i]) && (binfreq < frequencies[i+1])) {
+        band[j-jbegin] = ((*weighting)(binfreq) - (*weighting)(frequencies[i])) / fstep1;
+      }
+      // in the descending part of the triangle...
+      else if ((binfreq >= frequencies[i+1]) && (binfreq < frequencies[i+2])) {
+        band[j-jbegin] = ((*weighting)(frequencies[i+2]) - (*weighting)(binfreq)) / fstep2;
+      }
+    }
+
+    // normalize the filter weights
+    if (unitSum) {
+      Real weight = 0.0;
+      for (int j=0; j<int(band.size()); ++j) weight += band[j];
+
+      if (weight != 0) {
+        for (int j=0; j<int(band.size()); ++j) band[j] /= weight;
+      }
+    }
+
+    addBand(jbegin, band.empty() ? 0 : &band[0], int(band.size()));
+  }
+}
+
+void Filterbank::compute(const vector<Real>& spectrum, vector<Real>& bands,
+                         bool power, bool log) {
+  if (int(spectrum.size()) != _spectrumSize) {
+    throw EssentiaException("Filterbank: the size of the spectrum (", spectrum.size(),
+                            ") does not correspond to the size of the filterbank: ", _spectrumSize);
+  }
+
+  int nBands = size();
+  bands.resize(nBands);
+  if (nBands == 0) return;
+
+  const Real* input = &spectrum[0];
+  if (power) {
+    // each bin is squared once, even if it is shared by several bands
+    _power.resize(_spectrumSize);
+    multiply(input, input, &_power[0], _spectrumSize);
+    input = &_power[0];
+  }
+
+  const Real* coefficients = _coefficients.empty() ? 0 : &_coefficients[0];
+
+  for (int i=0; i<nBands; ++i) {
+    int offset = _offsets[i];
+    bands[i] = dot(input + _begins[i], coefficients + offset, _offsets[i+1] - offset);
+  }
+
+  if (log) {
+    for (int i=0; i<nBands; ++i) bands[i] = log2(1 + bands[i]);
+  }
+}
+
+} // namespace util
+} // namespace essentia
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_FILTERBANK_H
+#define ESSENTIA_FILTERBANK_H
+
+#include <vector>
+#include "types.h"
+
+namespace essentia {
+namespace util {
+
+/**
+ * A filterbank stored in compressed sparse rows: for each band, only the
+ * coefficients between its first and last non-zero bin are kept, and the
+ * bands are stored one after the other in a single array. It is built once
+ * when the band algorithms are configured, and applied to every frame by
+ * compute().
+ */
+class Filterbank {
+
+ public:
+  Filterbank() : _spectrumSize(0) { _offsets.push_back(0); }
+
+  /**
+   * Removes all the bands, and sets the size of the spectra which will be
+   * given to compute().
+   */
+  void clear(int spectrumSize);
+
+  /**
+   * Adds a band given by its coefficients for all the bins of the spectrum.
+   * The zeros at both ends are not stored.
+   */
+  void addBand(const std::vector<Real>& coefficients);
+
+  /**
+   * Adds a band whose coefficients for the bins [begin, begin + size) are
+   * given, all the others being zero.
+   */
+  void addBand(int begin, const Real* coefficients, int size);
+
+  /**
+   * Clears the filterbank and fills it with triangular bands: band i starts
+   * at frequencies[i], has its vertex at frequencies[i+1] and ends at
+   * frequencies[i+2]. The coefficients are interpolated linearly in the
+   * scale given by @e weighting, and if @e unitSum is true, they are
+   * normalized so that they sum to one for each band.
+   */
+  void createTriangularBands(const std::vector<Real>& frequencies,
+                             Real sampleRate, int spectrumSize,
+                             Real (*weighting)(Real), bool unitSum);
+
+  int size() const { return int(_begins.size()); }
+  int spectrumSize() const { return _spectrumSize; }
+
+  /**
+   * Computes bands[i] = sum_j coefficients[i][j] * spectrum[j] for every
+   * band. If @e power is true, the squared spectrum is used instead, and if
+   * @e log is true, log2(1 + x) is applied to the bands.
+   */
+  void compute(const std::vector<Real>& spectrum, std::vector<Real>& bands,
+               bool power, bool log);
+
+ protected:
+  int _spectrumSize;
+  std::vector<Real> _coefficients;
+  std::vector<int> _offsets; // band i is in [_offsets[i], _offsets[i+1])
+  std::vector<int> _begins;  // first bin of each band
+  std::vector<Real> _power;
+};
+
+} // namespace util
+} // namespace essentia
+
+#endif // ESSENTIA_FILTERBANK_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "mappedfile.h"
+#include "types.h"
+#include <cstring>
+#include <cerrno>
+
+#ifdef OS_WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+namespace essentia {
+
+MappedFile::MappedFile() : _data(0), _size(0), _released(0), _isOpen(false)
+#ifndef OS_WIN32
+                         , _fd(-1)
+#endif
+{}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+void MappedFile::open(const string& filename, bool sequential) {
+  close();
+
+#ifdef OS_WIN32
+  ifstream file(filename.c_str(), ios::in | ios::binary);
+  if (!file) {
+    throw EssentiaException("Could not open file \"", filename, "\"");
+  }
+  file.seekg(0, ios::end);
+  _contents.resize(size_t(file.tellg()));
+  file.seekg(0, ios::beg);
+  if (!_contents.empty()) file.read(&_contents[0], _contents.size());
+  _size = _contents.size();
+  _data = _contents.empty() ? 0 : &_contents[0];
+#else
+  _fd = ::open(filename.c_str(), O_RDONLY);
+  if (_fd < 0) {
+    throw EssentiaException("Could not open file \"", filename, "\", error = ", strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(_fd, &st) != 0) {
+    string error = strerror(errno);
+    close();
+    throw EssentiaException("Could not get the size of file \"", filename, "\", error = ", error);
+  }
+  _size = size_t(st.st_size);
+
+  // empty files cannot be mapped, they simply have no contents
+  if (_size > 0) {
+    void* data = mmap(0, _size, PROT_READ, MAP_SHARED, _fd, 0);
+    if (data == MAP_FAILED) {
+      string error = strerror(errno);
+      close();
+      throw EssentiaException("Could not map file \"", filename, "\" in memory, error = ", error);
+    }
+    _data = (const char*)data;
+
+    if (sequential) madvise(data, _size, MADV_SEQUENTIAL);
+  }
+#endif
+
+  _released = 0;
+  _isOpen = true;
+}
+
+void MappedFile::close() {
+#ifdef OS_WIN32
+  _contents.clear();
+#else
+  if (_data) munmap((void*)_data, _size);
+  if (_fd >= 0) ::close(_fd);
+  _fd = -1;
+#endif
+  _data = 0;
+  _size = 0;
+  _released = 0;
+  _isOpen = false;
+}
+
+void MappedFile::release(size_t offset) {
+#ifndef OS_WIN32
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+
+  offset = min(offset, _size);
+  offset -= offset % pageSize;
+  if (offset <= _released) return;
+
+  madvise((void*)(_data + _released), offset - _released, MADV_DONTNEED);
+  _released = offset;
+#endif
+}
+
+} // namespace essentia
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_MAPPEDFILE_H
+#define ESSENTIA_MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include "config.h"
+
+namespace essentia {
+
+/**
+ * A read-only view of the whole contents of a file. The file is mapped in
+ * memory, so that its pages are only read when they are accessed, except on
+ * windows where it is read in memory when it is opened.
+ */
+class MappedFile {
+
+ public:
+  MappedFile();
+  ~MappedFile();
+
+  /**
+   * Maps the given file, closing the one which was mapped before if any.
+   * Throws an EssentiaException if the file cannot be opened.
+   * If @e sequential is true, the system is told that the file will be read
+   * once from the beginning to the end.
+   */
+  void open(const std::string& filename, bool sequential = false);
+  void close();
+
+  bool isOpen() const { return _isOpen; }
+
+  // data() is null for empty files
+  const char* data() const { return _data; }
+  size_t size() const { return _size; }
+
+  /**
+   * Tells the system that the pages in [0, offset) will not be read again,
+   * so that they do not count in the resident memory anymore (they stay in
+   * the page cache). Nothing is done on windows.
+   */
+  void release(size_t offset);
+
+ protected:
+  const char* _data;
+  size_t _size;
+  size_t _released;
+  bool _isOpen;
+#ifdef OS_WIN32
+  std::vector<char> _contents;
+#else
+  int _fd;
+#endif
+
+ private:
+  // a mapping cannot be copied
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_MAPPEDFILE_H
@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "onlinestatistics.h"
+#include "tnt/jama_lu.h"
+using namespace std;
+
+namespace essentia {
+
+void MedianEstimator::add(double x) {
+  // the first 5 values are kept sorted, they are the initial markers
+  if (_count < 5) {
+    int i = _count++;
+    for (; i>0 && _height[i-1] > x; --i) _height[i] = _height[i-1];
+    _height[i] = x;
+
+    if (_count == 5) {
+      for (int k=0; k<5; ++k) _position[k] = k+1;
+      _desired[0] = 1; _desired[1] = 2; _desired[2] = 3; _desired[3] = 4; _desired[4] = 5;
+    }
+    return;
+  }
+
+  // find the cell of x, and extend the extreme markers if needed
+  int k;
+  if (x < _height[0]) {
+    _height[0] = x;
+    k = 0;
+  }
+  else if (x >= _height[4]) {
+    _height[4] = x;
+    k = 3;
+  }
+  else {
+    k = 0;
+    while (x >= _height[k+1]) ++k;
+  }
+
+  ++_count;
+  for (int i=k+1; i<5; ++i) ++_position[i];
+  static const double increment[5] = { 0, 0.25, 0.5, 0.75, 1 };
+  for (int i=0; i<5; ++i) _desired[i] += increment[i];
+
+  // move the middle markers towards their desired positions
+  for (int i=1; i<4; ++i) {
+    double d = _desired[i] - _position[i];
+    if ((d >= 1 && _position[i+1] - _position[i] > 1) ||
+        (d <= -1 && _position[i-1] - _position[i] < -1)) {
+      int s = d > 0 ? 1 : -1;
+      double np = _position[i+1], n = _position[i], nm = _position[i-1];
+
+      // piecewise-parabolic prediction, or linear one if it is not monotonic
+      double h = _height[i] + s / (np - nm) *
+        ((n - nm + s) * (_height[i+1] - _height[i]) / (np - n) +
+         (np - n - s) * (_height[i] - _height[i-1]) / (n - nm));
+
+      if (_height[i-1] < h && h < _height[i+1]) _height[i] = h;
+      else _height[i] += s * (_height[i+s] - _height[i]) / (_position[i+s] - n);
+
+      _position[i] += s;
+    }
+  }
+}
+
+double MedianEstimator::median() const {
+  if (_count == 0) return 0;
+  if (_count >= 5) return _height[2];
+
+  // exact median of the sorted values
+  if (_count % 2 == 0) return (_height[_count/2 - 1] + _height[_count/2]) / 2;
+  return _height[_count/2];
+}
+
+
+void OnlineStatistics::Moments::clear(int dimension) {
+  _count = 0;
+  _mean.assign(dimension, 0.0);
+  _m2.assign(dimension, 0.0);
+}
+
+void OnlineStatistics::Moments::add(const double* x) {
+  ++_count;
+  for (int i=0; i<int(_mean.size()); ++i) {
+    double delta = x[i] - _mean[i];
+    _mean[i] += delta / _count;
+    _m2[i] += delta * (x[i] - _mean[i]);
+  }
+}
+
+vector<Real> OnlineStatistics::Moments::mean() const {
+  return vector<Real>(_mean.begin(), _mean.end());
+}
+
+vector<Real> OnlineStatistics::Moments::variance() const {
+  vector<Real> result(_m2.size(), 0.0);
+  if (_count == 0) return result;
+  for (int i=0; i<int(_m2.size()); ++i) result[i] = _m2[i] / _count;
+  return result;
+}
+
+
+void OnlineStatistics::clear(int dimension, bool covariance) {
+  _dimension = dimension;
+  _count = 0;
+  _hasCovariance = covariance;
+
+  _mean.assign(dimension, 0.0);
+  _m2.assign(dimension, 0.0);
+  _m3.assign(dimension, 0.0);
+  _m4.assign(dimension, 0.0);
+  _comoment.assign(covariance ? dimension*dimension : 0, 0.0);
+  _min.assign(dimension, 0.0);
+  _max.assign(dimension, 0.0);
+  _median.assign(dimension, MedianEstimator());
+
+  _last.assign(dimension, 0.0);
+  _lastDerivative.assign(dimension, 0.0);
+  _delta.assign(dimension, 0.0);
+  _derivative.clear(dimension);
+  _derivative2.clear(dimension);
+}
+
+void OnlineStatistics::add(const vector<Real>& frame) {
+  if (int(frame.size()) != _dimension) {
+    throw EssentiaException("OnlineStatistics: the size of the frame is ", frame.size(),
+                            " instead of ", _dimension);
+  }
+  if (_dimension > 0) add(&frame[0]);
+  else ++_count;
+}
+
+void OnlineStatistics::add(const Real* frame) {
+  const int dim = _dimension;
+
+  // derivatives, their absolute values are aggregated as in the PoolAggregator
+  if (_count > 0) {
+    for (int i=0; i<dim; ++i) {
+      double derivative = double(frame[i]) - _last[i];
+      _delta[i] = derivative - _lastDerivative[i];
+      _lastDerivative[i] = derivative;
+    }
+    if (_count > 1) {
+      for (int i=0; i<dim; ++i) _delta[i] = fabs(_delta[i]);
+      _derivative2.add(&_delta[0]);
+    }
+    for (int i=0; i<dim; ++i) _delta[i] = fabs(_lastDerivative[i]);
+    _derivative.add(&_delta[0]);
+  }
+
+  // central moments
+  const double n1 = _count;
+  const double n = ++_count;
+  for (int i=0; i<dim; ++i) {
+    const double x = frame[i];
+    const double delta = x - _mean[i];
+    const double deltaN = delta / n;
+    const double deltaN2 = deltaN * deltaN;
+    const double term = delta * deltaN * n1;
+
+    _delta[i] = delta;
+    _mean[i] += deltaN;
+    _m4[i] += term * deltaN2 * (n*n - 3*n + 3) + 6 * deltaN2 * _m2[i] - 4 * deltaN * _m3[i];
+    _m3[i] += term * deltaN * (n - 2) - 3 * deltaN * _m2[i];
+    _m2[i] += term;
+  }
+
+  if (_hasCovariance) {
+    for (int i=0; i<dim; ++i) {
+      double* row = &_comoment[i*dim];
+      for (int j=0; j<=i; ++j) row[j] += _delta[i] * (frame[j] - _mean[j]);
+    }
+  }
+
+  for (int i=0; i<dim; ++i) {
+    if (n1 == 0 || frame[i] < _min[i]) _min[i] = frame[i];
+    if (n1 == 0 || frame[i] > _max[i]) _max[i] = frame[i];
+    _median[i].add(frame[i]);
+    _last[i] = frame[i];
+  }
+}
+
+vector<Real> OnlineStatistics::mean() const {
+  return vector<Real>(_mean.begin(), _mean.end());
+}
+
+vector<Real> OnlineStatistics::variance() const {
+  vector<Real> result(_dimension, 0.0);
+  if (_count == 0) return result;
+  for (int i=0; i<_dimension; ++i) result[i] = _m2[i] / _count;
+  return result;
+}
+
+vector<Real> OnlineStatistics::stdev() const {
+  vector<Real> result = variance();
+  for (int i=0; i<_dimension; ++i) result[i] = sqrt(result[i]);
+  return result;
+}
+
+vector<Real> OnlineStatistics::skewness() const {
+  vector<Real> result(_dimension, 0.0);
+  for (int i=0; i<_dimension; ++i) {
+    result[i] = (_m3[i] / _count) / pow(_m2[i] / _count, 1.5);
+  }
+  return result;
+}
+
+vector<Real> OnlineStatistics::kurtosis() const {
+  vector<Real> result(_dimension, 0.0);
+  for (int i=0; i<_dimension; ++i) {
+    result[i] = _count * _m4[i] / (_m2[i] * _m2[i]) - 3;
+  }
+  return result;
+}
+
+vector<Real> OnlineStatistics::median() const {
+  vector<Real> result(_dimension, 0.0);
+  for (int i=0; i<_dimension; ++i) result[i] = _median[i].median();
+  return result;
+}
+
+TNT::Array2D<Real> OnlineStatistics::covariance() const {
+  if (!_hasCovariance) {
+    throw EssentiaException("OnlineStatistics: the covariance has not been accumulated");
+  }
+  if (_count < 2) {
+    throw EssentiaException("OnlineStatistics: cannot compute the covariance of less than 2 frames");
+  }
+
+  TNT::Array2D<Real> cov(_dimension, _dimension);
+  for (int i=0; i<_dimension; ++i) {
+    for (int j=0; j<=i; ++j) {
+      cov[i][j] = cov[j][i] = _comoment[i*_dimension + j] / (_count - 1);
+    }
+  }
+  return cov;
+}
+
+TNT::Array2D<Real> OnlineStatistics::inverseCovariance() const {
+  TNT::Array2D<Real> cov = covariance();
+
+  // the inverse is computed in double precision, as in the SingleGaussian
+  TNT::Array2D<double> covDouble(_dimension, _dimension);
+  for (int i=0; i<_dimension; ++i) {
+    for (int j=0; j<_dimension; ++j) covDouble[i][j] = cov[i][j];
+  }
+
+  JAMA::LU<double> solver(covDouble);
+  if (!solver.isNonsingular()) {
+    throw EssentiaException("OnlineStatistics: cannot invert the covariance matrix because it is singular");
+  }
+
+  TNT::Array2D<double> identity(_dimension, _dimension, 0.0);
+  for (int i=0; i<_dimension; ++i) identity[i][i] = 1.0;
+  TNT::Array2D<double> inverseDouble = solver.solve(identity);
+
+  TNT::Array2D<Real> inverse(_dimension, _dimension);
+  for (int i=0; i<_dimension; ++i) {
+    for (int j=0; j<_dimension; ++j) inverse[i][j] = inverseDouble[i][j];
+  }
+  return inverse;
+}
+
+} // namespace essentia
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_ONLINESTATISTICS_H
+#define ESSENTIA_ONLINESTATISTICS_H
+
+#include <vector>
+#include "types.h"
+#include "tnt/tnt.h"
+
+namespace essentia {
+
+/**
+ * Estimates the median of a sequence of values without storing them, using
+ * the P-square algorithm (R. Jain and I. Chlamtac, "The P2 algorithm for
+ * dynamic calculation of quantiles and histograms without storing
+ * observations", Communications of the ACM, 1985). The result is exact as
+ * long as no more than 5 values have been added.
+ */
+class MedianEstimator {
+
+ public:
+  MedianEstimator() : _count(0) {}
+
+  void clear() { _count = 0; }
+  void add(double x);
+
+  // the median of the values added so far (0 if there is none)
+  double median() const;
+
+ protected:
+  int _count;
+  double _height[5];   // the heights of the markers
+  int _position[5];    // their actual positions, from 1 to _count
+  double _desired[5];  // their desired positions
+};
+
+
+/**
+ * Accumulates the statistics of a sequence of frames of the same size, one
+ * frame at a time, using a constant amount of memory: running mean,
+ * variance, skewness and kurtosis (single pass update of the central
+ * moments as in P. Pébay, "Formulas for robust, one-pass parallel
+ * computation of covariances and arbitrary-order statistical moments",
+ * Sandia report, 2008), minimum and maximum, mean and variance of the
+ * absolute values of the first and second derivatives, and an estimation of
+ * the median. The covariance matrix is only accumulated if asked for, as it
+ * takes O(dimension^2) memory and time per frame.
+ *
+ * All the statistics are the same as the ones computed by the PoolAggregator
+ * on the whole sequence, except for the median which is an estimation.
+ */
+class OnlineStatistics {
+
+ public:
+  OnlineStatistics(int dimension = 0, bool covariance = false) {
+    clear(dimension, covariance);
+  }
+
+  /**
+   * Removes all the frames and sets the size of the next frames.
+   */
+  void clear(int dimension, bool covariance = false);
+
+  void add(const Real* frame);
+  void add(const std::vector<Real>& frame);
+  void add(Real value) { add(&value); }
+
+  // the number of frames added so far
+  int size() const { return _count; }
+  int dimension() const { return _dimension; }
+  bool hasCovariance() const { return _hasCovariance; }
+
+  // the last frame which has been added
+  const std::vector<Real>& last() const { return _last; }
+
+  // all the following statistics are undefined if no frame has been added
+  std::vector<Real> mean() const;
+  std::vector<Real> variance() const;
+  std::vector<Real> stdev() const;
+  std::vector<Real> skewness() const;
+  std::vector<Real> kurtosis() const;
+  const std::vector<Real>& min() const { return _min; }
+  const std::vector<Real>& max() const { return _max; }
+  std::vector<Real> median() const;
+
+  // these are 0 when there are less than 2 (resp. 3) frames
+  std::vector<Real> dmean() const { return _derivative.mean(); }
+  std::vector<Real> dvar() const { return _derivative.variance(); }
+  std::vector<Real> dmean2() const { return _derivative2.mean(); }
+  std::vector<Real> dvar2() const { return _derivative2.variance(); }
+
+  /**
+   * Returns the unbiased covariance matrix, as the SingleGaussian does. It
+   * needs at least 2 frames, and throws an EssentiaException if it has not
+   * been asked for when clearing.
+   */
+  TNT::Array2D<Real> covariance() const;
+
+  /**
+   * Returns the inverse of the covariance matrix, or throws an
+   * EssentiaException if it is singular.
+   */
+  TNT::Array2D<Real> inverseCovariance() const;
+
+ protected:
+  // running mean and variance, used for the derivatives
+  class Moments {
+   public:
+    void clear(int dimension);
+    void add(const double* x);
+    std::vector<Real> mean() const;
+    std::vector<Real> variance() const;
+
+   protected:
+    int _count;
+    std::vector<double> _mean;
+    std::vector<double> _m2;
+  };
+
+  int _dimension;
+  int _count;
+  bool _hasCovariance;
+
+  std::vector<double> _mean;
+  std::vector<double> _m2, _m3, _m4; // sums of the powers of the deviations
+  std::vector<double> _comoment;     // dimension x dimension, row-major
+  std::vector<Real> _min, _max;
+  std::vector<MedianEstimator> _median;
+
+  // the derivatives need the previous frame and the previous first derivative
+  std::vector<Real> _last;
+  std::vector<double> _lastDerivative;
+  std::vector<double> _delta;
+  Moments _derivative, _derivative2;
+};
+
+} // namespace essentia
+
+#endif // ESSENTIA_ONLINESTATISTICS_H
@@ -0,0 +1,553 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "poolbinary.h"
+#include "mappedfile.h"
+#include "essentia.h"
+#include <climits>
+#include <cstring>
+#include <fstream>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+namespace essentia {
+
+namespace {
+
+const char POOL_BINARY_MAGIC[8] = { 'E', 'S', 'S', 'P', 'O', 'O', 'L', '\0' };
+const uint32 POOL_BINARY_VERSION = 1;
+const size_t POOL_BINARY_HEADER_SIZE = 32;
+
+// maximum ratio between the uncompressed and compressed sizes of a zlib stream
+const uint64 ZLIB_MAX_EXPANSION = 1032;
+
+enum PoolBinaryCompression {
+  POOL_BINARY_UNCOMPRESSED = 0,
+  POOL_BINARY_ZLIB = 1
+};
+
+struct Column {
+  string name;
+  uint32 type;
+  uint32 compression;
+  uint64 count;
+  uint64 offset;
+  uint64 storedSize;
+  uint64 size;
+};
+
+// the values are copied as they are in memory, so that the format is only
+// little-endian on little-endian hosts
+void checkEndianness() {
+  const uint32 one = 1;
+  if (*(const char*)&one != 1) {
+    throw EssentiaException("Pool binary format: only little-endian hosts are supported");
+  }
+}
+
+size_t align8(size_t size) {
+  return (size + 7) & ~size_t(7);
+}
+
+
+// writing
+
+void append(vector<char>& block, const void* data, size_t size) {
+  if (size == 0) return;
+  const char* bytes = (const char*)data;
+  block.insert(block.end(), bytes, bytes + size);
+}
+
+void appendUInt32(vector<char>& block, uint32 value) {
+  append(block, &value, sizeof(value));
+}
+
+void appendUInt64(vector<char>& block, uint64 value) {
+  append(block, &value, sizeof(value));
+}
+
+void appendReals(vector<char>& block, const Real* values, size_t n) {
+  // Real is a 32-bit float
+  append(block, values, n*sizeof(Real));
+}
+
+void appendStrings(vector<char>& block, const vector<string>& strings) {
+  uint64 offset = 0;
+  appendUInt64(block, offset);
+  for (int i=0; i<int(strings.size()); ++i) {
+    offset += strings[i].size();
+    appendUInt64(block, offset);
+  }
+  for (int i=0; i<int(strings.size()); ++i) {
+    append(block, strings[i].data(), strings[i].size());
+  }
+}
+
+void encode(const vector<Real>& values, vector<char>& block) {
+  appendReals(block, values.empty() ? 0 : &values[0], values.size());
+}
+
+void encode(const vector<StereoSample>& values, vector<char>& block) {
+  for (int i=0; i<int(values.size()); ++i) {
+    appendReals(block, &values[i].left(), 1);
+    appendReals(block, &values[i].right(), 1);
+  }
+}
+
+void encode(const vector<vector<Real> >& values, vector<char>& block) {
+  uint64 offset = 0;
+  appendUInt64(block, offset);
+  for (int i=0; i<int(values.size()); ++i) {
+    offset += values[i].size();
+    appendUInt64(block, offset);
+  }
+  for (int i=0; i<int(values.size()); ++i) encode(values[i], block);
+}
+
+void encode(const vector<string>& values, vector<char>& block) {
+  appendStrings(block, values);
+}
+
+void encode(const vector<vector<string> >& values, vector<char>& block) {
+  uint64 offset = 0;
+  vector<string> strings;
+  appendUInt64(block, offset);
+  for (int i=0; i<int(values.size()); ++i) {
+    offset += values[i].size();
+    appendUInt64(block, offset);
+    strings.insert(strings.end(), values[i].begin(), values[i].end());
+  }
+  appendStrings(block, strings);
+}
+
+void encode(const vector<TNT::Array2D<Real> >& values, vector<char>& block) {
+  for (int i=0; i<int(values.size()); ++i) {
+    appendUInt64(block, values[i].dim1());
+    appendUInt64(block, values[i].dim2());
+  }
+  for (int i=0; i<int(values.size()); ++i) {
+    // the rows of an Array2D are contiguous
+    if (values[i].dim1() > 0 && values[i].dim2() > 0) {
+      appendReals(block, &values[i][0][0], values[i].dim1() * values[i].dim2());
+    }
+  }
+}
+
+class PoolBinaryWriter {
+ public:
+  PoolBinaryWriter(const string& filename, bool compress)
+    : _filename(filename), _compress(compress), _out(filename.c_str(), ios::out | ios::binary) {
+    if (!_out.good()) {
+      throw EssentiaException("Pool binary format: could not open file \"", filename, "\" for writing");
+    }
+    // the header is written at the end, once the directory has been written
+    _out.write(string(POOL_BINARY_HEADER_SIZE, '\0').data(), POOL_BINARY_HEADER_SIZE);
+    _position = POOL_BINARY_HEADER_SIZE;
+  }
+
+  template <typename T>
+  void writeColumns(const map<string, vector<T> >& columns, PoolBinaryType type) {
+    for (typename map<string, vector<T> >::const_iterator it = columns.begin(); it != columns.end(); ++it) {
+      _block.clear();
+      encode(it->second, _block);
+      writeColumn(it->first, type, it->second.size());
+    }
+  }
+
+  template <typename T>
+  void writeSingleColumns(const map<string, T>& columns, PoolBinaryType type) {
+    vector<T> values(1);
+    for (typename map<string, T>::const_iterator it = columns.begin(); it != columns.end(); ++it) {
+      values[0] = it->second;
+      _block.clear();
+      encode(values, _block);
+      writeColumn(it->first, type, 1);
+    }
+  }
+
+  void writeSingleColumn(const string& name, const string& value) {
+    map<string, string> column;
+    column[name] = value;
+    writeSingleColumns(column, POOL_BINARY_SINGLE_STRING);
+  }
+
+  void finish() {
+    vector<char> directory;
+    for (int i=0; i<int(_columns.size()); ++i) {
+      const Column& column = _columns[i];
+      appendUInt32(directory, column.type);
+      appendUInt32(directory, column.compression);
+      appendUInt64(directory, column.count);
+      appendUInt64(directory, column.offset);
+      appendUInt64(directory, column.storedSize);
+      appendUInt64(directory, column.size);
+      appendUInt32(directory, column.name.size());
+      append(directory, column.name.data(), column.name.size());
+      directory.resize(align8(directory.size()), '\0');
+    }
+
+    uint64 directoryOffset = _position;
+    if (!directory.empty()) _out.write(&directory[0], directory.size());
+
+    vector<char> header;
+    append(header, POOL_BINARY_MAGIC, sizeof(POOL_BINARY_MAGIC));
+    appendUInt32(header, POOL_BINARY_VERSION);
+    appendUInt32(header, _columns.size());
+    appendUInt64(header, directoryOffset);
+    appendUInt64(header, 0);
+
+    _out.seekp(0);
+    _out.write(&header[0], header.size());
+    _out.close();
+
+    if (_out.fail()) {
+      throw EssentiaException("Pool binary format: an error occured while writing file \"", _filename, "\"");
+    }
+  }
+
+ protected:
+  string _filename;
+  bool _compress;
+  ofstream _out;
+  uint64 _position;
+  vector<char> _block;
+  vector<char> _compressed;
+  vector<Column> _columns;
+
+  void writeColumn(const string& name, PoolBinaryType type, size_t count) {
+    Column column;
+    column.name = name;
+    column.type = type;
+    column.compression = POOL_BINARY_UNCOMPRESSED;
+    column.count = count;
+    column.offset = _position;
+    column.size = _block.size();
+
+    const vector<char>* data = &_block;
+
+#ifdef HAVE_ZLIB
+    if (_compress && !_block.empty()) {
+      uLongf compressedSize = compressBound(_block.size());
+      _compressed.resize(compressedSize);
+      if (compress2((Bytef*)&_compressed[0], &compressedSize,
+                    (const Bytef*)&_block[0], _block.size(), Z_DEFAULT_COMPRESSION) != Z_OK) {
+        throw EssentiaException("Pool binary format: could not compress descriptor ", name);
+      }
+      // incompressible blocks are stored as they are
+      if (compressedSize < _block.size()) {
+        _compressed.resize(compressedSize);
+        column.compression = POOL_BINARY_ZLIB;
+        data = &_compressed;
+      }
+    }
+#endif
+
+    column.storedSize = data->size();
+    size_t padding = align8(data->size()) - data->size();
+    if (!data->empty()) _out.write(&(*data)[0], data->size());
+    _out.write("\0\0\0\0\0\0\0", padding);
+    _position += data->size() + padding;
+
+    _columns.push_back(column);
+  }
+};
+
+
+// reading
+
+class BlockReader {
+ public:
+  BlockReader(const char* data, uint64 size, const string& name)
+    : _data(data), _size(size), _position(0), _name(name) {}
+
+  // checks that there are at least n elements of the given size left, before
+  // allocating memory for them
+  void require(uint64 n, uint64 elementSize) {
+    if (n > (_size - _position) / elementSize) {
+      throw EssentiaException("Pool binary format: the data of descriptor ", _name, " is truncated");
+    }
+  }
+
+  const char* read(uint64 size) {
+    require(size, 1);
+    const char* data = _data + _position;
+    _position += size;
+    return data;
+  }
+
+  uint32 readUInt32() {
+    uint32 value;
+    memcpy(&value, read(sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  uint64 readUInt64() {
+    uint64 value;
+    memcpy(&value, read(sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  // reads n+1 offsets, which should start at zero and be increasing
+  void readOffsets(uint64 n, vector<uint64>& offsets) {
+    require(n, sizeof(uint64));
+    offsets.resize(n+1);
+    for (uint64 i=0; i<=n; ++i) {
+      offsets[i] = readUInt64();
+      if ((i == 0 && offsets[i] != 0) || (i > 0 && offsets[i] < offsets[i-1])) {
+        throw EssentiaException("Pool binary format: invalid offsets in descriptor ", _name);
+      }
+    }
+  }
+
+  void readReals(Real* values, uint64 n) {
+    if (n > 0) memcpy(values, read(n*sizeof(Real)), n*sizeof(Real));
+  }
+
+  const string& name() const { return _name; }
+
+  void readStrings(uint64 n, vector<string>& strings) {
+    vector<uint64> offsets;
+    readOffsets(n, offsets);
+    const char* chars = read(offsets[n]);
+    strings.resize(n);
+    for (uint64 i=0; i<n; ++i) {
+      strings[i].assign(chars + offsets[i], offsets[i+1] - offsets[i]);
+    }
+  }
+
+ protected:
+  const char* _data;
+  uint64 _size;
+  uint64 _position;
+  string _name;
+};
+
+void decode(BlockReader& block, uint64 n, vector<Real>& values) {
+  block.require(n, sizeof(Real));
+  values.resize(n);
+  block.readReals(values.empty() ? 0 : &values[0], n);
+}
+
+void decode(BlockReader& block, uint64 n, vector<StereoSample>& values) {
+  block.require(n, 2*sizeof(Real));
+  vector<Real> interleaved;
+  decode(block, 2*n, interleaved);
+  values.resize(n);
+  for (uint64 i=0; i<n; ++i) {
+    values[i].left() = interleaved[2*i];
+    values[i].right() = interleaved[2*i+1];
+  }
+}
+
+void decode(BlockReader& block, uint64 n, vector<vector<Real> >& values) {
+  vector<uint64> offsets;
+  block.readOffsets(n, offsets);
+  values.resize(n);
+  for (uint64 i=0; i<n; ++i) decode(block, offsets[i+1] - offsets[i], values[i]);
+}
+
+void decode(BlockReader& block, uint64 n, vector<string>& values) {
+  block.readStrings(n, values);
+}
+
+void decode(BlockReader& block, uint64 n, vector<vector<string> >& values) {
+  vector<uint64> offsets;
+  block.readOffsets(n, offsets);
+  vector<string> strings;
+  block.readStrings(offsets[n], strings);
+  values.resize(n);
+  for (uint64 i=0; i<n; ++i) {
+    values[i].assign(strings.begin() + offsets[i], strings.begin() + offsets[i+1]);
+  }
+}
+
+void decode(BlockReader& block, uint64 n, vector<TNT::Array2D<Real> >& values) {
+  block.require(n, 2*sizeof(uint64));
+  vector<uint64> dims(2*n);
+  for (uint64 i=0; i<2*n; ++i) dims[i] = block.readUInt64();
+  values.resize(n);
+  for (uint64 i=0; i<n; ++i) {
+    uint64 rows = dims[2*i];
+    uint64 cols = dims[2*i+1];
+    // also makes sure that rows*sizeof(Real) and rows*cols do not overflow
+    if (rows > uint64(INT_MAX) || cols > uint64(INT_MAX)) {
+      throw EssentiaException("Pool binary format: invalid matrix dimensions in descriptor ", block.name());
+    }
+    if (rows > 0) block.require(cols, rows*sizeof(Real));
+    values[i] = TNT::Array2D<Real>(int(rows), int(cols));
+    if (rows > 0 && cols > 0) {
+      block.readReals(&values[i][0][0], rows * cols);
+    }
+  }
+}
+
+template <typename T>
+void readColumn(BlockReader& block, const Column& column, Pool& pool) {
+  vector<T> values;
+  decode(block, column.count, values);
+  pool.merge(column.name, values);
+}
+
+template <typename T>
+void readSingleColumn(BlockReader& block, const Column& column, Pool& pool) {
+  if (column.count != 1) {
+    throw EssentiaException("Pool binary format: single value descriptor ", column.name, " does not have one value");
+  }
+  vector<T> values;
+  decode(block, 1, values);
+  pool.set(column.name, values[0]);
+}
+
+} // namespace
+
+
+bool poolBinaryCompressionAvailable() {
+#ifdef HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+void writePoolBinary(const Pool& pool, const string& filename, bool compress, bool writeVersion) {
+  checkEndianness();
+  if (compress && !poolBinaryCompressionAvailable()) {
+    throw EssentiaException("Pool binary format: compression is not available, Essentia has been compiled without zlib");
+  }
+
+  PoolBinaryWriter writer(filename, compress);
+
+  writer.writeColumns(pool.getRealPool(), POOL_BINARY_REAL);
+  writer.writeColumns(pool.getVectorRealPool(), POOL_BINARY_VECTOR_REAL);
+  writer.writeColumns(pool.getStringPool(), POOL_BINARY_STRING);
+  writer.writeColumns(pool.getVectorStringPool(), POOL_BINARY_VECTOR_STRING);
+  writer.writeColumns(pool.getArray2DRealPool(), POOL_BINARY_ARRAY2D_REAL);
+  writer.writeColumns(pool.getStereoSamplePool(), POOL_BINARY_STEREO_SAMPLE);
+  writer.writeSingleColumns(pool.getSingleRealPool(), POOL_BINARY_SINGLE_REAL);
+  writer.writeSingleColumns(pool.getSingleStringPool(), POOL_BINARY_SINGLE_STRING);
+  writer.writeSingleColumns(pool.getSingleVectorRealPool(), POOL_BINARY_SINGLE_VECTOR_REAL);
+
+  if (writeVersion && !pool.contains<string>("metadata.version.essentia")) {
+    writer.writeSingleColumn("metadata.version.essentia", version);
+  }
+
+  writer.finish();
+}
+
+void readPoolBinary(const string& filename, Pool& pool) {
+  checkEndianness();
+
+  MappedFile file;
+  file.open(filename);
+
+  const char* data = file.data();
+  uint64 fileSize = file.size();
+
+  if (fileSize < POOL_BINARY_HEADER_SIZE || memcmp(data, POOL_BINARY_MAGIC, sizeof(POOL_BINARY_MAGIC)) != 0) {
+    throw EssentiaException("Pool binary format: \"", filename, "\" is not a binary pool file");
+  }
+
+  BlockReader header(data, POOL_BINARY_HEADER_SIZE, "header");
+  header.read(sizeof(POOL_BINARY_MAGIC));
+  uint32 version = header.readUInt32();
+  uint32 nColumns = header.readUInt32();
+  uint64 directoryOffset = header.readUInt64();
+
+  if (version != POOL_BINARY_VERSION) {
+    throw EssentiaException("Pool binary format: unsupported version ", version, " in file ", filename);
+  }
+  if (directoryOffset > fileSize) {
+    throw EssentiaException("Pool binary format: the file \"", filename, "\" is truncated");
+  }
+
+  // read the directory first, so that the whole file is known to be valid
+  BlockReader directory(data + directoryOffset, fileSize - directoryOffset, "directory");
+  directory.require(nColumns, 48);
+  vector<Column> columns(nColumns);
+  for (uint32 i=0; i<nColumns; ++i) {
+    Column& column = columns[i];
+    column.type = directory.readUInt32();
+    column.compression = directory.readUInt32();
+    column.count = directory.readUInt64();
+    column.offset = directory.readUInt64();
+    column.storedSize = directory.readUInt64();
+    column.size = directory.readUInt64();
+    uint32 nameSize = directory.readUInt32();
+    column.name.assign(directory.read(nameSize), nameSize);
+    directory.read(align8(sizeof(uint32) + nameSize) - sizeof(uint32) - nameSize);
+
+    if (column.offset > directoryOffset || column.storedSize > directoryOffset - column.offset) {
+      throw EssentiaException("Pool binary format: the data of descriptor ", column.name, " is outside of the file");
+    }
+  }
+
+  vector<char> uncompressed;
+
+  for (uint32 i=0; i<nColumns; ++i) {
+    const Column& column = columns[i];
+    const char* block = data + column.offset;
+    uint64 blockSize = column.storedSize;
+
+    if (column.compression == POOL_BINARY_ZLIB) {
+#ifdef HAVE_ZLIB
+      // zlib can't expand data by more than this, so a larger size can only
+      // come from a corrupted file and must not be allocated
+      if (column.size / ZLIB_MAX_EXPANSION > column.storedSize) {
+        throw EssentiaException("Pool binary format: invalid uncompressed size for descriptor ", column.name);
+      }
+      uncompressed.resize(column.size);
+      uLongf size = column.size;
+      if (column.size > 0 &&
+          (uncompress((Bytef*)&uncompressed[0], &size, (const Bytef*)block, blockSize) != Z_OK ||
+           size != column.size)) {
+        throw EssentiaException("Pool binary format: could not uncompress descriptor ", column.name);
+      }
+      block = uncompressed.empty() ? 0 : &uncompressed[0];
+      blockSize = column.size;
+#else
+      throw EssentiaException("Pool binary format: descriptor ", column.name, " is compressed, but Essentia has been compiled without zlib");
+#endif
+    }
+    else if (column.compression != POOL_BINARY_UNCOMPRESSED) {
+      throw EssentiaException("Pool binary format: unknown compression for descriptor ", column.name);
+    }
+
+    BlockReader reader(block, blockSize, column.name);
+
+    switch (column.type) {
+    case POOL_BINARY_REAL:               readColumn<Real>(reader, column, pool); break;
+    case POOL_BINARY_VECTOR_REAL:        readColumn<vector<Real> >(reader, column, pool); break;
+    case POOL_BINARY_STRING:             readColumn<string>(reader, column, pool); break;
+    case POOL_BINARY_VECTOR_STRING:      readColumn<vector<string> >(reader, column, pool); break;
+    case POOL_BINARY_ARRAY2D_REAL:       readColumn<TNT::Array2D<Real> >(reader, column, pool); break;
+    case POOL_BINARY_STEREO_SAMPLE:      readColumn<StereoSample>(reader, column, pool); break;
+    case POOL_BINARY_SINGLE_REAL:        readSingleColumn<Real>(reader, column, pool); break;
+    case POOL_BINARY_SINGLE_STRING:      readSingleColumn<string>(reader, column, pool); break;
+    case POOL_BINARY_SINGLE_VECTOR_REAL: readSingleColumn<vector<Real> >(reader, column, pool); break;
+    default:
+      throw EssentiaException("Pool binary format: unknown type for descriptor ", column.name);
+    }
+  }
+}
+
+} // namespace essentia
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_POOLBINARY_H
+#define ESSENTIA_POOLBINARY_H
+
+#include <string>
+#include "pool.h"
+
+namespace essentia {
+
+/**
+ * Binary columnar format for Pools.
+ *
+ * All the integers and floats are little-endian, and the floats are 32-bit
+ * IEEE 754. A file is made of:
+ *  - a header of 32 bytes: the magic string "ESSPOOL" followed by a zero
+ *    byte, the version of the format (uint32, currently 1), the number of
+ *    columns (uint32), the offset of the column directory (uint64) and 8
+ *    reserved bytes;
+ *  - one data block per column (i.e. per descriptor), each one starting at
+ *    an offset which is a multiple of 8;
+ *  - the column directory, which has one entry per column: type (uint32),
+ *    compression (uint32, 0 for none and 1 for zlib), number of values
+ *    (uint64), offset of the block (uint64), size of the block as stored
+ *    (uint64), size of the uncompressed block (uint64), length of the
+ *    descriptor name (uint32) and the name itself, padded with zeros to a
+ *    multiple of 8 bytes.
+ *
+ * The uncompressed block of a column with n values is laid out as follows,
+ * where all the offsets are uint64:
+ *  - Real: n floats;
+ *  - StereoSample: 2n floats, left and right interleaved;
+ *  - vector<Real>: n+1 offsets in the values, followed by the values of all
+ *    the vectors one after the other;
+ *  - string: n+1 offsets in the characters, followed by the characters of
+ *    all the strings;
+ *  - vector<string>: n+1 offsets in the strings, followed by the strings as
+ *    in a string column;
+ *  - Array2D<Real>: 2n dimensions (rows and columns of each matrix),
+ *    followed by the values of all the matrices in row-major order.
+ * Single values are stored as columns of one value, with their own type
+ * codes. As the offsets come first in each block and blocks are aligned on
+ * 8 bytes, the floats of an uncompressed file can be used in place once the
+ * file is mapped in memory.
+ */
+enum PoolBinaryType {
+  POOL_BINARY_REAL = 1,
+  POOL_BINARY_VECTOR_REAL,
+  POOL_BINARY_STRING,
+  POOL_BINARY_VECTOR_STRING,
+  POOL_BINARY_ARRAY2D_REAL,
+  POOL_BINARY_STEREO_SAMPLE,
+  POOL_BINARY_SINGLE_REAL,
+  POOL_BINARY_SINGLE_STRING,
+  POOL_BINARY_SINGLE_VECTOR_REAL
+};
+
+/**
+ * Returns whether the blocks can be compressed, i.e. whether Essentia has
+ * been compiled with zlib.
+ */
+bool poolBinaryCompressionAvailable();
+
+/**
+ * Writes all the descriptors of the pool to the given file. If @e compress
+ * is true, each block is compressed with zlib, unless compressing it does
+ * not make it smaller. If @e writeVersion is true, the version of Essentia
+ * is added as the metadata.version.essentia descriptor, as YamlOutput does.
+ */
+void writePoolBinary(const Pool& pool, const std::string& filename,
+                     bool compress = false, bool writeVersion = false);
+
+/**
+ * Adds all the descriptors stored in the given file to the pool. The file
+ * is mapped in memory, and the values are converted column by column.
+ */
+void readPoolBinary(const std::string& filename, Pool& pool);
+
+} // namespace essentia
+
+#endif // ESSENTIA_POOLBINARY_H
@@ -108,11 +108,19 @@ class RingBufferImpl {
  public:
   int _bufferSize;
 
+  // only used by the thread writing data, resp. reading data
   int _writeIndex;
   int _readIndex;
 
-  Atomic _available;
-  Atomic _space;
+  // number of samples written and read so far, modulo 2^32; each of them is
+  // only incremented by one thread, so that the other one can compute the
+  // number of samples available or the space left without taking any lock
+  Atomic _written;
+  Atomic _read;
+
+  // in overwrite mode, the number of samples written so far including the
+  // ones which are being written, see get()
+  Atomic _writing;
 
   Real* _buffer;
 
@@ -125,13 +133,35 @@ class RingBufferImpl {
     kAvailable, kSpace
   } _waitingCondition;
 
-  RingBufferImpl(WaitingCondition c, int bufferSize)
+  // in real-time mode, nothing ever waits and the waiting thread is not
+  // signaled, so that neither thread takes a lock. When the buffer is full,
+  // the data being added is then either dropped or overwrites the oldest
+  // data which has not been read yet.
+  bool _realTime;
+
+  enum OverflowPolicy
+  {
+    kDrop, kOverwrite
+  } _overflowPolicy;
+
+  // samples which have been dropped or overwritten because the buffer was full
+  Atomic _overruns;
+  // largest number of samples found in the buffer when reading from it
+  Atomic _maxLatency;
+
+  RingBufferImpl(WaitingCondition c, int bufferSize,
+                 bool realTime=false, OverflowPolicy policy=kDrop)
   : _bufferSize(bufferSize)
   , _writeIndex(0)
   , _readIndex(0)
-  , _available(0)
-  , _space(_bufferSize)
+  , _written(0)
+  , _read(0)
+  , _writing(0)
   , _waitingCondition(c)
+  , _realTime(realTime)
+  , _overflowPolicy(policy)
+  , _overruns(0)
+  , _maxLatency(0)
   {
     _buffer = new Real[_bufferSize];
   }
@@ -141,15 +171,27 @@ class RingBufferImpl {
     delete [] _buffer;
   }
 
+  // must not be called while another thread uses the buffer
   void reset() {
     _writeIndex = 0;
     _readIndex = 0;
-    _available = 0;
-    _space = _bufferSize;
-    delete[] _buffer;
-    _buffer = new Real[_bufferSize];
+    _written = 0;
+    _read = 0;
+    _writing = 0;
+    _overruns = 0;
+    _maxLatency = 0;
+  }
+
+  static int distance(int from, int to) {
+    return int(unsigned(to) - unsigned(from));
   }
 
+  // number of samples written but not read yet; in overwrite mode, this can
+  // be more than the size of the buffer until the reader catches up
+  int available() const { return distance(_read, _written); }
+
+  int space() const { return _bufferSize - available(); }
+
   void waitAvailable(void)
   {
     // this function should only be called if the waiting condition
@@ -158,7 +200,7 @@ class RingBufferImpl {
 
     condition.lock();
 
-    while (_available == 0)
+    while (available() == 0)
     {
       condition.wait();
     }
@@ -174,7 +216,7 @@ class RingBufferImpl {
 
     condition.lock();
 
-    while (_space == 0)
+    while (space() == 0)
     {
       condition.wait();
     }
@@ -182,11 +224,8 @@ class RingBufferImpl {
     condition.unlock();
   }
 
-  int add(const Real* inputData, int inputSize)
+  void copyToBuffer(const Real* inputData, int size)
   {
-    int size = _space;
-    if (size > inputSize) size = inputSize;
-
     if (_writeIndex + size > _bufferSize)
     {
       int n = _bufferSize - _writeIndex;
@@ -197,54 +236,123 @@ class RingBufferImpl {
       memcpy( &_buffer[_writeIndex], inputData, size * sizeof(AudioSample));
       _writeIndex += size;
     }
-    _space -=  size;
-    _available += size;
+    if (_writeIndex == _bufferSize) _writeIndex = 0;
+  }
 
-    condition.lock();
-    if (_waitingCondition == kAvailable)
+  void copyFromBuffer(Real* outputData, int size)
+  {
+    if (_readIndex + size > _bufferSize)
+    {
+      int n = _bufferSize - _readIndex;
+      memcpy( outputData, &_buffer[_readIndex], n * sizeof(AudioSample));
+      memcpy( &outputData[n], _buffer, (size - n)*sizeof(AudioSample));
+      _readIndex = (size - n);
+    } else {
+      memcpy( outputData, &_buffer[_readIndex], size * sizeof(AudioSample));
+      _readIndex += size;
+    }
+    if (_readIndex == _bufferSize) _readIndex = 0;
+  }
+
+  // returns the number of samples from inputData which are in the buffer
+  // after the call
+  int add(const Real* inputData, int inputSize)
+  {
+    int size;
+
+    if (_realTime && _overflowPolicy == kOverwrite)
+    {
+      // only the last _bufferSize samples can be kept
+      size = inputSize;
+      if (size > _bufferSize)
+      {
+        _overruns += size - _bufferSize;
+        inputData += size - _bufferSize;
+        size = _bufferSize;
+      }
+
+      // the reader finds out which samples have been overwritten, as the
+      // writer doesn't know which ones have been read
+      _writing += size;
+      copyToBuffer(inputData, size);
+      _written += size;
+    }
+    else
+    {
+      size = space();
+      if (size > inputSize) size = inputSize;
+
+      copyToBuffer(inputData, size);
+      _written += size;
+
+      if (_realTime) _overruns += inputSize - size;
+    }
+
+    if (!_realTime && _waitingCondition == kAvailable)
     {
       // the thread that is using this ringbuffer will be waiting for
       // data to become available - typically the essentia-part from
       // a RingBufferInput. we signal the waiting condition here
+      condition.lock();
       condition.signal();
+      condition.unlock();
     }
-    condition.unlock();
 
     return size;
   }
 
   int get(Real* outputData, int outputSize)
   {
-    int size = _available;
+    int size = available();
+
+    if (size > _bufferSize)
+    {
+      // the writer has overwritten the oldest samples, skip them
+      skip(size - _bufferSize);
+      size = _bufferSize;
+    }
+    if (size > (int)_maxLatency) _maxLatency = size;
     if (size > outputSize) size = outputSize;
 
-    assert(size <= _bufferSize);
-    if (_readIndex + size > _bufferSize)
+    int start = _read;
+    copyFromBuffer(outputData, size);
+
+    if (_realTime && _overflowPolicy == kOverwrite)
     {
-      int n = _bufferSize - _readIndex;
-      memcpy( outputData, &_buffer[_readIndex], n * sizeof(AudioSample));
-      memcpy( &outputData[n], _buffer, (size - n)*sizeof(AudioSample));
-      _readIndex = (size - n);
-    } else {
-      memcpy( outputData, &_buffer[_readIndex], size * sizeof(AudioSample));
-      _readIndex += size;
+      // the samples the writer has started writing over while they were
+      // being copied are not valid, remove them from the output
+      int overwritten = distance(start, _writing) - _bufferSize;
+      if (overwritten > size) overwritten = size;
+      if (overwritten > 0)
+      {
+        memmove(outputData, &outputData[overwritten], (size - overwritten)*sizeof(AudioSample));
+        _overruns += overwritten;
+        _read += overwritten;
+        size -= overwritten;
+      }
     }
-    _available -= size;
-    _space += size;
+    _read += size;
 
-    condition.lock();
-    if (_waitingCondition == kSpace)
+    if (!_realTime && _waitingCondition == kSpace)
     {
       // the thread that is using this ringbuffer will be waiting for
       // space in the buffer - typically the essentia-part from
       // a RingBufferOutput. we signal the waiting condition here
+      condition.lock();
       condition.signal();
+      condition.unlock();
     }
-    condition.unlock();
 
     return size;
   }
 
+  void skip(int size)
+  {
+    _readIndex = (_readIndex + size % _bufferSize) % _bufferSize;
+    _overruns += size;
+    _read += size;
+  }
+
 };
 
 } // namespace streaming
@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+// gcc would otherwise fuse the multiplications and additions into FMA
+// instructions in the AVX-512 kernels, which would then not give the same
+// results as the scalar ones
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include "vectorkernels.h"
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ESSENTIA_X86_KERNELS
+#include <immintrin.h>
+#define TARGET_SSE2   __attribute__((target("sse2")))
+#define TARGET_AVX2   __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+using namespace std;
+
+namespace essentia {
+namespace util {
+
+struct Kernels {
+  void (*multiply)(const Real*, const Real*, Real*, int);
+  void (*squaredMagnitude)(const complex<Real>*, Real*, int);
+  void (*magnitude)(const complex<Real>*, Real*, int);
+  Real (*dot)(const Real*, const Real*, int);
+  Real (*sum)(const Real*, int);
+  Real (*sumSquaredDifferences)(const Real*, Real, int);
+};
+
+
+// scalar versions
+
+static void multiplyScalar(const Real* a, const Real* b, Real* out, int size) {
+  for (int i=0; i<size; i++) out[i] = a[i] * b[i];
+}
+
+static void squaredMagnitudeScalar(const complex<Real>* c, Real* out, int size) {
+  for (int i=0; i<size; i++) {
+    out[i] = c[i].real()*c[i].real() + c[i].imag()*c[i].imag();
+  }
+}
+
+static void magnitudeScalar(const complex<Real>* c, Real* out, int size) {
+  for (int i=0; i<size; i++) {
+    out[i] = sqrt(c[i].real()*c[i].real() + c[i].imag()*c[i].imag());
+  }
+}
+
+static Real dotScalar(const Real* a, const Real* b, int size) {
+  Real result = 0.0;
+  for (int i=0; i<size; i++) result += a[i] * b[i];
+  return result;
+}
+
+static Real sumScalar(const Real* a, int size) {
+  Real result = 0.0;
+  for (int i=0; i<size; i++) result += a[i];
+  return result;
+}
+
+static Real sumSquaredDifferencesScalar(const Real* a, Real m, int size) {
+  Real result = 0.0;
+  for (int i=0; i<size; i++) {
+    Real d = a[i] - m;
+    result += d * d;
+  }
+  return result;
+}
+
+static const Kernels scalarKernels = {
+  multiplyScalar, squaredMagnitudeScalar, magnitudeScalar,
+  dotScalar, sumScalar, sumSquaredDifferencesScalar
+};
+
+
+#ifdef ESSENTIA_X86_KERNELS
+
+// SSE2 versions, 4 values at a time
+
+static inline TARGET_SSE2 Real horizontalSum(__m128 v) {
+  __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+// deinterleaves 4 complex values into their squared magnitude
+static inline TARGET_SSE2 __m128 squaredMagnitude4(const Real* c) {
+  __m128 v0 = _mm_loadu_ps(c);
+  __m128 v1 = _mm_loadu_ps(c + 4);
+  __m128 re = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+  __m128 im = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+  return _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+}
+
+static TARGET_SSE2 void multiplySSE2(const Real* a, const Real* b, Real* out, int size) {
+  int i = 0;
+  for (; i+4<=size; i+=4) {
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  for (; i<size; i++) out[i] = a[i] * b[i];
+}
+
+static TARGET_SSE2 void squaredMagnitudeSSE2(const complex<Real>* c, Real* out, int size) {
+  const Real* p = (const Real*)c;
+  int i = 0;
+  for (; i+4<=size; i+=4) {
+    _mm_storeu_ps(out + i, squaredMagnitude4(p + 2*i));
+  }
+  for (; i<size; i++) out[i] = c[i].real()*c[i].real() + c[i].imag()*c[i].imag();
+}
+
+static TARGET_SSE2 void magnitudeSSE2(const complex<Real>* c, Real* out, int size) {
+  const Real* p = (const Real*)c;
+  int i = 0;
+  for (; i+4<=size; i+=4) {
+    _mm_storeu_ps(out + i, _mm_sqrt_ps(squaredMagnitude4(p + 2*i)));
+  }
+  for (; i<size; i++) out[i] = sqrt(c[i].real()*c[i].real() + c[i].imag()*c[i].imag());
+}
+
+static TARGET_SSE2 Real dotSSE2(const Real* a, const Real* b, int size) {
+  __m128 acc = _mm_setzero_ps();
+  int i = 0;
+  for (; i+4<=size; i+=4) {
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  Real result = horizontalSum(acc);
+  for (; i<size; i++) result += a[i] * b[i];
+  return result;
+}
+
+static TARGET_SSE2 Real sumSSE2(const Real* a, int size) {
+  __m128 acc = _mm_setzero_ps();
+  int i = 0;
+  for (; i+4<=size; i+=4) acc = _mm_add_ps(acc, _mm_loadu_ps(a + i));
+  Real result = horizontalSum(acc);
+  for (; i<size; i++) result += a[i];
+  return result;
+}
+
+static TARGET_SSE2 Real sumSquaredDifferencesSSE2(const Real* a, Real m, int size) {
+  __m128 acc = _mm_setzero_ps();
+  __m128 vm = _mm_set1_ps(m);
+  int i = 0;
+  for (; i+4<=size; i+=4) {
+    __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), vm);
+    acc = _mm_add_ps(acc, _mm_mul_ps(d, d));
+  }
+  Real result = horizontalSum(acc);
+  for (; i<size; i++) {
+    Real d = a[i] - m;
+    result += d * d;
+  }
+  return result;
+}
+
+static const Kernels sse2Kernels = {
+  multiplySSE2, squaredMagnitudeSSE2, magnitudeSSE2,
+  dotSSE2, sumSSE2, sumSquaredDifferencesSSE2
+};
+
+
+// AVX2 versions, 8 values at a time
+
+static inline TARGET_AVX2 Real horizontalSum(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+static inline TARGET_AVX2 __m256 squaredMagnitude8(const Real* c) {
+  __m256 v0 = _mm256_loadu_ps(c);
+  __m256 v1 = _mm256_loadu_ps(c + 8);
+  // the shuffles work within 128-bit lanes, the permutation puts the values
+  // back in order
+  __m256 re = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+  __m256 im = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+  re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(re), _MM_SHUFFLE(3, 1, 2, 0)));
+  im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(im), _MM_SHUFFLE(3, 1, 2, 0)));
+  return _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im));
+}
+
+static TARGET_AVX2 void multiplyAVX2(const Real* a, const Real* b, Real* out, int size) {
+  int i = 0;
+  for (; i+8<=size; i+=8) {
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  }
+  for (; i<size; i++) out[i] = a[i] * b[i];
+}
+
+static TARGET_AVX2 void squaredMagnitudeAVX2(const complex<Real>* c, Real* out, int size) {
+  const Real* p = (const Real*)c;
+  int i = 0;
+  for (; i+8<=size; i+=8) {
+    _mm256_storeu_ps(out + i, squaredMagnitude8(p + 2*i));
+  }
+  for (; i<size; i++) out[i] = c[i].real()*c[i].real() + c[i].imag()*c[i].imag();
+}
+
+static TARGET_AVX2 void magnitudeAVX2(const complex<Real>* c, Real* out, int size) {
+  const Real* p = (const Real*)c;
+  int i = 0;
+  for (; i+8<=size; i+=8) {
+    _mm256_storeu_ps(out + i, _mm256_sqrt_ps(squaredMagnitude8(p + 2*i)));
+  }
+  for (; i<size; i++) out[i] = sqrt(c[i].real()*c[i].real() + c[i].imag()*c[i].imag());
+}
+
+static TARGET_AVX2 Real dotAVX2(const Real* a, const Real* b, int size) {
+  __m256 acc = _mm256_setzero_ps();
+  int i = 0;
+  for (; i+8<=size; i+=8) {
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  }
+  Real result = horizontalSum(acc);
+  for (; i<size; i++) result += a[i] * b[i];
+  return result;
+}
+
+static TARGET_AVX2 Real sumAVX2(const Real* a, int size) {
+  __m256 acc = _mm256_setzero_ps();
+  int i = 0;
+  for (; i+8<=size; i+=8) acc = _mm256_add_ps(acc, _mm256_loadu_ps(a + i));
+  Real result = horizontalSum(acc);
+  for (; i<size; i++) result += a[i];
+  return result;
+}
+
+static TARGET_AVX2 Real sumSquaredDifferencesAVX2(const Real* a, Real m, int size) {
+  __m256 acc = _mm256_setzero_ps();
+  __m256 vm = _mm256_set1_ps(m);
+  int i = 0;
+  for (; i+8<=size; i+=8) {
+    __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), vm);
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(d, d));
+  }
+  Real result = horizontalSum(acc);
+  for (; i<size; i++) {
+    Real d = a[i] - m;
+    result += d * d;
+  }
+  return result;
+}
+
+static const Kernels avx2Kernels = {
+  multiplyAVX2, squaredMagnitudeAVX2, magnitudeAVX2,
+  dotAVX2, sumAVX2, sumSquaredDifferencesAVX2
+};
+
+
+// AVX-512 versions, 16 values at a time. The remaining values are processed
+// using masked loads and stores.
+
+static inline TARGET_AVX512 __mmask16 tailMask(int n) {
+  return (__mmask16)((1u << n) - 1);
+}
+
+static inline TARGET_AVX512 __m512 squaredMagnitude16(__m512 v0, __m512 v1) {
+  const __m512i even = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+  const __m512i odd  = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1);
+  __m512 re = _mm512_permutex2var_ps(v0, even, v1);
+  __m512 im = _mm512_permutex2var_ps(v0, odd, v1);
+  return _mm512_add_ps(_mm512_mul_ps(re, re), _mm512_mul_ps(im, im));
+}
+
+// loads the complex values i to i+n-1 (n <= 16), as 2 vectors
+static inline TARGET_AVX512 __m512 squaredMagnitude16(const Real* c, int n) {
+  if (n == 16) {
+    return squaredMagnitude16(_mm512_loadu_ps(c), _mm512_loadu_ps(c + 16));
+  }
+  int n0 = 2*n < 16 ? 2*n : 16;
+  __m512 v0 = _mm512_maskz_loadu_ps(tailMask(n0), c);
+  __m512 v1 = _mm512_maskz_loadu_ps(tailMask(2*n - n0), c + 16);
+  return squaredMagnitude16(v0, v1);
+}
+
+static TARGET_AVX512 void multiplyAVX512(const Real* a, const Real* b, Real* out, int size) {
+  int i = 0;
+  for (; i+16<=size; i+=16) {
+    _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+  }
+  if (i < size) {
+    __mmask16 m = tailMask(size - i);
+    _mm512_mask_storeu_ps(out + i, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a + i),
+                                                    _mm512_maskz_loadu_ps(m, b + i)));
+  }
+}
+
+static TARGET_AVX512 void squaredMagnitudeAVX512(const complex<Real>* c, Real* out, int size) {
+  const Real* p = (const Real*)c;
+  int i = 0;
+  for (; i+16<=size; i+=16) {
+    _mm512_storeu_ps(out + i, squaredMagnitude16(p + 2*i, 16));
+  }
+  if (i < size) {
+    _mm512_mask_storeu_ps(out + i, tailMask(size - i), squaredMagnitude16(p + 2*i, size - i));
+  }
+}
+
+static TARGET_AVX512 void magnitudeAVX512(const complex<Real>* c, Real* out, int size) {
+  const Real* p = (const Real*)c;
+  int i = 0;
+  for (; i+16<=size; i+=16) {
+    _mm512_storeu_ps(out + i, _mm512_sqrt_ps(squaredMagnitude16(p + 2*i, 16)));
+  }
+  if (i < size) {
+    _mm512_mask_storeu_ps(out + i, tailMask(size - i),
+                          _mm512_sqrt_ps(squaredMagnitude16(p + 2*i, size - i)));
+  }
+}
+
+static TARGET_AVX512 Real dotAVX512(const Real* a, const Real* b, int size) {
+  __m512 acc = _mm512_setzero_ps();
+  int i = 0;
+  for (; i+16<=size; i+=16) {
+    acc = _mm512_add_ps(acc, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+  }
+  if (i < size) {
+    __mmask16 m = tailMask(size - i);
+    acc = _mm512_add_ps(acc, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a + i),
+                                           _mm512_maskz_loadu_ps(m, b + i)));
+  }
+  return _mm512_reduce_add_ps(acc);
+}
+
+static TARGET_AVX512 Real sumAVX512(const Real* a, int size) {
+  __m512 acc = _mm512_setzero_ps();
+  int i = 0;
+  for (; i+16<=size; i+=16) acc = _mm512_add_ps(acc, _mm512_loadu_ps(a + i));
+  if (i < size) {
+    acc = _mm512_add_ps(acc, _mm512_maskz_loadu_ps(tailMask(size - i), a + i));
+  }
+  return _mm512_reduce_add_ps(acc);
+}
+
+static TARGET_AVX512 Real sumSquaredDifferencesAVX512(const Real* a, Real m, int size) {
+  __m512 acc = _mm512_setzero_ps();
+  __m512 vm = _mm512_set1_ps(m);
+  int i = 0;
+  for (; i+16<=size; i+=16) {
+    __m512 d = _mm512_sub_ps(_mm512_loadu_ps(a + i), vm);
+    acc = _mm512_add_ps(acc, _mm512_mul_ps(d, d));
+  }
+  if (i < size) {
+    __mmask16 mask = tailMask(size - i);
+    __m512 d = _mm512_maskz_sub_ps(mask, _mm512_maskz_loadu_ps(mask, a + i), vm);
+    acc = _mm512_add_ps(acc, _mm512_mul_ps(d, d));
+  }
+  return _mm512_reduce_add_ps(acc);
+}
+
+static const Kernels avx512Kernels = {
+  multiplyAVX512, squaredMagnitudeAVX512, magnitudeAVX512,
+  dotAVX512, sumAVX512, sumSquaredDifferencesAVX512
+};
+
+#endif // ESSENTIA_X86_KERNELS
+
+
+KernelLevel supportedKernelLevel() {
+#ifdef ESSENTIA_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return KernelAVX512;
+  if (__builtin_cpu_supports("avx2")) return KernelAVX2;
+  if (__builtin_cpu_supports("sse2")) return KernelSSE2;
+#endif
+  return KernelScalar;
+}
+
+static const Kernels* kernelsForLevel(KernelLevel level) {
+#ifdef ESSENTIA_X86_KERNELS
+  switch (level) {
+    case KernelAVX512: return &avx512Kernels;
+    case KernelAVX2:   return &avx2Kernels;
+    case KernelSSE2:   return &sse2Kernels;
+    default: break;
+  }
+#endif
+  return &scalarKernels;
+}
+
+// statically initialized, so that the kernels can be used at any time, and
+// then upgraded to the best ones when the library is loaded
+static KernelLevel _level = KernelScalar;
+static const Kernels* _kernels = &scalarKernels;
+
+namespace {
+struct KernelSelector {
+  KernelSelector() { setKernelLevel(supportedKernelLevel()); }
+} kernelSelector;
+}
+
+KernelLevel kernelLevel() {
+  return _level;
+}
+
+void setKernelLevel(KernelLevel level) {
+  if (level > supportedKernelLevel()) {
+    throw EssentiaException("Vector kernels: the CPU doesn't support ", kernelLevelName(level));
+  }
+  _level = level;
+  _kernels = kernelsForLevel(level);
+}
+
+const char* kernelLevelName(KernelLevel level) {
+  switch (level) {
+    case KernelScalar: return "scalar";
+    case KernelSSE2:   return "SSE2";
+    case KernelAVX2:   return "AVX2";
+    case KernelAVX512: return "AVX-512";
+  }
+  return "unknown";
+}
+
+
+void multiply(const Real* a, const Real* b, Real* out, int size) {
+  _kernels->multiply(a, b, out, size);
+}
+
+void squaredMagnitude(const complex<Real>* c, Real* out, int size) {
+  _kernels->squaredMagnitude(c, out, size);
+}
+
+void magnitude(const complex<Real>* c, Real* out, int size) {
+  _kernels->magnitude(c, out, size);
+}
+
+Real dot(const Real* a, const Real* b, int size) {
+  return _kernels->dot(a, b, size);
+}
+
+Real sum(const Real* a, int size) {
+  return _kernels->sum(a, size);
+}
+
+Real sumSquaredDifferences(const Real* a, Real m, int size) {
+  return _kernels->sumSquaredDifferences(a, m, size);
+}
+
+} // namespace util
+} // namespace essentia
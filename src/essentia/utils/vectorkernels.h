@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef ESSENTIA_VECTORKERNELS_H
+#define ESSENTIA_VECTORKERNELS_H
+
+#include <complex>
+#include "types.h"
+
+namespace essentia {
+namespace util {
+
+/**
+ * Vectorized versions of the loops which are run on every frame by the
+ * spectral algorithms. On x86 CPUs, the kernels are implemented using SSE2,
+ * AVX2 and AVX-512 instructions, and the best instruction set supported by the
+ * CPU is selected when the library is loaded. On other platforms, or with
+ * compilers which don't support it, the scalar versions are used.
+ *
+ * The element-wise kernels give exactly the same results whatever the
+ * instruction set. The reductions (dot, sum, sumSquaredDifferences) add the
+ * values in a different order, so their results can differ in the last bits.
+ */
+enum KernelLevel {
+  KernelScalar,
+  KernelSSE2,
+  KernelAVX2,
+  KernelAVX512
+};
+
+/**
+ * @returns the instruction set currently used by the kernels.
+ */
+KernelLevel kernelLevel();
+
+/**
+ * @returns the best instruction set supported by the CPU.
+ */
+KernelLevel supportedKernelLevel();
+
+/**
+ * Forces the kernels to use the given instruction set, e.g. for testing or
+ * benchmarking. This is not thread-safe and should only be called when no
+ * algorithm is running. Throws an EssentiaException if the CPU doesn't
+ * support it.
+ */
+void setKernelLevel(KernelLevel level);
+
+/**
+ * @returns the name of the given instruction set.
+ */
+const char* kernelLevelName(KernelLevel level);
+
+/**
+ * out[i] = a[i] * b[i]. @e out can be the same array as @e a or @e b.
+ */
+void multiply(const Real* a, const Real* b, Real* out, int size);
+
+/**
+ * out[i] = |c[i]|^2
+ */
+void squaredMagnitude(const std::complex<Real>* c, Real* out, int size);
+
+/**
+ * out[i] = |c[i]|
+ */
+void magnitude(const std::complex<Real>* c, Real* out, int size);
+
+/**
+ * @returns the sum of a[i] * b[i]
+ */
+Real dot(const Real* a, const Real* b, int size);
+
+/**
+ * @returns the sum of a[i]
+ */
+Real sum(const Real* a, int size);
+
+/**
+ * @returns the sum of (a[i] - m)^2
+ */
+Real sumSquaredDifferences(const Real* a, Real m, int size);
+
+} // namespace util
+} // namespace essentia
+
+#endif // ESSENTIA_VECTORKERNELS_H
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "AudioCache.h"
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#ifndef OS_WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+using namespace essentia;
+
+
+AudioCache::AudioCache() : _size(0), _maxMemorySize(0), _finalized(false),
+                           _fd(-1), _map(0), _mapSize(0) {}
+
+AudioCache::~AudioCache() {
+  clear();
+}
+
+void AudioCache::clear() {
+#ifndef OS_WIN32
+  if (_map) munmap(_map, _mapSize);
+  if (_fd >= 0) {
+    close(_fd);
+    unlink(_spillFilename.c_str());
+  }
+#endif
+  _map = 0;
+  _mapSize = 0;
+  _fd = -1;
+  _spillFilename.clear();
+
+  // make sure the memory is actually given back
+  vector<Real>().swap(_samples);
+  _size = 0;
+  _finalized = false;
+}
+
+void AudioCache::spill() {
+#ifndef OS_WIN32
+  const char* tmpdir = getenv("TMPDIR");
+  string pattern = string(tmpdir ? tmpdir : "/tmp") + "/essentia_audiocache_XXXXXX";
+
+  vector<char> filename(pattern.begin(), pattern.end());
+  filename.push_back('\0');
+
+  _fd = mkstemp(&filename[0]);
+  if (_fd < 0) {
+    throw EssentiaException("AudioCache: could not create temporary file ", pattern, ": ", strerror(errno));
+  }
+  _spillFilename = &filename[0];
+
+  E_DEBUG(EAlgorithm, "AudioCache: spilling decoded audio to " << _spillFilename);
+
+  // move what we have in memory to the file, we will map everything back
+  // at once when finalizing
+  vector<Real> samples;
+  samples.swap(_samples);
+  _size = 0;
+  if (samples.empty()) return;
+  append(&samples[0], (int)samples.size());
+#endif
+}
+
+void AudioCache::append(const Real* samples, int size) {
+  if (_finalized) {
+    throw EssentiaException("AudioCache: cannot append samples to a finalized cache");
+  }
+  if (size <= 0) return;
+
+#ifndef OS_WIN32
+  if (_fd < 0 && _maxMemorySize > 0 &&
+      (long long)((_size + size) * sizeof(Real)) > _maxMemorySize) {
+    spill();
+  }
+
+  if (_fd >= 0) {
+    const char* buf = (const char*)samples;
+    size_t remaining = size * sizeof(Real);
+    while (remaining > 0) {
+      ssize_t written = write(_fd, buf, remaining);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        throw EssentiaException("AudioCache: could not write to ", _spillFilename, ": ", strerror(errno));
+      }
+      buf += written;
+      remaining -= written;
+    }
+    _size += size;
+    return;
+  }
+#endif
+
+  _samples.insert(_samples.end(), samples, samples + size);
+  _size += size;
+}
+
+void AudioCache::finalize() {
+  if (_finalized) return;
+  _finalized = true;
+
+#ifndef OS_WIN32
+  if (_fd >= 0 && _size > 0) {
+    _mapSize = _size * sizeof(Real);
+    _map = mmap(0, _mapSize, PROT_READ, MAP_SHARED, _fd, 0);
+    if (_map == MAP_FAILED) {
+      _map = 0;
+      throw EssentiaException("AudioCache: could not map ", _spillFilename, ": ", strerror(errno));
+    }
+    madvise(_map, _mapSize, MADV_SEQUENTIAL);
+  }
+#endif
+}
+
+const Real* AudioCache::data() const {
+  if (!_finalized) {
+    throw EssentiaException("AudioCache: cache needs to be finalized before its data can be accessed");
+  }
+  if (_map) return (const Real*)_map;
+  return _samples.empty() ? 0 : &_samples[0];
+}
+
+
+namespace essentia {
+namespace streaming {
+
+AudioCacheWriter::AudioCacheWriter(AudioCache* cache) : Algorithm(), _cache(cache) {
+  setName("AudioCacheWriter");
+  declareInput(_audio, 1, "audio", "the audio to be cached");
+}
+
+AlgorithmStatus AudioCacheWriter::process() {
+  EXEC_DEBUG("process()");
+
+  int ntokens = std::min(_audio.available(), _audio.buffer().bufferInfo().maxContiguousElements);
+  ntokens = std::max(1, ntokens);
+
+  if (!_audio.acquire(ntokens)) {
+    return NO_INPUT;
+  }
+
+  _cache->append(&_audio.firstToken(), ntokens);
+  _audio.release(ntokens);
+
+  return OK;
+}
+
+
+AudioCacheReader::AudioCacheReader(const AudioCache* cache) : Algorithm(), _cache(cache) {
+  setName("AudioCacheReader");
+  declareOutput(_audio, chunkSize, "audio", "the cached audio");
+  _audio.setBufferType(BufferUsage::forAudioStream);
+  reset();
+}
+
+void AudioCacheReader::reset() {
+  Algorithm::reset();
+  _idx = 0;
+  _audio.setAcquireSize(chunkSize);
+  _audio.setReleaseSize(chunkSize);
+}
+
+AlgorithmStatus AudioCacheReader::process() {
+  EXEC_DEBUG("process()");
+  if (shouldStop()) return PASS;
+
+  if (_idx + _audio.acquireSize() > _cache->size()) {
+    int howmuch = (int)(_cache->size() - _idx);
+    _audio.setAcquireSize(howmuch);
+    _audio.setReleaseSize(howmuch);
+  }
+
+  AlgorithmStatus status = acquireData();
+  if (status != OK) {
+    if (status == NO_OUTPUT) {
+      throw EssentiaException("AudioCacheReader: internal error: output buffer full");
+    }
+    return NO_INPUT;
+  }
+
+  int howmuch = _audio.acquireSize();
+  fastcopy((Real*)_audio.getFirstToken(), _cache->data() + _idx, howmuch);
+  _idx += howmuch;
+
+  releaseData();
+
+  return OK;
+}
+
+} // namespace streaming
+} // namespace essentia
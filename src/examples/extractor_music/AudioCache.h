@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#ifndef MUSIC_AUDIO_CACHE_H
+#define MUSIC_AUDIO_CACHE_H
+
+#include <string>
+#include <vector>
+#include "essentia/types.h"
+#include "essentia/streaming/streamingalgorithm.h"
+
+
+/**
+ * Holds the decoded, downmixed and resampled audio of a track so that the
+ * extractor only needs to decode the file once and can then replay it as many
+ * times as needed (replay gain, main descriptors, beat-dependent descriptors).
+ *
+ * Samples are kept in memory until their size exceeds maxMemorySize bytes; the
+ * remainder is then spilled to a temporary file which is memory-mapped once
+ * the cache has been finalized. Setting maxMemorySize to 0 disables spilling.
+ */
+class AudioCache {
+ public:
+  AudioCache();
+  ~AudioCache();
+
+  void setMaxMemorySize(long long bytes) { _maxMemorySize = bytes; }
+
+  void clear();
+  void append(const essentia::Real* samples, int size);
+
+  /**
+   * Must be called once all the samples have been appended, and before
+   * accessing them through data().
+   */
+  void finalize();
+
+  const essentia::Real* data() const;
+  long long size() const { return _size; }
+  bool spilled() const { return _fd >= 0; }
+
+ protected:
+  void spill();
+
+  std::vector<essentia::Real> _samples;
+  long long _size;
+  long long _maxMemorySize;
+  bool _finalized;
+
+  int _fd;
+  std::string _spillFilename;
+  void* _map;
+  size_t _mapSize;
+};
+
+
+namespace essentia {
+namespace streaming {
+
+/**
+ * Sink that appends all the audio it receives to an AudioCache.
+ */
+class AudioCacheWriter : public Algorithm {
+ protected:
+  Sink<Real> _audio;
+  AudioCache* _cache;
+
+ public:
+  AudioCacheWriter(AudioCache* cache);
+
+  void declareParameters() {}
+  AlgorithmStatus process();
+};
+
+/**
+ * Source that replays the content of a finalized AudioCache, emitting it in
+ * chunks of a fixed size.
+ */
+class AudioCacheReader : public Algorithm {
+ protected:
+  Source<Real> _audio;
+  const AudioCache* _cache;
+  long long _idx;
+
+  static const int chunkSize = 4096;
+
+ public:
+  AudioCacheReader(const AudioCache* cache);
+
+  void declareParameters() {}
+  void reset();
+  bool shouldStop() const { return _idx >= _cache->size(); }
+  AlgorithmStatus process();
+};
+
+} // namespace streaming
+} // namespace essentia
+
+#endif
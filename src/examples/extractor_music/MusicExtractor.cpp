@@ -26,14 +26,16 @@ using namespace scheduler;
 
 int MusicExtractor::compute(const string& audioFilename){
 
-  AlgorithmFactory& factory = AlgorithmFactory::instance();
-
   analysisSampleRate = options.value<Real>("analysisSampleRate");
   startTime = options.value<Real>("startTime");
   endTime = options.value<Real>("endTime");
   requireMbid = options.value<Real>("requireMbid");
   downmix = "mix";
 
+  // the cache size option is given in MB
+  audioCache.clear();
+  audioCache.setMaxMemorySize((long long)(options.value<Real>("audioCache.maxMemorySize") * 1024 * 1024));
+
   results.set("metadata.version.essentia", essentia::version);
   results.set("metadata.version.essentia_git_sha", essentia::version_git_sha);
   results.set("metadata.version.extractor", EXTRACTOR_VERSION);
@@ -59,57 +61,64 @@ int MusicExtractor::compute(const string& audioFilename){
   computeMetadata(audioFilename);
 
   cerr << "Process step: Replay gain" << endl;
-  computeReplayGain(audioFilename); // compute replay gain and the duration of the track
+  // compute replay gain and the duration of the track
+  int replayGainStatus = computeReplayGain(audioFilename);
+  if (replayGainStatus > 0) {
+    audioCache.clear();
+    return replayGainStatus;
+  }
 
   cerr << "Process step: Compute audio features" << endl;
 
   // normalize the audio with replay gain and compute as many lowlevel, rhythm,
   // and tonal descriptors as possible
 
-  Algorithm* loader = factory.create("EasyLoader",
-                                    "filename",   audioFilename,
-                                    "sampleRate", analysisSampleRate,
-                                    "startTime",  startTime,
-                                    "endTime",    endTime,
-                                    "replayGain", replayGain,
-                                    "downmix",    downmix);
+  // the audio has been decoded once in computeMetadata, replay it from the
+  // cache, trimmed and normalized as EasyLoader would do
+  SourceBase* audio = 0;
+  Algorithm* loader = createCachedLoader(replayGain, audio);
 
   MusicLowlevelDescriptors *lowlevel = new MusicLowlevelDescriptors(options);
   MusicRhythmDescriptors *rhythm = new MusicRhythmDescriptors(options);
   MusicTonalDescriptors *tonal = new MusicTonalDescriptors(options);
 
-  SourceBase& source = loader->output("audio");
+  SourceBase& source = *audio;
   lowlevel->createNetworkNeqLoud(source, results);
   lowlevel->createNetworkEqLoud(source, results);
   lowlevel->createNetworkLoudness(source, results);
   rhythm->createNetwork(source, results);
   tonal->createNetworkTuningFrequency(source, results);
 
+  // the descriptor sets create their own front-ends, and several of them use
+  // the same frame cutting/windowing/spectrum parameters: compute them once
   Network network(loader,false);
+  network.setMergeIdenticalAlgorithms(true);
   network.run();
 
 
   // Descriptors that require values from other descriptors in the previous chain
-  lowlevel->computeAverageLoudness(results);  // requires 'loudness'
+  int loudnessStatus = lowlevel->computeAverageLoudness(results);  // requires 'loudness'
+  if (loudnessStatus > 0) {
+    audioCache.clear();
+    return loudnessStatus;
+  }
 
-  Algorithm* loader_2 = factory.create("EasyLoader",
-                                       "filename",   audioFilename,
-                                       "sampleRate", analysisSampleRate,
-                                       "startTime",  startTime,
-                                       "endTime",    endTime,
-                                       "replayGain", replayGain,
-                                       "downmix",    downmix);
+  SourceBase* audio_2 = 0;
+  Algorithm* loader_2 = createCachedLoader(replayGain, audio_2);
 
-  SourceBase& source_2 = loader_2->output("audio");
+  SourceBase& source_2 = *audio_2;
   rhythm->createNetworkBeatsLoudness(source_2, results);  // requires 'beat_positions'
   tonal->createNetwork(source_2, results);                // requires 'tuning frequency'
 
   Network network_2(loader_2);
+  network_2.setMergeIdenticalAlgorithms(true);
   network_2.run();
 
   // Descriptors that require values from other descriptors in the previous chain
   tonal->computeTuningSystemFeatures(results); // requires 'hpcp_highres'
 
+  audioCache.clear();
+
   // TODO is this necessary? tuning_frequency should always have one value:
   Real tuningFreq = results.value<vector<Real> >(tonal->nameSpace + "tuning_frequency").back();
   results.remove(tonal->nameSpace + "tuning_frequency");
@@ -286,21 +295,76 @@ void MusicExtractor::readMetadata(const string& audioFilename) {
   */
 }
 
-void MusicExtractor::computeMetadata(const string& audioFilename) {
+void MusicExtractor::decodeAudio(const string& audioFilename, bool storeMetadata) {
   AlgorithmFactory& factory = AlgorithmFactory::instance();
+  // decode in a separate thread, overlapping with downmixing, resampling and
+  // writing to the cache
   Algorithm* loader = factory.create("AudioLoader",
-                                     "filename",   audioFilename,
-                                     "computeMD5", true);
-  loader->output("audio")           >> NOWHERE;
-  loader->output("md5")             >> PC(results, "metadata.audio_properties.md5_encoded");
-  loader->output("sampleRate")      >> PC(results, "metadata.audio_properties.sample_rate");
-  loader->output("numberChannels")  >> NOWHERE;
-  loader->output("bit_rate")        >> PC(results, "metadata.audio_properties.bit_rate");
-  loader->output("codec")           >> PC(results, "metadata.audio_properties.codec");
+                                     "filename",     audioFilename,
+                                     "computeMD5",   storeMetadata,
+                                     "asynchronous", true);
+
+  // same chain as in MonoLoader, the decoded audio is stored in the cache
+  // after having been downmixed and resampled to the analysis sample rate
+  Real inputSampleRate = lastTokenProduced<Real>(loader->output("sampleRate"));
+  Algorithm* mixer = factory.create("MonoMixer",
+                                    "type", downmix);
+  Algorithm* resample = factory.create("Resample",
+                                       "inputSampleRate", (int)inputSampleRate,
+                                       "outputSampleRate", analysisSampleRate);
+  Algorithm* writer = new AudioCacheWriter(&audioCache);
+
+  loader->output("audio")           >> mixer->input("audio");
+  loader->output("numberChannels")  >> mixer->input("numberChannels");
+  mixer->output("audio")            >> resample->input("signal");
+  resample->output("signal")        >> writer->input("audio");
+
+  if (storeMetadata) {
+    loader->output("md5")           >> PC(results, "metadata.audio_properties.md5_encoded");
+    loader->output("sampleRate")    >> PC(results, "metadata.audio_properties.sample_rate");
+    loader->output("bit_rate")      >> PC(results, "metadata.audio_properties.bit_rate");
+    loader->output("codec")         >> PC(results, "metadata.audio_properties.codec");
+  }
+  else {
+    loader->output("md5")           >> NOWHERE;
+    loader->output("sampleRate")    >> NOWHERE;
+    loader->output("bit_rate")      >> NOWHERE;
+    loader->output("codec")         >> NOWHERE;
+  }
+
+  audioCache.clear();
 
   Network network(loader);
   network.run();
 
+  audioCache.finalize();
+  if (audioCache.spilled()) {
+    cerr << "  Decoded audio does not fit in memory, using a temporary file" << endl;
+  }
+}
+
+Algorithm* MusicExtractor::createCachedLoader(Real gain, SourceBase*& audio) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  Algorithm* reader = new AudioCacheReader(&audioCache);
+  Algorithm* trimmer = factory.create("Trimmer",
+                                      "sampleRate", analysisSampleRate,
+                                      "startTime",  startTime,
+                                      "endTime",    endTime);
+  // apply a 6dB preamp, as done by all audio players.
+  Algorithm* scale = factory.create("Scale",
+                                    "factor", db2amp(gain + 6.0));
+
+  reader->output("audio")   >> trimmer->input("signal");
+  trimmer->output("signal") >> scale->input("signal");
+
+  audio = &scale->output("signal");
+  return reader;
+}
+
+void MusicExtractor::computeMetadata(const string& audioFilename) {
+  decodeAudio(audioFilename, true);
+
   // This is just our best guess as to if a file is in a lossless or lossy format
   // It won't protect us against people converting from (e.g.) mp3 -> flac
   // before submitting
@@ -314,7 +378,7 @@ void MusicExtractor::computeMetadata(const string& audioFilename) {
   results.set("metadata.audio_properties.lossless", isLossless);
 }
 
-void MusicExtractor::computeReplayGain(const string& audioFilename) {
+int MusicExtractor::computeReplayGain(const string& audioFilename) {
 
   AlgorithmFactory& factory = AlgorithmFactory::instance();
 
@@ -322,21 +386,28 @@ void MusicExtractor::computeReplayGain(const string& audioFilename) {
   int length = 0;
 
   while (true) {
-    Algorithm* audio = factory.create("EqloudLoader",
-                                      "filename",   audioFilename,
-                                      "sampleRate", analysisSampleRate,
-                                      "startTime",  startTime,
-                                      "endTime",    endTime,
-                                      "downmix",    downmix);
+    // the audio cache holds the "mix" downmix decoded in computeMetadata, the
+    // file only needs to be decoded again if we fall back to the left channel
+    if (downmix != "mix") {
+      decodeAudio(audioFilename, false);
+    }
+
+    // same as EqloudLoader, whose default replay gain of -6dB compensates
+    // for the preamp
+    SourceBase* audio = 0;
+    Algorithm* loader = createCachedLoader(-6.0, audio);
+    Algorithm* eqloud = factory.create("EqualLoudness",
+                                       "sampleRate", analysisSampleRate);
     Algorithm* rgain = factory.create("ReplayGain", "applyEqloud", false);
 
-    audio->output("audio")      >> rgain->input("signal");
+    *audio                      >> eqloud->input("signal");
+    eqloud->output("signal")    >> rgain->input("signal");
     rgain->output("replayGain") >> PC(results, "metadata.audio_properties.replay_gain");
 
     try {
-      Network network(audio);
+      Network network(loader);
       network.run();
-      length = audio->output("audio").totalProduced();
+      length = eqloud->output("signal").totalProduced();
       replayGain = results.value<Real>("metadata.audio_properties.replay_gain");
     }
 
@@ -346,7 +417,7 @@ void MusicExtractor::computeReplayGain(const string& audioFilename) {
       }
       else {
         cerr << "ERROR: File looks like a completely silent file... Aborting..." << endl;
-        exit(4);
+        return 4;
       }
 
       try {
@@ -371,7 +442,7 @@ void MusicExtractor::computeReplayGain(const string& audioFilename) {
     }
     else {
       cerr << "ERROR: File looks like a completely silent file... Aborting..." << endl;
-      exit(5);
+      return 5;
     }
   }
 
@@ -379,6 +450,7 @@ void MusicExtractor::computeReplayGain(const string& audioFilename) {
 
   // set length (actually duration) of the file
   results.set("metadata.audio_properties.length", length/analysisSampleRate);
+  return 0;
 }
 
 
@@ -400,6 +472,8 @@ void MusicExtractor::outputToFile(Pool& pool, const string& outputFilename){
 }
 
 void MusicExtractor::loadSVMModels() {
+  // models only need to be loaded once when analyzing several files
+  if (!svms.empty()) return;
 
   vector<string> svmModels = options.value<vector<string> >("highlevel.svm_models");
 
@@ -424,6 +498,14 @@ void MusicExtractor::computeSVMDescriptors(Pool& pool) {
 }
 
 
+void MusicExtractor::reset() {
+  results.clear();
+  stats.clear();
+  audioCache.clear();
+  mergeValues(results);
+}
+
+
 void MusicExtractor::setExtractorOptions(const std::string& filename) {
   setExtractorDefaultOptions();
 
@@ -447,6 +529,8 @@ void MusicExtractor::setExtractorDefaultOptions() {
   options.set("outputFormat", "json");
   options.set("requireMbid", false);
   options.set("indent", 4);
+  // decoded audio larger than this (in MB) is cached in a temporary file
+  options.set("audioCache.maxMemorySize", 512);
 
   string silentFrames = "noise";
 
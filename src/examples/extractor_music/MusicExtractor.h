@@ -33,6 +33,7 @@
 #include "MusicLowlevelDescriptors.h"
 #include "MusicRhythmDescriptors.h"
 #include "MusicTonalDescriptors.h"
+#include "AudioCache.h"
 
 
 #define EXTRACTOR_VERSION "music 1.0"
@@ -47,6 +48,8 @@ using namespace streaming;
  protected:
 
   Pool computeAggregation(Pool& pool);
+  void decodeAudio(const string& audioFilename, bool storeMetadata);
+  Algorithm* createCachedLoader(Real gain, SourceBase*& audio);
 
   Real analysisSampleRate;
   Real startTime;
@@ -56,6 +59,7 @@ using namespace streaming;
 
   Real replayGain;
   string downmix;
+  AudioCache audioCache;
   vector<standard::Algorithm*> svms;
 
  public:
@@ -72,12 +76,14 @@ using namespace streaming;
   Pool options;
 
   int compute(const string& audioFilename);
+  // clears the results of the previous file, keeping options and loaded models
+  void reset();
   void setExtractorOptions(const std::string& filename);
   void setExtractorDefaultOptions();
   void mergeValues(Pool &pool);
   void readMetadata(const string& audioFilename);
   void computeMetadata(const string& audioFilename);
-  void computeReplayGain(const string& audioFilename);
+  int computeReplayGain(const string& audioFilename);
   void computeSVMDescriptors(Pool& pool);
   void loadSVMModels();
   void outputToFile(Pool& pool, const string& outputFilename);
@@ -361,16 +361,14 @@ Real squeezeRange(Real& x, Real& x1, Real& x2) {
 }
 
 
-void MusicLowlevelDescriptors::computeAverageLoudness(Pool& pool){ // after computing network
+int MusicLowlevelDescriptors::computeAverageLoudness(Pool& pool){ // after computing network
 
-// check if we processed enough audio to get an estimation for the loudness 
+  // check if we processed enough audio to get an estimation for the loudness
   // (2 seconds required)
-  try {
-    pool.value<vector<Real> >(nameSpace + "loudness")[0];
-  }
-  catch (EssentiaException&) {
+  if (!pool.contains<vector<Real> >(nameSpace + "loudness") ||
+      pool.value<vector<Real> >(nameSpace + "loudness").empty()) {
     cerr << "ERROR: File is too short for loudness estimation... Aborting..." << endl;
-    exit(6);
+    return 6;
   }
 
   vector<Real> levelArray = pool.value<vector<Real> >(nameSpace + "loudness");
@@ -406,4 +404,5 @@ void MusicLowlevelDescriptors::computeAverageLoudness(Pool& pool){ // after comp
   pool.set(nameSpace + "average_loudness", levelAverageSqueezed);
 
   // TODO: add requirements for EBUR128 loudness
+  return 0;
 }
@@ -38,7 +38,7 @@ using namespace std;
  	void createNetworkNeqLoud(SourceBase& source, Pool& pool);
   void createNetworkEqLoud(SourceBase& source, Pool& pool);
   void createNetworkLoudness(SourceBase& source, Pool& pool);
-	void computeAverageLoudness(Pool& pool);
+	int computeAverageLoudness(Pool& pool);
  };
 
  #endif
\ No newline at end of file
@@ -46,6 +46,8 @@ void usage(char *progname) {
 int essentia_main(string audioFilename, string outputFilename, string profileFilename) {
   // Returns: 1 on essentia error
   //          2 if there are no tags in the file
+  //          4, 5 if the file looks like a silent file
+  //          6 if the file is too short for loudness estimation
   int result;
   try {
     essentia::init();
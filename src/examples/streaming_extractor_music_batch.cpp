@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+// Batch version of the music extractor: analyzes a list of files with a pool
+// of worker threads, paying the start-up costs (algorithms registration,
+// profile parsing, SVM models loading) only once.
+
+#include <fstream>
+#include <cstdlib>
+#include <essentia/essentiautil.h>
+#include <essentia/scheduler/threadpool.h>
+
+#include "extractor_music/MusicExtractor.h"
+#include "credit_libav.h"
+
+using namespace std;
+using namespace essentia;
+using namespace essentia::streaming;
+using namespace essentia::scheduler;
+
+void usage(char *progname) {
+    cout << "Error: wrong number of arguments" << endl;
+    cout << "Usage: " << progname << " input_filelist [profile] [-t number_of_threads]" << endl;
+    cout << endl <<
+"The input file list contains one audio file per line, optionally followed by a\n"
+"tab and the name of the output file. If no output file is given, results are\n"
+"written next to the audio file, with the extension of the output format added." << endl;
+    cout << endl << "Music extractor version '" << EXTRACTOR_VERSION << "'" << endl
+         << "built with Essentia version " << essentia::version_git_sha << endl;
+    creditLibAV();
+    exit(1);
+}
+
+
+struct Job {
+  string audioFilename;
+  string outputFilename;
+};
+
+vector<Job> readFileList(const string& filename) {
+  ifstream in(filename.c_str());
+  if (!in) {
+    throw EssentiaException("Could not open file list: ", filename);
+  }
+
+  vector<Job> jobs;
+  string line;
+  while (getline(in, line)) {
+    if (!line.empty() && line[line.size()-1] == '\r') line.erase(line.size()-1);
+    if (line.empty()) continue;
+
+    Job job;
+    size_t tab = line.find('\t');
+    if (tab == string::npos) {
+      job.audioFilename = line;
+    }
+    else {
+      job.audioFilename = line.substr(0, tab);
+      job.outputFilename = line.substr(tab+1);
+    }
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+
+/**
+ * Each task analyzes one file, using one of the extractors which are not
+ * currently used by another thread. There are as many extractors as threads
+ * in the pool, so there is always one available.
+ */
+class BatchExtraction : public TaskList {
+ public:
+  BatchExtraction(const vector<Job>& jobs, const vector<MusicExtractor*>& extractors) :
+    _jobs(jobs), _available(extractors), _results(jobs.size(), 0) {}
+
+  void run(int task) {
+    MusicExtractor* extractor = acquireExtractor();
+    _results[task] = process(extractor, _jobs[task]);
+    releaseExtractor(extractor);
+  }
+
+  const vector<int>& results() const { return _results; }
+
+ protected:
+  const vector<Job>& _jobs;
+  vector<MusicExtractor*> _available;
+  vector<int> _results;
+  ForcedMutex _mutex;
+
+  MusicExtractor* acquireExtractor() {
+    ForcedMutexLocker lock(_mutex);
+    MusicExtractor* extractor = _available.back();
+    _available.pop_back();
+    return extractor;
+  }
+
+  void releaseExtractor(MusicExtractor* extractor) {
+    ForcedMutexLocker lock(_mutex);
+    _available.push_back(extractor);
+  }
+
+  // Returns the same codes as streaming_extractor_music for each file. Errors
+  // are reported and the batch goes on with the next file.
+  int process(MusicExtractor* extractor, const Job& job) {
+    try {
+      extractor->reset();
+
+      cerr << "Analyzing " << job.audioFilename << endl;
+      int result = extractor->compute(job.audioFilename);
+
+      if (result > 0) {
+        cerr << "Skipping " << job.audioFilename << " (error code " << result << ")" << endl;
+        return result;
+      }
+
+      string outputFilename = job.outputFilename;
+      if (outputFilename.empty()) {
+        outputFilename = job.audioFilename + "." + extractor->options.value<string>("outputFormat");
+      }
+
+      extractor->outputToFile(extractor->stats, outputFilename);
+      if (extractor->options.value<Real>("outputFrames")) {
+        extractor->outputToFile(extractor->results, outputFilename+"_frames");
+      }
+      return 0;
+    }
+    catch (EssentiaException& e) {
+      cerr << "Error while analyzing " << job.audioFilename << ": " << e.what() << endl;
+      return 1;
+    }
+    catch (std::exception& e) {
+      cerr << "Error while analyzing " << job.audioFilename << ": " << e.what() << endl;
+      return 1;
+    }
+    catch (...) {
+      cerr << "Unknown error while analyzing " << job.audioFilename << endl;
+      return 1;
+    }
+  }
+};
+
+
+int essentia_main(const string& fileListFilename, const string& profileFilename, int nThreads) {
+  // Returns: 1 on essentia error or if any of the files could not be analyzed
+  vector<MusicExtractor*> extractors;
+  int failed = 0;
+
+  try {
+    essentia::init();
+
+    vector<Job> jobs = readFileList(fileListFilename);
+    if (nThreads > (int)jobs.size()) nThreads = max(1, (int)jobs.size());
+
+    for (int i=0; i<nThreads; i++) {
+      MusicExtractor* extractor = new MusicExtractor();
+      extractor->setExtractorOptions(profileFilename);
+      if (extractor->options.value<Real>("highlevel.compute")) {
+        extractor->loadSVMModels();
+      }
+      extractors.push_back(extractor);
+    }
+
+    BatchExtraction batch(jobs, extractors);
+    vector<int> ready(jobs.size());
+    // the pool picks tasks from the back of the list, so reverse it to
+    // process files in order
+    for (int i=0; i<(int)jobs.size(); i++) ready[i] = (int)jobs.size() - 1 - i;
+
+    ThreadPool pool(nThreads);
+    pool.run(batch, ready);
+
+    for (int i=0; i<(int)jobs.size(); i++) {
+      if (batch.results()[i] != 0) failed++;
+    }
+    cerr << "Analyzed " << jobs.size() - failed << " out of " << jobs.size() << " files" << endl;
+
+    for (int i=0; i<(int)extractors.size(); i++) delete extractors[i];
+    extractors.clear();
+
+    essentia::shutdown();
+  }
+  catch (EssentiaException& e) {
+    for (int i=0; i<(int)extractors.size(); i++) delete extractors[i];
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return failed > 0 ? 1 : 0;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  string fileListFilename, profileFilename;
+  int nThreads = ThreadPool::hardwareConcurrency();
+
+  vector<string> args;
+  for (int i=1; i<argc; i++) {
+    if (string(argv[i]) == "-t") {
+      if (i+1 >= argc) usage(argv[0]);
+      nThreads = atoi(argv[++i]);
+      if (nThreads < 1) usage(argv[0]);
+    }
+    else {
+      args.push_back(argv[i]);
+    }
+  }
+
+  switch (args.size()) {
+    case 1:
+      fileListFilename = args[0];
+      break;
+    case 2: // profile supplied
+      fileListFilename = args[0];
+      profileFilename = args[1];
+      break;
+    default:
+      usage(argv[0]);
+  }
+
+  return essentia_main(fileListFilename, profileFilename, nThreads);
+}
@@ -77,6 +77,9 @@ init_essentia() {
     return;
   }
 
+  // the GIL is released while computing algorithms and running networks
+  PyEval_InitThreads();
+
   // import the NumPy C api
   int numpy_error = _import_array();
   if (numpy_error) {
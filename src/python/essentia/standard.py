@@ -19,6 +19,7 @@ import _essentia
 import essentia
 import common as _c
 import sys as _sys
+import numpy as _numpy
 from _essentia import keys as algorithmNames, info as algorithmInfo
 from copy import copy
 
@@ -65,7 +66,7 @@ def _create_essentia_class(name, moduleName = __name__):
 
             # we have to make some exceptions for YamlOutput and PoolAggregator
             # because they expect cpp Pools
-            if name in ('YamlOutput', 'PoolAggregator', 'SvmClassifier', 'PCA', 'GaiaTransform'):
+            if name in ('YamlOutput', 'BinaryPoolOutput', 'PoolAggregator', 'SvmClassifier', 'PCA', 'GaiaTransform'):
                 args = (args[0].cppPool,)
 
             # verify that all types match and do any necessary conversions
@@ -94,7 +95,7 @@ def _create_essentia_class(name, moduleName = __name__):
 
             # we have to make an exceptional case for YamlInput, because we need
             # to wrap the Pool that it outputs w/ our python Pool from common.py
-            if name in ('YamlInput', 'PoolAggregator', 'SvmClassifier', 'PCA', 'GaiaTransform', 'Extractor'):
+            if name in ('YamlInput', 'BinaryPoolInput', 'PoolAggregator', 'SvmClassifier', 'PCA', 'GaiaTransform', 'Extractor'):
                 return _c.Pool(results)
 
             # In the case of MetadataReader, the 7th output is also a Pool
@@ -104,6 +105,17 @@ def _create_essentia_class(name, moduleName = __name__):
             else:
                 return results
 
+        def computeBatch(self, frames):
+            '''Computes the algorithm on each row of a 2-dimensional array of
+            frames in a single call. The algorithm must have a single vector
+            input. Real and integer outputs are returned as 1-dimensional arrays
+            and vector outputs as 2-dimensional arrays, with one row per frame.'''
+            frames = _numpy.ascontiguousarray(frames, dtype='f4')
+            if frames.ndim != 2:
+                raise ValueError(name+'.computeBatch requires a 2-dimensional array of frames')
+
+            return self.__computeBatch__(frames)
+
         def __call__(self, *args):
             return self.compute(*args)
 
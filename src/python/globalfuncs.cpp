@@ -661,11 +661,23 @@ static PyObject* run(PyObject* notUsed, PyObject* obj) {
 
   PyStreamingAlgorithm* pyAlg = reinterpret_cast<PyStreamingAlgorithm*>(obj);
 
+  // the algorithms of the network are kept alive by their Python objects, so
+  // other Python threads can run while the network is running
+  bool failed = false;
+  string error;
+
+  Py_BEGIN_ALLOW_THREADS
   try {
     scheduler::Network(pyAlg->algo, false).run();
   }
   catch (const exception& e) {
-    PyErr_SetString(PyExc_RuntimeError, e.what());
+    failed = true;
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS
+
+  if (failed) {
+    PyErr_SetString(PyExc_RuntimeError, error.c_str());
     return NULL;
   }
 
@@ -34,7 +34,9 @@ using namespace standard;
 
 /**
  * The algorithm structure. Contains a pointer to the C++ algorithm, and a bool
- * indicating whether it has already been configured or not.
+ * indicating whether it is being computed. As the GIL is released during the
+ * computation, another Python thread could try to use the same algorithm in
+ * the meantime, which is refused.
  */
 class PyAlgorithm {
 
@@ -42,6 +44,7 @@ class PyAlgorithm {
   PyObject_HEAD
 
   Algorithm* algo;
+  bool busy;
 
   static PyObject* make_new(PyTypeObject* type, PyObject* args, PyObject* kwds);
   static int init(PyAlgorithm *self, PyObject *args, PyObject *kwds);
@@ -52,6 +55,7 @@ class PyAlgorithm {
   }
 
   static PyObject* reset(PyAlgorithm* self) {
+    if (!checkNotBusy(self)) return NULL;
     self->algo->reset();
     Py_RETURN_NONE;
   }
@@ -73,12 +77,15 @@ class PyAlgorithm {
 
   static PyObject* configure(PyAlgorithm* self, PyObject* args, PyObject* keywds);
   static PyObject* compute(PyAlgorithm* self, PyObject* args);
+  static PyObject* computeBatch(PyAlgorithm* self, PyObject* obj);
   static PyObject* inputType(PyAlgorithm* self, PyObject* name);
   static PyObject* paramType(PyAlgorithm* self, PyObject* name);
   static PyObject* paramValue(PyAlgorithm* self, PyObject* name);
 
   static PyObject* getDoc(PyAlgorithm* self);
   static PyObject* getStruct(PyAlgorithm* self);
+
+  static bool checkNotBusy(PyAlgorithm* self);
 };
 
 
@@ -92,6 +99,17 @@ void PyAlgorithm::dealloc(PyObject* self) {
 }
 
 
+bool PyAlgorithm::checkNotBusy(PyAlgorithm* self) {
+  if (self->busy) {
+    ostringstream msg;
+    msg << self->algo->name() << " is already being computed in another thread";
+    PyErr_SetString(PyExc_RuntimeError, msg.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+
 int PyAlgorithm::init(PyAlgorithm *self, PyObject *args, PyObject *kwds) {
   static char *kwlist[] = { (char*)"name", NULL };
   char* algoname;
@@ -121,6 +139,8 @@ PyObject* PyAlgorithm::configure(PyAlgorithm* self, PyObject* args, PyObject* ke
 
   E_DEBUG(EPyBindings, PY_ALGONAME << "::configure()");
 
+  if (!checkNotBusy(self)) return NULL;
+
   // create the list of named parameters that this algorithm can accept
   ParameterMap pm = self->algo->defaultParameters();
 
@@ -183,6 +203,8 @@ void deallocate_outputs(vector<void*> outputs, vector<Edt> outputTypes) {
 PyObject* PyAlgorithm::compute(PyAlgorithm* self, PyObject* args) {
   E_DEBUG(EPyBindings, PY_ALGONAME << "::compute()");
 
+  if (!checkNotBusy(self)) return NULL;
+
   // parse the arguments into separate python objects
   vector<PyObject*> arg_list = unpack(args);
 
@@ -330,15 +352,29 @@ PyObject* PyAlgorithm::compute(PyAlgorithm* self, PyObject* args) {
 
 
   // now that the algorithm and ready and set to go (all inputs and outputs
-  // are correctly bound), we can safely call the compute() method.
+  // are correctly bound), we can safely call the compute() method. The inputs
+  // are kept alive by the arguments tuple, so other Python threads can run in
+  // the meantime.
   E_DEBUG(EPyBindings, PY_ALGONAME << ": computing...");
 
+  bool failed = false;
+  string error;
+
+  self->busy = true;
+  Py_BEGIN_ALLOW_THREADS
   try {
     self->algo->compute();
   }
   catch (const exception& e) {
+    failed = true;
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS
+  self->busy = false;
+
+  if (failed) {
     ostringstream msg;
-    msg << "In " << self->algo->name() << ".compute: " << e.what();
+    msg << "In " << self->algo->name() << ".compute: " << error;
     PyErr_SetString(PyExc_RuntimeError, msg.str().c_str());
 
     // clean up temp vars
@@ -386,6 +422,150 @@ PyObject* PyAlgorithm::compute(PyAlgorithm* self, PyObject* args) {
 }
 
 
+/**
+ * Computes an algorithm with a single VECTOR_REAL input on each row of a
+ * 2-dimensional array, without going back to Python between frames. The
+ * outputs are accumulated directly in C++ vectors, REAL and INTEGER outputs
+ * are returned as 1-dimensional arrays and VECTOR_REAL outputs as
+ * 2-dimensional arrays with one row per frame.
+ */
+PyObject* PyAlgorithm::computeBatch(PyAlgorithm* self, PyObject* obj) {
+  E_DEBUG(EPyBindings, PY_ALGONAME << "::computeBatch()");
+
+  if (!checkNotBusy(self)) return NULL;
+
+  vector<const type_info*> inputTypes = self->algo->inputTypes();
+  if (inputTypes.size() != 1 || typeInfoToEdt(*inputTypes[0]) != VECTOR_REAL) {
+    ostringstream msg;
+    msg << self->algo->name() << ".computeBatch requires an algorithm with a single VECTOR_REAL input";
+    PyErr_SetString(PyExc_RuntimeError, msg.str().c_str());
+    return NULL;
+  }
+
+  if (!PyArray_Check(obj) || PyArray_NDIM(obj) != 2 ||
+      PyArray_TYPE(obj) != PyArray_FLOAT || !PyArray_ISCARRAY_RO(obj)) {
+    PyErr_SetString(PyExc_TypeError, "computeBatch expects a C-contiguous 2-dimensional numpy array of dtype='f4'");
+    return NULL;
+  }
+
+  int nOutputs = self->algo->outputs().size();
+  vector<const type_info*> outputTypeInfos = self->algo->outputTypes();
+  vector<string> outputNames = self->algo->outputNames();
+  vector<Edt> outputTypes(nOutputs);
+
+  // the outputs of one frame, and their values for all the frames
+  vector<Real> reals(nOutputs);
+  vector<int> integers(nOutputs);
+  vector<vector<Real> > vectors(nOutputs);
+  vector<vector<Real> > results(nOutputs);
+  vector<vector<int> > integerResults(nOutputs);
+  vector<int> widths(nOutputs, 0);
+
+  int nFrames = PyArray_DIM(obj, 0);
+  int frameSize = PyArray_DIM(obj, 1);
+
+  for (int i=0; i<nOutputs; i++) {
+    OutputBase& port = self->algo->output(outputNames[i]);
+    outputTypes[i] = typeInfoToEdt(*outputTypeInfos[i]);
+
+    switch (outputTypes[i]) {
+      case REAL:        port.set(reals[i]);    results[i].reserve(nFrames); break;
+      case INTEGER:     port.set(integers[i]); integerResults[i].reserve(nFrames); break;
+      case VECTOR_REAL: port.set(vectors[i]);  break;
+
+      default:
+        ostringstream msg;
+        msg << "In " << self->algo->name() << ".computeBatch: unsupported output type: "
+            << edtToString(outputTypes[i]);
+        PyErr_SetString(PyExc_RuntimeError, msg.str().c_str());
+        return NULL;
+    }
+  }
+
+  // the frames are not copied, the input is just pointed at each row in turn
+  RogueVector<Real> frame;
+  self->algo->input(self->algo->inputNames()[0]).set(static_cast<const vector<Real>&>(frame));
+  Real* data = (Real*)PyArray_DATA(obj);
+
+  E_DEBUG(EPyBindings, PY_ALGONAME << ": computing " << nFrames << " frames...");
+
+  bool failed = false;
+  string error;
+
+  self->busy = true;
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    for (int n=0; n<nFrames; n++) {
+      frame.setData(data + n*frameSize);
+      frame.setSize(frameSize);
+
+      self->algo->compute();
+
+      for (int i=0; i<nOutputs; i++) {
+        switch (outputTypes[i]) {
+          case REAL:    results[i].push_back(reals[i]); break;
+          case INTEGER: integerResults[i].push_back(integers[i]); break;
+          default:
+            if (n == 0) {
+              widths[i] = vectors[i].size();
+              results[i].reserve(nFrames * widths[i]);
+            }
+            else if (int(vectors[i].size()) != widths[i]) {
+              throw EssentiaException("output '", outputNames[i], "' does not have the same size for all frames");
+            }
+            results[i].insert(results[i].end(), vectors[i].begin(), vectors[i].end());
+        }
+      }
+    }
+  }
+  catch (const exception& e) {
+    failed = true;
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS
+  self->busy = false;
+
+  if (failed) {
+    ostringstream msg;
+    msg << "In " << self->algo->name() << ".computeBatch: " << error;
+    PyErr_SetString(PyExc_RuntimeError, msg.str().c_str());
+    return NULL;
+  }
+
+  E_DEBUG(EPyBindings, PY_ALGONAME << ": done!");
+
+  vector<PyObject*> result(nOutputs);
+
+  for (int i=0; i<nOutputs; i++) {
+    npy_intp dims[2] = { nFrames, widths[i] };
+    PyObject* array;
+
+    if (outputTypes[i] == INTEGER) {
+      array = PyArray_SimpleNew(1, dims, PyArray_INT);
+      if (array && nFrames > 0) {
+        fastcopy((int*)PyArray_DATA(array), &integerResults[i][0], nFrames);
+      }
+    }
+    else {
+      array = PyArray_SimpleNew(outputTypes[i] == REAL ? 1 : 2, dims, PyArray_FLOAT);
+      if (array && !results[i].empty()) {
+        fastcopy((Real*)PyArray_DATA(array), &results[i][0], results[i].size());
+      }
+    }
+
+    if (array == NULL) {
+      for (int j=0; j<i; j++) Py_DECREF(result[j]);
+      return NULL;
+    }
+    result[i] = array;
+  }
+
+  E_DEBUG(EPyBindings, PY_ALGONAME << "::computeBatch() done!");
+
+  return buildReturnValue(result);
+}
+
+
 PyObject* PyAlgorithm::inputType(PyAlgorithm* self, PyObject* obj) {
   if (!PyString_Check(obj)) {
     PyErr_SetString(PyExc_TypeError, "Algorithm.inputType expects a string as the only argument");
@@ -487,6 +667,8 @@ static PyMethodDef PyAlgorithm_methods[] = {
                       "Configure the algorithm" },
   { "__compute__",    (PyCFunction)PyAlgorithm::compute, METH_VARARGS,
                       "compute the algorithm" },
+  { "__computeBatch__", (PyCFunction)PyAlgorithm::computeBatch, METH_O,
+                      "compute the algorithm on each row of a 2-dimensional array" },
   { "inputType",      (PyCFunction)PyAlgorithm::inputType, METH_O,
                       "Returns the type of the input given by its name" },
   { "paramType",      (PyCFunction)PyAlgorithm::paramType, METH_O,
@@ -144,3 +144,41 @@ TEST(Composite, ExecutionNetwork) {
 
   delete vinput; delete composite; delete voutput;
 }
+
+
+TEST(Composite, StandardPortHandles) {
+  standard::Algorithm* fft = standard::AlgorithmFactory::create("FFT", "size", 8);
+
+  standard::InputHandle<vector<Real> > frameInput;
+  standard::OutputHandle<vector<complex<Real> > > fftOutput;
+  frameInput.attach(fft, "frame");
+  fftOutput.attach(fft, "fft");
+
+  // the types are checked when attaching
+  standard::InputHandle<Real> wrongInput;
+  standard::OutputHandle<vector<Real> > wrongOutput;
+  ASSERT_THROW(wrongInput.attach(fft, "frame"), EssentiaException);
+  ASSERT_THROW(wrongOutput.attach(fft, "fft"), EssentiaException);
+  ASSERT_THROW(frameInput.attach(fft, "signal"), EssentiaException);
+
+  Real values[] = { 1, 2, 3, 4, 0, 0, 0, 0 };
+  vector<Real> frame = arrayToVector<Real>(values);
+  vector<complex<Real> > expected, result;
+
+  fft->input("frame").set(frame);
+  fft->output("fft").set(expected);
+  fft->compute();
+
+  vector<Real> zeros(8, 0);
+  fft->input("frame").set(zeros);
+  frameInput.set(frame);
+  fftOutput.set(result);
+  fft->compute();
+
+  ASSERT_EQ(expected.size(), result.size());
+  for (int i=0; i<(int)result.size(); i++) {
+    EXPECT_EQ(expected[i], result[i]);
+  }
+
+  delete fft;
+}
@@ -18,6 +18,7 @@
  */
 
 #include "essentia_gtest.h"
+#include <sched.h>
 #include "scheduler/network.h"
 using namespace std;
 using namespace essentia;
@@ -632,3 +633,83 @@ TEST(Connectors, KindaComplexMess) {
   delete source1;
   delete sink5;
 }
+
+
+// push a sequence of integers in a buffer from one thread and read them back
+// from another one, acquiring a different number of tokens on each side
+
+const int nLockFreeTokens = 1000000;
+
+void* lockFreeProducer(void* arg) {
+  Source<int>& source = *static_cast<Source<int>*>(arg);
+  int n = 0;
+  while (n < nLockFreeTokens) {
+    int chunk = std::min(333, nLockFreeTokens - n);
+    if (!source.acquire(chunk)) { sched_yield(); continue; }
+    std::vector<int>& tokens = source.tokens();
+    for (int i=0; i<chunk; i++) tokens[i] = n++;
+    source.release(chunk);
+  }
+  return 0;
+}
+
+void* lockFreeConsumer(void* arg) {
+  Sink<int>& sink = *static_cast<Sink<int>*>(arg);
+  int n = 0;
+  long errors = 0;
+  while (n < nLockFreeTokens) {
+    int chunk = std::min(1000, nLockFreeTokens - n);
+    if (!sink.acquire(chunk)) { sched_yield(); continue; }
+    const std::vector<int>& tokens = sink.tokens();
+    for (int i=0; i<chunk; i++) if (tokens[i] != n++) errors++;
+    sink.release(chunk);
+  }
+  return (void*)errors;
+}
+
+TEST(Connectors, LockFreeProducerConsumer) {
+  Source<int> source("Source1");
+  Sink<int> sink("Sink1");
+  source.setBufferType(BufferUsage::forAudioStream);
+  source.setBufferThreadingPolicy(BufferThreading::LockFree);
+  connect(source, sink);
+
+  ASSERT_EQ(BufferThreading::LockFree, source.bufferThreadingPolicy());
+
+  pthread_t producer, consumer;
+  pthread_create(&producer, 0, lockFreeProducer, &source);
+  pthread_create(&consumer, 0, lockFreeConsumer, &sink);
+
+  void* errors;
+  pthread_join(producer, 0);
+  pthread_join(consumer, &errors);
+
+  EXPECT_EQ(0, (long)errors);
+  EXPECT_EQ(nLockFreeTokens, source.totalProduced());
+  EXPECT_EQ(0, sink.available());
+}
+
+TEST(Connectors, LockFreeMultiReader) {
+  // with more than one reader, the buffer falls back to being locked but
+  // should still behave in the same way
+  Source<float> source("Source1");
+  Sink<float> sink("Sink1");
+  Sink<float> sink2("Sink2");
+  source.setBufferThreadingPolicy(BufferThreading::LockFree);
+
+  connect(source, sink);
+  source.push(1.0f);
+  connect(source, sink2);
+  source.push(2.0f);
+
+  ASSERT_EQ(2, sink.available());
+  ASSERT_EQ(1, sink2.available());
+  EXPECT_EQ(1, sink.pop());
+  EXPECT_EQ(2, sink2.pop());
+
+  disconnect(source, sink2);
+  source.push(3.0f);
+  EXPECT_EQ(2, sink.pop());
+  EXPECT_EQ(3, sink.pop());
+  ASSERT_THROW(sink.pop(), EssentiaException);
+}
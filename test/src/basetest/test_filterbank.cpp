@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "essentia_gtest.h"
+#include "essentiamath.h"
+#include "utils/filterbank.h"
+using namespace std;
+using namespace essentia;
+using util::Filterbank;
+
+
+TEST(Filterbank, SparseBands) {
+  Filterbank fb;
+  fb.clear(6);
+
+  Real band0[] = { 0, 0, 1, 2, 0, 0 };
+  Real band1[] = { 1, 1 };
+  fb.addBand(arrayToVector<Real>(band0));
+  fb.addBand(0, band1, 2);
+  fb.addBand(vector<Real>(6, 0.0));
+
+  EXPECT_EQ(3, fb.size());
+  EXPECT_EQ(6, fb.spectrumSize());
+
+  Real spectrum[] = { 1, 2, 3, 4, 5, 6 };
+  vector<Real> bands;
+
+  fb.compute(arrayToVector<Real>(spectrum), bands, false, false);
+  Real expected[] = { 11, 3, 0 };
+  EXPECT_VEC_EQ(bands, arrayToVector<Real>(expected));
+
+  fb.compute(arrayToVector<Real>(spectrum), bands, true, false);
+  Real expectedPower[] = { 41, 5, 0 };
+  EXPECT_VEC_EQ(bands, arrayToVector<Real>(expectedPower));
+
+  fb.compute(arrayToVector<Real>(spectrum), bands, false, true);
+  EXPECT_NEAR(log2(12.), bands[0], 1e-6);
+  EXPECT_NEAR(2, bands[1], 1e-6);
+  EXPECT_EQ(0, bands[2]);
+}
+
+TEST(Filterbank, InvalidSizes) {
+  Filterbank fb;
+  fb.clear(4);
+  Real band[] = { 1, 1, 1 };
+
+  ASSERT_THROW(fb.addBand(vector<Real>(5, 1.0)), EssentiaException);
+  ASSERT_THROW(fb.addBand(2, band, 3), EssentiaException);
+
+  fb.addBand(1, band, 3);
+  vector<Real> bands;
+  ASSERT_THROW(fb.compute(vector<Real>(5, 1.0), bands, false, false), EssentiaException);
+}
+
+TEST(Filterbank, TriangularBands) {
+  Filterbank fb;
+  Real frequencies[] = { 0, 1000, 2000, 3000 };
+
+  // 9 bins at 8kHz: one bin every 500Hz
+  fb.createTriangularBands(arrayToVector<Real>(frequencies), 8000, 9, hz2hz, true);
+  EXPECT_EQ(2, fb.size());
+
+  vector<Real> spectrum(9);
+  for (int i=0; i<9; ++i) spectrum[i] = i;
+  vector<Real> bands;
+
+  fb.compute(spectrum, bands, false, false);
+  EXPECT_NEAR(2, bands[0], 1e-6);
+  EXPECT_NEAR(4, bands[1], 1e-6);
+
+  fb.compute(spectrum, bands, true, false);
+  EXPECT_NEAR(4.5, bands[0], 1e-6);
+  EXPECT_NEAR(16.5, bands[1], 1e-6);
+
+  // the last band goes above the Nyquist frequency
+  Real high[] = { 3000, 3500, 4000, 5000 };
+  fb.createTriangularBands(arrayToVector<Real>(high), 8000, 9, hz2hz, false);
+  fb.compute(spectrum, bands, false, false);
+  EXPECT_EQ(2, int(bands.size()));
+  EXPECT_NEAR(7, bands[0], 1e-6);
+  EXPECT_NEAR(8, bands[1], 1e-6);
+}
@@ -40,3 +40,58 @@ TEST(Math, NextPowerOfTwo) {
   EXPECT_EQ(2*n, nextPowerTwo(n+1));
 
 }
+
+// all the instruction sets supported by the CPU must give the same results as
+// the scalar kernels, for all sizes of the remaining part of the arrays
+TEST(Math, VectorKernels) {
+  util::KernelLevel best = util::supportedKernelLevel();
+  util::KernelLevel previous = util::kernelLevel();
+
+  for (int size=0; size<70; size++) {
+    vector<Real> a(size+1), b(size+1);
+    vector<complex<Real> > c(size+1);
+    for (int i=0; i<size; i++) {
+      a[i] = sin(0.3*i) - 0.2;
+      b[i] = cos(1.7*i) + 1.1;
+      c[i] = complex<Real>(a[i], 2*b[i]);
+    }
+
+    util::setKernelLevel(util::KernelScalar);
+    vector<Real> expectedProduct(size+1), expectedSquared(size+1), expectedMagnitude(size+1);
+    util::multiply(&a[0], &b[0], &expectedProduct[0], size);
+    util::squaredMagnitude(&c[0], &expectedSquared[0], size);
+    util::magnitude(&c[0], &expectedMagnitude[0], size);
+    Real expectedDot = util::dot(&a[0], &b[0], size);
+    Real expectedSum = util::sum(&a[0], size);
+    Real expectedDiff = util::sumSquaredDifferences(&a[0], 0.5, size);
+
+    for (int level=util::KernelSSE2; level<=best; level++) {
+      util::setKernelLevel((util::KernelLevel)level);
+      // the last element checks that nothing is written past the end
+      vector<Real> product(size+1), squared(size+1), magnitude(size+1);
+      util::multiply(&a[0], &b[0], &product[0], size);
+      util::squaredMagnitude(&c[0], &squared[0], size);
+      util::magnitude(&c[0], &magnitude[0], size);
+
+      EXPECT_VEC_EQ(product, expectedProduct);
+      EXPECT_VEC_EQ(squared, expectedSquared);
+      EXPECT_VEC_EQ(magnitude, expectedMagnitude);
+      EXPECT_NEAR(expectedDot, util::dot(&a[0], &b[0], size), 1e-5);
+      EXPECT_NEAR(expectedSum, util::sum(&a[0], size), 1e-5);
+      EXPECT_NEAR(expectedDiff, util::sumSquaredDifferences(&a[0], 0.5, size), 1e-5);
+    }
+  }
+
+  util::setKernelLevel(previous);
+}
+
+TEST(Math, VectorizedStatistics) {
+  vector<Real> v;
+  for (int i=0; i<37; i++) v.push_back(i % 5);
+
+  EXPECT_NEAR(71.0/37, mean(v), 1e-6);
+  EXPECT_NEAR(70, sum(v, 1, 36), 1e-6);
+  EXPECT_NEAR(0, sum(v, 3, 3), 1e-6);
+  EXPECT_NEAR(211, energy(v), 1e-4);
+  EXPECT_NEAR(2.0204529, variance(v, mean(v)), 1e-5);
+}
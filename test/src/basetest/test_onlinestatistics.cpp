@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <algorithm>
+#include "essentia_gtest.h"
+#include "essentiamath.h"
+#include "network.h"
+#include "vectorinput.h"
+#include "aggregatedpoolstorage.h"
+#include "utils/onlinestatistics.h"
+using namespace std;
+using namespace essentia;
+using namespace essentia::streaming;
+using namespace essentia::scheduler;
+
+
+vector<vector<Real> > randomFrames(int nFrames, int size) {
+  srand(0);
+  vector<vector<Real> > frames(nFrames, vector<Real>(size));
+  for (int i=0; i<nFrames; ++i) {
+    for (int j=0; j<size; ++j) {
+      // each dimension has a different distribution
+      frames[i][j] = (j+1) * Real(rand()) / RAND_MAX + j * sin(Real(i) / (j+2));
+    }
+  }
+  return frames;
+}
+
+const char* allStats[] = { "min", "max", "median", "mean", "var", "stdev", "skew", "kurt",
+                           "dmean", "dvar", "dmean2", "dvar2", "cov", "icov" };
+
+Pool aggregate(const Pool& pool) {
+  Pool result;
+  standard::Algorithm* aggregator = standard::AlgorithmFactory::create("PoolAggregator",
+                                                                       "defaultStats", arrayToVector<string>(allStats));
+  aggregator->input("input").set(pool);
+  aggregator->output("output").set(result);
+  aggregator->compute();
+  delete aggregator;
+  return result;
+}
+
+void expectNear(const vector<Real>& expected, const vector<Real>& values, Real precision) {
+  ASSERT_EQ(expected.size(), values.size());
+  for (int i=0; i<(int)expected.size(); ++i) {
+    EXPECT_NEAR(expected[i], values[i], precision * max(Real(1), fabs(expected[i])));
+  }
+}
+
+
+TEST(MedianEstimator, ExactForFewValues) {
+  MedianEstimator estimator;
+  EXPECT_EQ(0, estimator.median());
+
+  Real values[] = { 3, -1, 4, 1, 5 };
+  vector<Real> added;
+  for (int i=0; i<5; ++i) {
+    estimator.add(values[i]);
+    added.push_back(values[i]);
+    EXPECT_EQ(median(added), estimator.median());
+  }
+}
+
+TEST(MedianEstimator, Approximation) {
+  vector<vector<Real> > frames = randomFrames(10000, 3);
+  for (int j=0; j<3; ++j) {
+    MedianEstimator estimator;
+    vector<Real> values(frames.size());
+    for (int i=0; i<(int)frames.size(); ++i) {
+      values[i] = frames[i][j];
+      estimator.add(values[i]);
+    }
+    Real range = *max_element(values.begin(), values.end()) - *min_element(values.begin(), values.end());
+    EXPECT_NEAR(median(values), estimator.median(), 0.01 * range);
+  }
+}
+
+TEST(OnlineStatistics, SameAsPoolAggregator) {
+  vector<vector<Real> > frames = randomFrames(1000, 4);
+
+  Pool pool;
+  OnlineStatistics statistics(4, true);
+  for (int i=0; i<(int)frames.size(); ++i) {
+    pool.add("frames", frames[i]);
+    statistics.add(frames[i]);
+  }
+  Pool expected = aggregate(pool);
+
+  EXPECT_EQ(1000, statistics.size());
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("frames.min"), statistics.min());
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("frames.max"), statistics.max());
+  expectNear(expected.value<vector<Real> >("frames.mean"), statistics.mean(), 1e-5);
+  expectNear(expected.value<vector<Real> >("frames.var"), statistics.variance(), 1e-4);
+  expectNear(expected.value<vector<Real> >("frames.stdev"), statistics.stdev(), 1e-4);
+  expectNear(expected.value<vector<Real> >("frames.skew"), statistics.skewness(), 1e-3);
+  expectNear(expected.value<vector<Real> >("frames.kurt"), statistics.kurtosis(), 1e-3);
+  expectNear(expected.value<vector<Real> >("frames.dmean"), statistics.dmean(), 1e-4);
+  expectNear(expected.value<vector<Real> >("frames.dvar"), statistics.dvar(), 1e-4);
+  expectNear(expected.value<vector<Real> >("frames.dmean2"), statistics.dmean2(), 1e-4);
+  expectNear(expected.value<vector<Real> >("frames.dvar2"), statistics.dvar2(), 1e-4);
+
+  const vector<vector<Real> >& cov = expected.value<vector<vector<Real> > >("frames.cov");
+  const vector<vector<Real> >& icov = expected.value<vector<vector<Real> > >("frames.icov");
+  TNT::Array2D<Real> onlineCov = statistics.covariance();
+  TNT::Array2D<Real> onlineIcov = statistics.inverseCovariance();
+  for (int i=0; i<4; ++i) {
+    for (int j=0; j<4; ++j) {
+      EXPECT_NEAR(cov[i][j], onlineCov[i][j], 1e-4);
+      EXPECT_NEAR(icov[i][j], onlineIcov[i][j], 1e-3 * max(Real(1), fabs(icov[i][j])));
+    }
+  }
+}
+
+TEST(OnlineStatistics, FewFrames) {
+  OnlineStatistics statistics(2);
+  ASSERT_THROW(statistics.covariance(), EssentiaException);
+
+  Real frame[] = { 1, -2 };
+  statistics.add(frame);
+  EXPECT_VEC_EQ(arrayToVector<Real>(frame), statistics.mean());
+  EXPECT_VEC_EQ(arrayToVector<Real>(frame), statistics.median());
+  EXPECT_VEC_EQ(vector<Real>(2, 0), statistics.variance());
+  EXPECT_VEC_EQ(vector<Real>(2, 0), statistics.dmean());
+  EXPECT_VEC_EQ(vector<Real>(2, 0), statistics.dmean2());
+
+  ASSERT_THROW(statistics.add(vector<Real>(3)), EssentiaException);
+}
+
+TEST(AggregatedPoolStorage, SameAsPoolAggregator) {
+  vector<vector<Real> > frames = randomFrames(500, 3);
+  vector<Real> values(frames.size());
+  for (int i=0; i<(int)frames.size(); ++i) values[i] = frames[i][0];
+
+  VectorInput<vector<Real> >* framesInput = new VectorInput<vector<Real> >(&frames);
+  VectorInput<Real>* valuesInput = new VectorInput<Real>(&values);
+  vector<string> stats = arrayToVector<string>(allStats);
+
+  Pool pool, aggregated;
+  framesInput->output("data") >> PC(pool, "frames");
+  valuesInput->output("data") >> PC(pool, "values");
+  connectAggregated(framesInput->output("data"), aggregated, "frames", stats);
+  connectAggregated(valuesInput->output("data"), aggregated, "values", stats);
+
+  Network(framesInput).run();
+  Network(valuesInput).run();
+
+  Pool expected = aggregate(pool);
+  for (int i=0; i<(int)stats.size(); ++i) {
+    // the median is estimated
+    Real precision = stats[i] == "median" ? 0.05 : 1e-3;
+
+    if (stats[i] != "cov" && stats[i] != "icov") {
+      Real value = expected.value<Real>("values." + stats[i]);
+      EXPECT_NEAR(value, aggregated.value<Real>("values." + stats[i]), precision * max(Real(1), fabs(value)));
+    }
+
+    string name = "frames." + stats[i];
+    if (stats[i] == "cov" || stats[i] == "icov") {
+      const vector<vector<Real> >& matrix = expected.value<vector<vector<Real> > >(name);
+      const vector<vector<Real> >& onlineMatrix = aggregated.value<vector<vector<Real> > >(name);
+      ASSERT_EQ(matrix.size(), onlineMatrix.size());
+      for (int j=0; j<(int)matrix.size(); ++j) expectNear(matrix[j], onlineMatrix[j], precision);
+    }
+    else {
+      expectNear(expected.value<vector<Real> >(name), aggregated.value<vector<Real> >(name), precision);
+    }
+  }
+  EXPECT_FALSE(aggregated.contains<vector<vector<Real> > >("frames"));
+}
+
+TEST(AggregatedPoolStorage, InvalidStats) {
+  vector<Real> values(10);
+  VectorInput<Real>* input = new VectorInput<Real>(&values);
+  Pool pool;
+
+  vector<string> stats(1, "copy");
+  ASSERT_THROW(connectAggregated(input->output("data"), pool, "values", stats), EssentiaException);
+
+  connectAggregated(input->output("data"), pool, "values");
+  Network(input).run();
+  EXPECT_EQ(Real(0), pool.value<Real>("values.mean"));
+  EXPECT_EQ(Real(0), pool.value<Real>("values.stdev"));
+  EXPECT_FALSE(pool.contains<vector<Real> >("values"));
+}
@@ -18,6 +18,7 @@
  */
 
 #include <algorithm>
+#include <pthread.h>
 #include "essentia_gtest.h"
 using namespace std;
 using essentia::Real;
@@ -264,3 +265,136 @@ TEST(Pool, IntegrityCheck) {
   p.add("foo.bar", (Real)1.23456789);
   ASSERT_THROW(p.add("foo.bar", "mixed up the types!"), EssentiaException);
 }
+
+TEST(Pool, ValidateParentAndChild) {
+  essentia::Pool p;
+  p.add("foo.bar.baz", (Real)1.0);
+  ASSERT_THROW(p.add("foo.bar", (Real)2.0), EssentiaException);
+  ASSERT_THROW(p.add("foo", (Real)2.0), EssentiaException);
+  ASSERT_THROW(p.set("foo.bar.baz.qux", (Real)2.0), EssentiaException);
+  p.add("foo.barbaz", (Real)3.0);
+
+  // once the children are removed, the namespace can hold values again
+  p.removeNamespace("foo.bar");
+  p.add("foo.bar", (Real)2.0);
+  ASSERT_THROW(p.add("foo.bar.baz", (Real)1.0), EssentiaException);
+  p.remove("foo.bar");
+  p.add("foo.bar.baz", (Real)1.0);
+
+  vector<string> expected;
+  expected.push_back("foo.bar.baz");
+  expected.push_back("foo.barbaz");
+  vector<string> result = p.descriptorNames();
+  sort(result.begin(), result.end());
+  EXPECT_VEC_EQ(result, expected);
+}
+
+TEST(Pool, KeyAdd) {
+  essentia::Pool p;
+  const essentia::Pool::Key& key = p.key("foo.bar");
+  EXPECT_EQ(&key, &p.key("foo.bar"));
+  EXPECT_EQ("foo.bar", key.name());
+  EXPECT_FALSE(p.contains<vector<Real> >("foo.bar"));
+
+  vector<Real> expected;
+  for (int i=0; i<3; i++) {
+    p.add(key, (Real)i);
+    expected.push_back((Real)i);
+  }
+  p.add("foo.bar", (Real)3);
+  expected.push_back((Real)3);
+  p.append(key, vector<Real>(2, (Real)4));
+  expected.push_back((Real)4);
+  expected.push_back((Real)4);
+  EXPECT_VEC_EQ(p.value<vector<Real> >("foo.bar"), expected);
+
+  // the key must still validate the descriptor name
+  ASSERT_THROW(p.add(key, "mixed up the types!"), EssentiaException);
+  const essentia::Pool::Key& child = p.key("foo.bar.baz");
+  ASSERT_THROW(p.add(child, (Real)1), EssentiaException);
+}
+
+TEST(Pool, KeyAfterRemove) {
+  essentia::Pool p;
+  const essentia::Pool::Key& key = p.key("foo.bar");
+  p.add(key, (Real)1);
+  p.remove("foo.bar");
+  p.add(key, (Real)2);
+  EXPECT_VEC_EQ(p.value<vector<Real> >("foo.bar"), vector<Real>(1, (Real)2));
+
+  p.clear();
+  p.set(key, "single");
+  p.set(key, "value");
+  EXPECT_EQ("value", p.value<string>("foo.bar"));
+
+  p.mergeSingle("foo.bar", string("replaced"), "replace");
+  p.set(key, "again");
+  EXPECT_EQ("again", p.value<string>("foo.bar"));
+}
+
+TEST(Pool, KeyAfterCopy) {
+  essentia::Pool p;
+  const essentia::Pool::Key& key = p.key("foo.bar");
+  p.add(key, (Real)1);
+
+  essentia::Pool copy(p);
+  copy.add(copy.key("foo.bar"), (Real)2);
+  EXPECT_VEC_EQ(p.value<vector<Real> >("foo.bar"), vector<Real>(1, (Real)1));
+  EXPECT_EQ(2, (int)copy.value<vector<Real> >("foo.bar").size());
+
+  p = copy;
+  p.add(key, (Real)3);
+  EXPECT_EQ(3, (int)p.value<vector<Real> >("foo.bar").size());
+  EXPECT_EQ(2, (int)copy.value<vector<Real> >("foo.bar").size());
+  ASSERT_THROW(p.add("foo", (Real)1), EssentiaException);
+}
+
+// each writer adds values to its own descriptors and to a shared one, while
+// descriptors are being created by the other writers
+struct PoolWriter {
+  essentia::Pool* pool;
+  string ns;
+};
+
+void* poolWriter(void* arg) {
+  PoolWriter* w = (PoolWriter*)arg;
+  essentia::Pool& p = *w->pool;
+  const essentia::Pool::Key& own = p.key(w->ns + ".values");
+  const essentia::Pool::Key& shared = p.key("shared.values");
+  for (int i=0; i<20000; i++) {
+    p.add(own, (Real)i);
+    p.add(shared, (Real)i);
+    p.add(w->ns + ".vectors", vector<Real>(3, (Real)i));
+    if (i % 1000 == 0) {
+      ostringstream name;
+      name << w->ns << ".created." << i;
+      p.set(name.str(), (Real)i);
+    }
+  }
+  return 0;
+}
+
+TEST(Pool, ConcurrentAdd) {
+  const int nThreads = 4;
+  essentia::Pool p;
+  PoolWriter writers[nThreads];
+  pthread_t threads[nThreads];
+
+  for (int i=0; i<nThreads; i++) {
+    ostringstream ns;
+    ns << "writer" << i;
+    writers[i].pool = &p;
+    writers[i].ns = ns.str();
+    pthread_create(&threads[i], 0, poolWriter, &writers[i]);
+  }
+  for (int i=0; i<nThreads; i++) pthread_join(threads[i], 0);
+
+  for (int i=0; i<nThreads; i++) {
+    const vector<Real>& values = p.value<vector<Real> >(writers[i].ns + ".values");
+    ASSERT_EQ(20000, (int)values.size());
+    for (int j=0; j<(int)values.size(); j++) EXPECT_EQ((Real)j, values[j]);
+    EXPECT_EQ(20000, (int)p.value<vector<vector<Real> > >(writers[i].ns + ".vectors").size());
+    EXPECT_EQ(20, (int)p.descriptorNames(writers[i].ns + ".created").size());
+  }
+  EXPECT_EQ(nThreads*20000, (int)p.value<vector<Real> >("shared.values").size());
+}
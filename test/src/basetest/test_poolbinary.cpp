@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <fstream>
+#include "essentia_gtest.h"
+#include "utils/poolbinary.h"
+using namespace std;
+using namespace essentia;
+
+
+void fillPool(Pool& p) {
+  p.add("lowlevel.loudness", Real(0.5));
+  p.add("lowlevel.loudness", Real(-1.25));
+
+  vector<Real> frame(3);
+  for (int i=0; i<100; ++i) {
+    frame[0] = i; frame[1] = 2*i; frame[2] = -i;
+    p.add("lowlevel.mfcc", frame);
+  }
+  p.add("lowlevel.mfcc", vector<Real>());
+
+  p.add("tags.genre", "rock");
+  p.add("tags.genre", "");
+
+  vector<string> artists;
+  artists.push_back("a");
+  artists.push_back("bc");
+  p.add("tags.artists", artists);
+  p.add("tags.artists", vector<string>());
+
+  TNT::Array2D<Real> matrix(2, 3);
+  for (int i=0; i<2; ++i) for (int j=0; j<3; ++j) matrix[i][j] = i*3 + j;
+  p.add("rhythm.matrix", matrix);
+
+  StereoSample sample;
+  sample.left() = 0.25;
+  sample.right() = -0.5;
+  p.add("audio.stereo", sample);
+
+  p.set("metadata.duration", Real(3.5));
+  p.set("metadata.title", "title");
+  p.set("metadata.histogram", frame);
+}
+
+void expectSamePools(const Pool& expected, const Pool& p) {
+  vector<string> names = expected.descriptorNames();
+  EXPECT_VEC_EQ(names, p.descriptorNames());
+
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("lowlevel.loudness"), p.value<vector<Real> >("lowlevel.loudness"));
+  EXPECT_MATRIX_EQ(expected.value<vector<vector<Real> > >("lowlevel.mfcc"), p.value<vector<vector<Real> > >("lowlevel.mfcc"));
+  EXPECT_VEC_EQ(expected.value<vector<string> >("tags.genre"), p.value<vector<string> >("tags.genre"));
+  EXPECT_MATRIX_EQ(expected.value<vector<vector<string> > >("tags.artists"), p.value<vector<vector<string> > >("tags.artists"));
+
+  const TNT::Array2D<Real>& matrix = p.value<vector<TNT::Array2D<Real> > >("rhythm.matrix")[0];
+  ASSERT_EQ(2, matrix.dim1());
+  ASSERT_EQ(3, matrix.dim2());
+  for (int i=0; i<2; ++i) for (int j=0; j<3; ++j) EXPECT_EQ(Real(i*3 + j), matrix[i][j]);
+
+  const vector<StereoSample>& stereo = p.value<vector<StereoSample> >("audio.stereo");
+  ASSERT_EQ(1, int(stereo.size()));
+  EXPECT_EQ(Real(0.25), stereo[0].left());
+  EXPECT_EQ(Real(-0.5), stereo[0].right());
+
+  EXPECT_EQ(Real(3.5), p.value<Real>("metadata.duration"));
+  EXPECT_EQ("title", p.value<string>("metadata.title"));
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("metadata.histogram"), p.value<vector<Real> >("metadata.histogram"));
+}
+
+TEST(PoolBinary, RoundTrip) {
+  string filename = "build/test/pool.bin";
+  Pool expected, p;
+  fillPool(expected);
+
+  writePoolBinary(expected, filename);
+  readPoolBinary(filename, p);
+  if (remove(filename.c_str())) throw EssentiaException("TestPoolBinary: Error deleting ", filename);
+
+  expectSamePools(expected, p);
+}
+
+TEST(PoolBinary, Compressed) {
+  if (!poolBinaryCompressionAvailable()) return;
+
+  string filename = "build/test/pool.bin";
+  string compressedFilename = "build/test/poolz.bin";
+  Pool expected, p;
+  fillPool(expected);
+
+  writePoolBinary(expected, filename);
+  writePoolBinary(expected, compressedFilename, true);
+  readPoolBinary(compressedFilename, p);
+
+  ifstream file(filename.c_str(), ios::binary | ios::ate);
+  ifstream compressedFile(compressedFilename.c_str(), ios::binary | ios::ate);
+  EXPECT_LT(compressedFile.tellg(), file.tellg());
+  file.close();
+  compressedFile.close();
+
+  if (remove(filename.c_str())) throw EssentiaException("TestPoolBinary: Error deleting ", filename);
+  if (remove(compressedFilename.c_str())) throw EssentiaException("TestPoolBinary: Error deleting ", compressedFilename);
+
+  expectSamePools(expected, p);
+}
+
+TEST(PoolBinary, Version) {
+  string filename = "build/test/pool.bin";
+  Pool p;
+  p.add("foo", Real(1));
+
+  writePoolBinary(Pool(), filename, false, true);
+  readPoolBinary(filename, p);
+  if (remove(filename.c_str())) throw EssentiaException("TestPoolBinary: Error deleting ", filename);
+
+  EXPECT_EQ(string(version), p.value<string>("metadata.version.essentia"));
+  EXPECT_EQ(Real(1), p.value<vector<Real> >("foo")[0]);
+}
+
+string readFile(const string& filename) {
+  ifstream file(filename.c_str(), ios::binary);
+  return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+uint64 readUInt64(const string& contents, size_t position) {
+  uint64 value;
+  memcpy(&value, contents.data() + position, sizeof(value));
+  return value;
+}
+
+// overwrites a 64-bit field of a pool file
+void patchUInt64(const string& filename, size_t position, uint64 value) {
+  string contents = readFile(filename);
+  memcpy(&contents[position], &value, sizeof(value));
+  ofstream(filename.c_str(), ios::binary).write(contents.data(), contents.size());
+}
+
+TEST(PoolBinary, InvalidFiles) {
+  string filename = "build/test/pool.bin";
+  Pool expected, p;
+  fillPool(expected);
+
+  ASSERT_THROW(readPoolBinary("build/test/nonexistent.bin", p), EssentiaException);
+
+  ofstream(filename.c_str(), ios::binary) << "not a pool";
+  ASSERT_THROW(readPoolBinary(filename, p), EssentiaException);
+
+  // truncating the file anywhere makes it invalid
+  writePoolBinary(expected, filename);
+  string contents;
+  {
+    ifstream file(filename.c_str(), ios::binary);
+    contents.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+  }
+  for (int size=0; size<int(contents.size()); size+=37) {
+    ofstream(filename.c_str(), ios::binary).write(contents.data(), size);
+    Pool truncated;
+    ASSERT_THROW(readPoolBinary(filename, truncated), EssentiaException);
+  }
+
+  // the directory starts at the offset stored after the magic, version and
+  // number of columns; each entry has the data offset at byte 16 and the
+  // uncompressed size at byte 32
+  const size_t directoryOffsetPosition = 16;
+  const size_t dataOffsetPosition = 16;
+  const size_t sizePosition = 32;
+
+  // matrix dimensions which would overflow
+  Pool matrixPool;
+  matrixPool.add("rhythm.matrix", TNT::Array2D<Real>(2, 3, Real(1)));
+  writePoolBinary(matrixPool, filename);
+  contents = readFile(filename);
+  uint64 directory = readUInt64(contents, directoryOffsetPosition);
+  uint64 matrixData = readUInt64(contents, directory + dataOffsetPosition);
+  patchUInt64(filename, matrixData, uint64(1) << 62);
+  ASSERT_THROW(readPoolBinary(filename, p), EssentiaException);
+  patchUInt64(filename, matrixData, uint64(INT_MAX) + 1);
+  ASSERT_THROW(readPoolBinary(filename, p), EssentiaException);
+
+  // uncompressed size larger than what zlib could have compressed
+  if (poolBinaryCompressionAvailable()) {
+    Pool compressiblePool;
+    for (int i=0; i<1000; ++i) compressiblePool.add("lowlevel.loudness", Real(1));
+    writePoolBinary(compressiblePool, filename, true);
+    contents = readFile(filename);
+    directory = readUInt64(contents, directoryOffsetPosition);
+    patchUInt64(filename, directory + sizePosition, uint64(1) << 50);
+    ASSERT_THROW(readPoolBinary(filename, p), EssentiaException);
+  }
+
+  if (remove(filename.c_str())) throw EssentiaException("TestPoolBinary: Error deleting ", filename);
+}
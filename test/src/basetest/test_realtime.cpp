@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include "essentia_gtest.h"
+#include "network.h"
+#include "ringbufferinput.h"
+#include "allocationguard.h"
+using namespace std;
+using namespace essentia;
+using namespace essentia::streaming;
+using namespace essentia::scheduler;
+
+// counts the allocations of the whole test program
+ESSENTIA_COUNT_ALLOCATIONS
+
+
+TEST(AllocationGuard, CountsAllocations) {
+  ASSERT_TRUE(AllocationGuard::enabled());
+
+  sint64 before = AllocationGuard::allocations();
+  vector<Real>* v = new vector<Real>(16);
+  EXPECT_EQ(2, AllocationGuard::allocations() - before);
+  delete v;
+  EXPECT_EQ(2, AllocationGuard::allocations() - before);
+
+  // the other forms of operator new are counted too
+  int* i = new (std::nothrow) int[4];
+  EXPECT_EQ(3, AllocationGuard::allocations() - before);
+  delete[] i;
+
+#ifdef __cpp_aligned_new
+  struct alignas(64) Aligned { char c[64]; };
+  Aligned* a = new Aligned;
+  EXPECT_EQ(4, AllocationGuard::allocations() - before);
+  EXPECT_EQ(0u, reinterpret_cast<std::size_t>(a) % 64);
+  delete a;
+#endif
+}
+
+
+// feeds chunks of a signal alternating between tones and silence
+void feedSignal(RingBufferInput* input, int step, int chunkSize) {
+  vector<Real> chunk(chunkSize, 0.0);
+  if ((step / 20) % 4 != 3) {
+    for (int i=0; i<chunkSize; i++) {
+      Real t = (step*chunkSize + i) / 44100.;
+      chunk[i] = 0.5*sin(2*M_PI*440*t) + 0.25*sin(2*M_PI*660*t);
+    }
+  }
+  input->add(&chunk[0], chunkSize);
+}
+
+TEST(Network, RealTimeNoAllocations) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  // the ringbuffer algorithms are not in the factory
+  RingBufferInput* input = new RingBufferInput();
+  input->declareParameters();
+  ParameterMap params;
+  params.add("bufferSize", 8192);
+  params.add("realTime", true);
+  input->setParameters(params);
+  input->configure();
+
+  Algorithm* fc       = factory.create("FrameCutter", "frameSize", 2048, "hopSize", 512,
+                                       "silentFrames", "noise");
+  Algorithm* window   = factory.create("Windowing", "type", "blackmanharris62");
+  Algorithm* spectrum = factory.create("Spectrum");
+  Algorithm* peaks    = factory.create("SpectralPeaks", "orderBy", "magnitude",
+                                       "maxPeaks", 60, "minFrequency", 40);
+  Algorithm* hpcp     = factory.create("HPCP", "maxShifted", true);
+  Algorithm* mfcc     = factory.create("MFCC");
+
+  input->output("signal")         >>  fc->input("signal");
+  fc->output("frame")             >>  window->input("frame");
+  window->output("frame")         >>  spectrum->input("frame");
+  spectrum->output("spectrum")    >>  peaks->input("spectrum");
+  spectrum->output("spectrum")    >>  mfcc->input("spectrum");
+  peaks->output("frequencies")    >>  hpcp->input("frequencies");
+  peaks->output("magnitudes")     >>  hpcp->input("magnitudes");
+  hpcp->output("hpcp")            >>  NOWHERE;
+  mfcc->output("bands")           >>  NOWHERE;
+  mfcc->output("mfcc")            >>  NOWHERE;
+
+  Network network(input);
+  network.setRealTime(true);
+  network.runPrepare();
+
+  const int chunkSize = 512;
+  for (int step=0; step<400; step++) {
+    feedSignal(input, step, chunkSize);
+    network.runStep();
+  }
+
+  const vector<Algorithm*>& algos = network.linearExecutionOrder();
+  const vector<sint64>& allocations = network.realTimeAllocations();
+  ASSERT_EQ(algos.size(), allocations.size());
+  for (int i=0; i<(int)algos.size(); i++) {
+    EXPECT_EQ(0, allocations[i]) << algos[i]->name() << " allocated memory";
+  }
+  EXPECT_EQ(0, network.schedulerAllocations());
+  EXPECT_EQ(0, input->overruns());
+}
+
+TEST(Network, RealTimeWarmUpAfterEmptyPolls) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  RingBufferInput* input = new RingBufferInput();
+  input->declareParameters();
+  ParameterMap params;
+  params.add("bufferSize", 8192);
+  params.add("realTime", true);
+  input->setParameters(params);
+  input->configure();
+
+  Algorithm* fc       = factory.create("FrameCutter", "frameSize", 2048, "hopSize", 512);
+  Algorithm* window   = factory.create("Windowing", "type", "blackmanharris62");
+  Algorithm* spectrum = factory.create("Spectrum");
+  Algorithm* mfcc     = factory.create("MFCC");
+
+  input->output("signal")         >>  fc->input("signal");
+  fc->output("frame")             >>  window->input("frame");
+  window->output("frame")         >>  spectrum->input("frame");
+  spectrum->output("spectrum")    >>  mfcc->input("spectrum");
+  mfcc->output("bands")           >>  NOWHERE;
+  mfcc->output("mfcc")            >>  NOWHERE;
+
+  Network network(input);
+  network.setRealTime(true);
+  network.runPrepare();
+
+  // the application polls the network well before the audio arrives: these
+  // steps don't produce anything and shouldn't use up the warm-up
+  for (int step=0; step<200; step++) {
+    network.runStep();
+  }
+
+  const int chunkSize = 512;
+  for (int step=0; step<200; step++) {
+    feedSignal(input, step, chunkSize);
+    network.runStep();
+  }
+
+  const vector<Algorithm*>& algos = network.linearExecutionOrder();
+  const vector<sint64>& allocations = network.realTimeAllocations();
+  ASSERT_EQ(algos.size(), allocations.size());
+  for (int i=0; i<(int)algos.size(); i++) {
+    EXPECT_EQ(0, allocations[i]) << algos[i]->name() << " allocated memory";
+  }
+  EXPECT_EQ(0, network.schedulerAllocations());
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+ *
+ * This file is part of Essentia
+ *
+ * Essentia is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+#include <pthread.h>
+#include "essentia_gtest.h"
+#include "network.h"
+#include "vectoroutput.h"
+#include "ringbufferinput.h"
+using namespace std;
+using namespace essentia;
+using namespace essentia::streaming;
+using namespace essentia::scheduler;
+
+
+// the ringbuffer algorithms are not in the factory
+RingBufferInput* createRealTimeInput(int bufferSize, const string& policy) {
+  RingBufferInput* input = new RingBufferInput();
+  input->declareParameters();
+  ParameterMap params;
+  params.add("bufferSize", bufferSize);
+  params.add("realTime", true);
+  params.add("overflowPolicy", policy);
+  input->setParameters(params);
+  input->configure();
+  return input;
+}
+
+vector<Real> sampleRange(int start, int end) {
+  vector<Real> result;
+  for (int i=start; i<end; i++) result.push_back(i);
+  return result;
+}
+
+
+TEST(RingBufferInput, RealTimeDrop) {
+  RingBufferInput* input = createRealTimeInput(8, "drop");
+  vector<Real> output;
+  connect(input->output("signal"), output);
+  Network network(input);
+  network.runPrepare();
+
+  // nothing to read, process() does not wait
+  network.runStep();
+  EXPECT_EQ(1, input->underruns());
+  EXPECT_TRUE(output.empty());
+
+  vector<Real> data = sampleRange(0, 12);
+  input->add(&data[0], 5);
+  input->add(&data[5], 7); // only 3 of them fit
+  EXPECT_EQ(4, input->overruns());
+  EXPECT_EQ(8, input->latency());
+
+  network.runStep();
+  EXPECT_VEC_EQ(sampleRange(0, 8), output);
+  EXPECT_EQ(0, input->latency());
+  EXPECT_EQ(8, input->maxLatency());
+
+  input->add(&data[8], 4);
+  network.runStep();
+  EXPECT_VEC_EQ(sampleRange(0, 12), output);
+  EXPECT_EQ(1, input->underruns());
+}
+
+TEST(RingBufferInput, RealTimeOverwrite) {
+  RingBufferInput* input = createRealTimeInput(8, "overwrite");
+  vector<Real> output;
+  connect(input->output("signal"), output);
+  Network network(input);
+  network.runPrepare();
+
+  vector<Real> data = sampleRange(0, 30);
+  input->add(&data[0], 6);
+  input->add(&data[6], 6); // overwrites 0..3
+
+  network.runStep();
+  EXPECT_VEC_EQ(sampleRange(4, 12), output);
+  EXPECT_EQ(4, input->overruns());
+
+  // more than the size of the ringbuffer at once
+  input->add(&data[12], 18);
+  network.runStep();
+  EXPECT_VEC_EQ(sampleRange(4, 12), vector<Real>(output.begin(), output.begin() + 8));
+  EXPECT_VEC_EQ(sampleRange(22, 30), vector<Real>(output.begin() + 8, output.end()));
+  EXPECT_EQ(14, input->overruns());
+}
+
+
+class RealTimeProducer {
+ public:
+  RingBufferInput* input;
+  int total;
+  volatile bool done;
+};
+
+void* produceCounter(void* arg) {
+  RealTimeProducer* producer = (RealTimeProducer*)arg;
+  Real chunk[32];
+  for (int i=0; i<producer->total; i+=32) {
+    for (int j=0; j<32; j++) chunk[j] = i + j;
+    producer->input->add(chunk, 32);
+  }
+  producer->done = true;
+  return 0;
+}
+
+void testConcurrentRealTime(const string& policy) {
+  RingBufferInput* input = createRealTimeInput(256, policy);
+  vector<Real> output;
+  connect(input->output("signal"), output);
+  Network network(input);
+  network.runPrepare();
+
+  RealTimeProducer producer;
+  producer.input = input;
+  producer.total = 32*100000;
+  producer.done = false;
+
+  pthread_t thread;
+  pthread_create(&thread, 0, produceCounter, &producer);
+  while (!producer.done) network.runStep();
+  pthread_join(thread, 0);
+  while (input->latency() > 0) network.runStep();
+
+  // samples may have been lost, but the ones received are in order and none
+  // of them has been torn by the producer writing over it
+  EXPECT_EQ(producer.total, int(output.size()) + input->overruns());
+  for (int i=1; i<(int)output.size(); i++) {
+    ASSERT_LT(output[i-1], output[i]);
+  }
+}
+
+TEST(RingBufferInput, RealTimeConcurrentDrop) {
+  testConcurrentRealTime("drop");
+}
+
+TEST(RingBufferInput, RealTimeConcurrentOverwrite) {
+  testConcurrentRealTime("overwrite");
+}
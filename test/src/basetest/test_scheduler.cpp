@@ -17,10 +17,13 @@
  * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
  */
 
+#include <fstream>
 #include "essentia_gtest.h"
 #include "network.h"
 #include "networkparser.h"
 #include "graphutils.h"
+#include "networkprofiler.h"
+#include "vectorinput.h"
 using namespace std;
 using namespace essentia;
 using namespace essentia::streaming;
@@ -61,3 +64,388 @@ TEST(Scheduler, SourceProxyFork) {
 
   network.run();
 }
+
+
+/**
+ * Build a network with a few independent branches (spectral, temporal) fed
+ * from the same frame cutter and store everything in the given pool.
+ */
+Network* branchyNetwork(const vector<Real>& signal, Pool& pool) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  VectorInput<Real>* gen = new VectorInput<Real>(&signal);
+  Algorithm* fc       = factory.create("FrameCutter", "frameSize", 1024, "hopSize", 256);
+  Algorithm* w        = factory.create("Windowing", "type", "hann");
+  Algorithm* spec     = factory.create("Spectrum");
+  Algorithm* mfcc     = factory.create("MFCC");
+  Algorithm* centroid = factory.create("Centroid");
+  Algorithm* rms      = factory.create("RMS");
+  Algorithm* zcr      = factory.create("ZeroCrossingRate");
+
+  *gen                         >>  fc->input("signal");
+  fc->output("frame")          >>  w->input("frame");
+  fc->output("frame")          >>  rms->input("array");
+  fc->output("frame")          >>  zcr->input("signal");
+  w->output("frame")           >>  spec->input("frame");
+  spec->output("spectrum")     >>  mfcc->input("spectrum");
+  spec->output("spectrum")     >>  centroid->input("array");
+  mfcc->output("bands")        >>  PC(pool, "mfcc.bands");
+  mfcc->output("mfcc")         >>  PC(pool, "mfcc.coeffs");
+  centroid->output("centroid") >>  PC(pool, "centroid");
+  rms->output("rms")           >>  PC(pool, "rms");
+  zcr->output("zeroCrossingRate") >> PC(pool, "zcr");
+
+  return new Network(gen);
+}
+
+TEST(Scheduler, ParallelIdenticalResults) {
+  vector<Real> signal(44100);
+  for (int i=0; i<(int)signal.size(); i++) {
+    signal[i] = sin(0.01*i) * cos(0.0003*i*i / signal.size()) + 0.1*((i*7919) % 101) / 101.;
+  }
+
+  Pool sequential, parallel;
+
+  Network* n1 = branchyNetwork(signal, sequential);
+  n1->run();
+  delete n1;
+
+  Network* n2 = branchyNetwork(signal, parallel);
+  n2->setNumberOfThreads(4);
+  n2->run();
+  delete n2;
+
+  EXPECT_VEC_EQ(sequential.value<vector<Real> >("centroid"),
+                parallel.value<vector<Real> >("centroid"));
+  EXPECT_VEC_EQ(sequential.value<vector<Real> >("rms"),
+                parallel.value<vector<Real> >("rms"));
+  EXPECT_VEC_EQ(sequential.value<vector<Real> >("zcr"),
+                parallel.value<vector<Real> >("zcr"));
+
+  EXPECT_MATRIX_EQ(sequential.value<vector<vector<Real> > >("mfcc.bands"),
+                   parallel.value<vector<vector<Real> > >("mfcc.bands"));
+  EXPECT_MATRIX_EQ(sequential.value<vector<vector<Real> > >("mfcc.coeffs"),
+                   parallel.value<vector<vector<Real> > >("mfcc.coeffs"));
+}
+
+Network* duplicatedFrontEndNetwork(const vector<Real>& signal, Pool& pool,
+                                   const string& silentFrames = "keep",
+                                   const string& windowType = "hann") {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  VectorInput<Real>* gen = new VectorInput<Real>(&signal);
+
+  // the first two chains are identical, the third one uses another hop size
+  const char* names[] = { "centroid1", "centroid2", "centroid3" };
+  const int hopSizes[] = { 256, 256, 512 };
+
+  for (int i=0; i<3; i++) {
+    Algorithm* fc       = factory.create("FrameCutter", "frameSize", 1024, "hopSize", hopSizes[i],
+                                         "silentFrames", silentFrames);
+    Algorithm* w        = factory.create("Windowing", "type", windowType);
+    Algorithm* spec     = factory.create("Spectrum");
+    Algorithm* centroid = factory.create("Centroid");
+
+    *gen                         >>  fc->input("signal");
+    fc->output("frame")          >>  w->input("frame");
+    w->output("frame")           >>  spec->input("frame");
+    spec->output("spectrum")     >>  centroid->input("array");
+    centroid->output("centroid") >>  PC(pool, names[i]);
+  }
+
+  return new Network(gen);
+}
+
+int countAlgorithms(const vector<Algorithm*>& algos, const string& name) {
+  int n = 0;
+  for (int i=0; i<(int)algos.size(); i++) {
+    if (algos[i]->name() == name) n++;
+  }
+  return n;
+}
+
+TEST(Scheduler, MergeIdenticalAlgorithms) {
+  vector<Real> signal(22050);
+  for (int i=0; i<(int)signal.size(); i++) {
+    signal[i] = sin(0.01*i) + 0.1*((i*7919) % 101) / 101.;
+  }
+
+  Pool expected, merged;
+
+  Network* n1 = duplicatedFrontEndNetwork(signal, expected);
+  n1->run();
+  EXPECT_EQ(3, countAlgorithms(n1->linearExecutionOrder(), "Spectrum"));
+  delete n1;
+
+  Network* n2 = duplicatedFrontEndNetwork(signal, merged);
+  n2->setMergeIdenticalAlgorithms(true);
+  n2->run();
+  const vector<Algorithm*>& algos = n2->linearExecutionOrder();
+  EXPECT_EQ(2, countAlgorithms(algos, "FrameCutter"));
+  EXPECT_EQ(2, countAlgorithms(algos, "Windowing"));
+  EXPECT_EQ(2, countAlgorithms(algos, "Spectrum"));
+  EXPECT_EQ(2, countAlgorithms(algos, "Centroid"));
+  delete n2;
+
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("centroid1"), merged.value<vector<Real> >("centroid1"));
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("centroid2"), merged.value<vector<Real> >("centroid2"));
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("centroid3"), merged.value<vector<Real> >("centroid3"));
+}
+
+TEST(Scheduler, MergeIdenticalAlgorithmsSilentFrames) {
+  // configured like in the music extractor: noise is added to silent frames
+  vector<Real> signal(22050, 0.0);
+  for (int i=0; i<(int)signal.size(); i++) {
+    if ((i / 4096) % 2 == 0) signal[i] = sin(0.01*i);
+  }
+
+  Pool expected, merged;
+
+  Network* n1 = duplicatedFrontEndNetwork(signal, expected, "noise", "blackmanharris62");
+  n1->run();
+  delete n1;
+
+  Network* n2 = duplicatedFrontEndNetwork(signal, merged, "noise", "blackmanharris62");
+  n2->setMergeIdenticalAlgorithms(true);
+  n2->run();
+  const vector<Algorithm*>& algos = n2->linearExecutionOrder();
+  EXPECT_EQ(2, countAlgorithms(algos, "FrameCutter"));
+  EXPECT_EQ(2, countAlgorithms(algos, "Spectrum"));
+  delete n2;
+
+  // the noise added to the silent frames is the same in both runs
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("centroid1"), merged.value<vector<Real> >("centroid1"));
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("centroid2"), merged.value<vector<Real> >("centroid2"));
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("centroid3"), merged.value<vector<Real> >("centroid3"));
+}
+
+TEST(Scheduler, MergeIdenticalAlgorithmsNonDeterministic) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+  vector<Real> signal(4096, 0.5);
+
+  for (int fixSeed=0; fixSeed<2; fixSeed++) {
+    Pool pool;
+    VectorInput<Real>* gen = new VectorInput<Real>(&signal);
+    for (int i=0; i<2; i++) {
+      Algorithm* noise = factory.create("NoiseAdder", "fixSeed", bool(fixSeed));
+      *gen                       >>  noise->input("signal");
+      noise->output("signal")    >>  PC(pool, "noise");
+    }
+
+    Network network(gen);
+    network.setMergeIdenticalAlgorithms(true);
+    network.run();
+
+    // random noise is only the same twice with a fixed seed
+    EXPECT_EQ(fixSeed ? 1 : 2, countAlgorithms(network.linearExecutionOrder(), "NoiseAdder"));
+  }
+}
+
+TEST(Scheduler, InvalidNumberOfThreads) {
+  vector<Real> signal(1024, 0.5);
+  Pool pool;
+  Network* n = branchyNetwork(signal, pool);
+  ASSERT_THROW(n->setNumberOfThreads(0), EssentiaException);
+  delete n;
+}
+
+const AlgorithmProfile& findProfile(const vector<AlgorithmProfile>& profiles, const string& name) {
+  for (int i=0; i<(int)profiles.size(); i++) {
+    if (profiles[i].name == name) return profiles[i];
+  }
+  throw EssentiaException("no profile for ", name);
+}
+
+TEST(Scheduler, Profiling) {
+  vector<Real> signal(22050);
+  for (int i=0; i<(int)signal.size(); i++) {
+    signal[i] = sin(0.01*i) + 0.1*((i*7919) % 101) / 101.;
+  }
+
+  for (int nThreads=1; nThreads<=4; nThreads+=3) {
+    Pool pool;
+    Network* n = branchyNetwork(signal, pool);
+    EXPECT_TRUE(n->profiler() == 0);
+
+    n->setNumberOfThreads(nThreads);
+    n->setProfiling(true, true);
+    n->run();
+
+    NetworkProfiler* profiler = n->profiler();
+    ASSERT_TRUE(profiler != 0);
+    const vector<AlgorithmProfile>& profiles = profiler->profiles();
+    ASSERT_EQ(n->linearExecutionOrder().size(), profiles.size());
+
+    int nFrames = pool.value<vector<Real> >("centroid").size();
+    EXPECT_EQ(int(signal.size()), findProfile(profiles, "VectorInput").produced);
+    // the FrameCutter doesn't release the samples of its last frame
+    EXPECT_LE(findProfile(profiles, "FrameCutter").consumed, int(signal.size()));
+    EXPECT_GT(findProfile(profiles, "FrameCutter").consumed, int(signal.size()) - 1024);
+    EXPECT_EQ(nFrames, findProfile(profiles, "FrameCutter").produced);
+    EXPECT_EQ(nFrames, findProfile(profiles, "Spectrum").consumed);
+    EXPECT_EQ(nFrames, findProfile(profiles, "Spectrum").produced);
+    EXPECT_EQ(nFrames, findProfile(profiles, "RMS").consumed);
+    EXPECT_EQ(nFrames, findProfile(profiles, "ZeroCrossingRate").consumed);
+
+    for (int i=0; i<(int)profiles.size(); i++) {
+      EXPECT_GT(profiles[i].calls, 0);
+      EXPECT_GE(profiles[i].wallTime, 0);
+      EXPECT_GE(profiles[i].cpuTime, 0);
+    }
+
+    ostringstream report;
+    profiler->printReport(report);
+    EXPECT_NE(string::npos, report.str().find("Spectrum"));
+
+    string filename = "build/test/trace.json";
+    profiler->writeChromeTrace(filename);
+    ifstream file(filename.c_str());
+    string trace((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    file.close();
+    if (remove(filename.c_str())) throw EssentiaException("TestScheduler: Error deleting ", filename);
+    EXPECT_EQ(0, int(trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[")));
+    EXPECT_NE(string::npos, trace.find("\"name\":\"MFCC\""));
+
+    // the results are still available once the algorithms have been deleted
+    n->clear();
+    EXPECT_EQ(nFrames, findProfile(n->profiler()->profiles(), "Spectrum").produced);
+    delete n;
+  }
+}
+
+TEST(Scheduler, ProfilingWithoutTrace) {
+  vector<Real> signal(4096, 0.5);
+  Pool pool;
+  Network* n = branchyNetwork(signal, pool);
+  n->setProfiling(true);
+  n->run();
+  ASSERT_THROW(n->profiler()->writeChromeTrace("build/test/trace.json"), EssentiaException);
+  delete n;
+}
+
+int totalBufferSize(const vector<Algorithm*>& algos) {
+  int total = 0;
+  for (int i=0; i<(int)algos.size(); i++) {
+    for (int j=0; j<(int)algos[i]->outputs().size(); j++) {
+      total += algos[i]->output(j).bufferInfo().size;
+    }
+  }
+  return total;
+}
+
+void expectNoReschedule(NetworkProfiler* profiler) {
+  const vector<AlgorithmProfile>& profiles = profiler->profiles();
+  for (int i=0; i<(int)profiles.size(); i++) {
+    EXPECT_EQ(0, profiles[i].noOutput) << profiles[i].name;
+  }
+}
+
+TEST(Scheduler, AdaptiveBufferSizes) {
+  vector<Real> signal(22050);
+  for (int i=0; i<(int)signal.size(); i++) {
+    signal[i] = sin(0.01*i) + 0.1*((i*7919) % 101) / 101.;
+  }
+
+  Pool expected, pool;
+  Network* n1 = branchyNetwork(signal, expected);
+  n1->run();
+  int defaultSize = totalBufferSize(n1->linearExecutionOrder());
+  delete n1;
+
+  // the first run is the warm-up one
+  Network* n2 = branchyNetwork(signal, pool);
+  n2->setProfiling(true);
+  n2->setAdaptiveBufferSizes(true);
+  n2->run();
+  EXPECT_EQ(0, totalBufferSize(n2->linearExecutionOrder()) - defaultSize);
+  ASSERT_FALSE(n2->bufferSizes().empty());
+
+  n2->reset();
+  pool.clear();
+  n2->run();
+  EXPECT_LT(totalBufferSize(n2->linearExecutionOrder()), defaultSize);
+  expectNoReschedule(n2->profiler());
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("centroid"), pool.value<vector<Real> >("centroid"));
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("rms"), pool.value<vector<Real> >("rms"));
+  EXPECT_MATRIX_EQ(expected.value<vector<vector<Real> > >("mfcc.coeffs"),
+                   pool.value<vector<vector<Real> > >("mfcc.coeffs"));
+
+  string filename = "build/test/buffers.txt";
+  n2->saveBufferSizes(filename);
+  vector<Network::BufferSize> sizes = n2->bufferSizes();
+  delete n2;
+
+  // the sizes can be reused by another instance of the same network
+  Pool loaded;
+  Network* n3 = branchyNetwork(signal, loaded);
+  n3->setProfiling(true);
+  n3->loadBufferSizes(filename);
+  if (remove(filename.c_str())) throw EssentiaException("TestScheduler: Error deleting ", filename);
+  ASSERT_EQ(sizes.size(), n3->bufferSizes().size());
+  for (int i=0; i<(int)sizes.size(); i++) {
+    EXPECT_EQ(sizes[i].algorithmName, n3->bufferSizes()[i].algorithmName);
+    EXPECT_EQ(sizes[i].output, n3->bufferSizes()[i].output);
+    EXPECT_EQ(sizes[i].info.size, n3->bufferSizes()[i].info.size);
+    EXPECT_EQ(sizes[i].info.maxContiguousElements, n3->bufferSizes()[i].info.maxContiguousElements);
+  }
+  n3->run();
+  expectNoReschedule(n3->profiler());
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("zcr"), loaded.value<vector<Real> >("zcr"));
+  EXPECT_MATRIX_EQ(expected.value<vector<vector<Real> > >("mfcc.bands"),
+                   loaded.value<vector<vector<Real> > >("mfcc.bands"));
+  delete n3;
+
+  ASSERT_THROW(Network(new VectorInput<Real>(&signal)).loadBufferSizes("build/test/nonexistent.txt"),
+               EssentiaException);
+}
+
+TEST(Scheduler, AdaptiveBufferSizesOtherInput) {
+  AlgorithmFactory& factory = AlgorithmFactory::instance();
+
+  vector<Real> shortSignal(4096), longSignal(88200);
+  for (int i=0; i<(int)longSignal.size(); i++) {
+    longSignal[i] = sin(0.01*i) + 0.1*((i*7919) % 101) / 101.;
+  }
+  copy(longSignal.begin(), longSignal.begin() + shortSignal.size(), shortSignal.begin());
+
+  Pool expected;
+  VectorInput<Real>* gen1 = new VectorInput<Real>(&longSignal);
+  Algorithm* fc1          = factory.create("FrameCutter", "frameSize", 8192, "hopSize", 2048);
+  Algorithm* rms1         = factory.create("RMS");
+  *gen1                >>  fc1->input("signal");
+  fc1->output("frame") >>  rms1->input("array");
+  rms1->output("rms")  >>  PC(expected, "rms");
+  Network(gen1).run();
+
+  // fit the sizes on a short signal with small frames...
+  Pool pool;
+  VectorInput<Real>* gen = new VectorInput<Real>(&shortSignal);
+  Algorithm* fc          = factory.create("FrameCutter", "frameSize", 512, "hopSize", 256);
+  Algorithm* rms         = factory.create("RMS");
+  *gen                >>  fc->input("signal");
+  fc->output("frame") >>  rms->input("array");
+  rms->output("rms")  >>  PC(pool, "rms");
+
+  Network network(gen);
+  network.setProfiling(true);
+  network.setAdaptiveBufferSizes(true);
+  network.run();
+
+  for (int i=0; i<(int)network.bufferSizes().size(); i++) {
+    const BufferInfo& info = network.bufferSizes()[i].info;
+    EXPECT_GT(info.size, info.maxContiguousElements);
+  }
+
+  // ...and run on a longer one, with larger frames: the buffers must still
+  // be large enough for the new acquire sizes
+  fc->configure("frameSize", 8192, "hopSize", 2048);
+  gen->setVector(&longSignal);
+  network.reset();
+  pool.clear();
+  network.run();
+
+  EXPECT_VEC_EQ(expected.value<vector<Real> >("rms"), pool.value<vector<Real> >("rms"));
+  BufferInfo info = fc->input("signal").source()->bufferInfo();
+  EXPECT_GE(info.maxContiguousElements, 8192);
+  EXPECT_GE(info.size, 8192 + gen->output("data").acquireSize());
+}
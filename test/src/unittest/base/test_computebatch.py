@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+import threading
+
+
+class TestComputeBatch(TestCase):
+
+    def frames(self, nFrames = 20, frameSize = 512):
+        numpy.random.seed(0)
+        return numpy.random.rand(nFrames, frameSize).astype('f4')
+
+    def testVectorOutput(self):
+        frames = self.frames()
+        spectrum = Spectrum()
+        spectra = spectrum.computeBatch(frames)
+
+        self.assertEqual(spectra.shape, (20, 257))
+        for frame, spec in zip(frames, spectra):
+            self.assertEqualVector(spec, spectrum(frame))
+
+    def testRealOutput(self):
+        frames = self.frames()
+        centroid = Centroid()
+        centroids = centroid.computeBatch(frames)
+
+        self.assertEqual(centroids.shape, (20,))
+        self.assertEqualVector(centroids, [ centroid(frame) for frame in frames ])
+
+    def testMultipleOutputs(self):
+        frames = self.frames()
+        mfcc = MFCC(inputSize = 512)
+        bands, coeffs = mfcc.computeBatch(frames)
+
+        self.assertEqual(bands.shape, (20, 40))
+        self.assertEqual(coeffs.shape, (20, 13))
+        for i, frame in enumerate(frames):
+            expectedBands, expectedCoeffs = mfcc(frame)
+            self.assertEqualVector(bands[i], expectedBands)
+            self.assertEqualVector(coeffs[i], expectedCoeffs)
+
+    def testNonContiguous(self):
+        frames = self.frames()
+        spectrum = Spectrum()
+        self.assertEqualMatrix(spectrum.computeBatch(frames[::2]),
+                               spectrum.computeBatch(numpy.array(frames[::2])))
+
+    def testEmpty(self):
+        self.assertEqual(Centroid().computeBatch(numpy.zeros((0, 512))).shape, (0,))
+
+    def testInvalidInput(self):
+        self.assertRaises(ValueError, Spectrum().computeBatch, numpy.zeros(512))
+        # not a single vector input
+        self.assertRaises(RuntimeError, CartesianToPolar().computeBatch, self.frames())
+
+    def testThreads(self):
+        # the GIL is released while computing, so each thread has its own algorithm
+        frames = self.frames(200, 1024)
+        expected = Spectrum().computeBatch(frames)
+        results = [ None ] * 4
+
+        def compute(i):
+            spectrum = Spectrum()
+            results[i] = numpy.array([ spectrum(frame) for frame in frames ])
+
+        threads = [ threading.Thread(target = compute, args = (i,)) for i in range(4) ]
+        for t in threads: t.start()
+        for t in threads: t.join()
+
+        for result in results:
+            self.assertEqualMatrix(result, expected)
+
+
+suite = allTests(TestComputeBatch)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
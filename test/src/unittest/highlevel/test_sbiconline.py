@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+
+from numpy import array, random
+from essentia_test import *
+from essentia.streaming import SBicOnline, VectorInput
+
+
+class TestSBicOnline(TestCase):
+
+    def computeChanges(self, frames, **params):
+        gen = VectorInput(frames)
+        sbic = SBicOnline(**params)
+        pool = Pool()
+
+        gen.data >> sbic.features
+        sbic.changePoints >> (pool, 'changes')
+        run(gen)
+
+        if 'changes' not in pool.descriptorNames():
+            return []
+        return list(pool['changes'])
+
+    def testOneSegment(self):
+        random.seed(0)
+        frames = array(random.rand(600, 2), dtype='f4')
+        self.assertEqualVector(self.computeChanges(frames), [])
+
+    def testTwoSegments(self):
+        random.seed(0)
+        frames = array(random.rand(600, 2), dtype='f4')
+        frames[300:] += 5
+
+        changes = self.computeChanges(frames)
+        self.assertEqual(len(changes), 1)
+        self.assertAlmostEqual(changes[0], 299, .02)
+
+    def testSameAsSBic(self):
+        random.seed(1)
+        frames = array(random.rand(3000, 4), dtype='f4')
+        for start in [500, 1200, 2100]:
+            frames[start:] += random.rand(4) * 4
+
+        from essentia.standard import SBic
+        segmentation = SBic()(frames.T.copy())
+        self.assertEqualVector(self.computeChanges(frames), segmentation[1:-1])
+
+    def testSameAsSBicSmallIncrement(self):
+        # the fine windows reach further back than the first pass increment
+        random.seed(1)
+        frames = array(random.rand(3000, 4), dtype='f4')
+        for start in [500, 1200, 2100]:
+            frames[start:] += random.rand(4) * 4
+
+        from essentia.standard import SBic
+        segmentation = SBic(inc1=1, size2=200)(frames.T.copy())
+        self.assertEqualVector(self.computeChanges(frames, inc1=1, size2=200), segmentation[1:-1])
+
+
+suite = allTests(TestSBicOnline)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -248,6 +248,33 @@ class TestAudioLoader_Streaming(TestCase):
         self.assertEqual(md5_ogg, "a87dad40fea0966cc5b967d5412e8868")
         self.assertEqual(md5_aac, "9a4c7f0da68d4b58767f219c48014f9c")
     
+    def testAsynchronous(self):
+        # decoding in a separate thread should give exactly the same results
+        dir = join(testdata.audio_dir, 'recorded')
+        for filename in [ 'dubstep.wav', 'dubstep.flac', 'dubstep.mp3', 'dubstep.ogg' ]:
+            expected = AudioLoader(filename=join(dir, filename), computeMD5=True)()
+            found = AudioLoader(filename=join(dir, filename), computeMD5=True, asynchronous=True)()
+            self.assertEqualMatrix(found[0], expected[0])
+            self.assertEqual(found[1:], expected[1:])
+
+    def testAsynchronousReset(self):
+        # resetting the loader while the decode thread is still running
+        filename = join(testdata.audio_dir, 'recorded', 'dubstep.flac')
+        loader = sAudioLoader(filename=filename, asynchronous=True)
+        p = Pool()
+        loader.audio >> (p, 'audio')
+        loader.numberChannels >> None
+        loader.sampleRate >> None
+        loader.md5 >> None
+        loader.bit_rate >> None
+        loader.codec >> None
+
+        loader.reset()
+        run(loader)
+
+        expected = AudioLoader(filename=filename)()[0]
+        self.assertEqualMatrix(p['audio'], expected)
+
     def testMultiStream(self):
         
         #  stream 0 of multistream1.mka is the same as stream 1 of multistream2.mka 
@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+
+
+from essentia_test import *
+from numpy import array, arange
+import os
+
+
+class TestBinaryPoolOutput(TestCase):
+
+    def createPool(self):
+        p = Pool()
+        p.add('lowlevel.loudness', 0.5)
+        p.add('lowlevel.loudness', -1.25)
+        for i in range(100):
+            p.add('lowlevel.mfcc', array([i, 2*i, -i], dtype='f4'))
+        p.add('tags.genre', 'rock')
+        p.add('tags.genre', 'jazz')
+        p.set('metadata.duration', 3.5)
+        p.set('metadata.title', 'title')
+        p.set('metadata.histogram', array(arange(10), dtype='f4'))
+        return p
+
+    def roundTrip(self, p, **params):
+        BinaryPoolOutput(filename='testfile.bin', writeVersion=False, **params)(p)
+        result = BinaryPoolInput(filename='testfile.bin')()
+        os.remove('testfile.bin')
+        return result
+
+    def assertSamePools(self, expected, p):
+        self.assertEqual(sorted(expected.descriptorNames()), sorted(p.descriptorNames()))
+        self.assertEqualVector(p['lowlevel.loudness'], expected['lowlevel.loudness'])
+        self.assertEqualMatrix(p['lowlevel.mfcc'], expected['lowlevel.mfcc'])
+        self.assertEqualVector(p['tags.genre'], expected['tags.genre'])
+        self.assertEqual(p['metadata.duration'], 3.5)
+        self.assertEqual(p['metadata.title'], 'title')
+        self.assertEqualVector(p['metadata.histogram'], expected['metadata.histogram'])
+
+    def testRoundTrip(self):
+        p = self.createPool()
+        self.assertSamePools(p, self.roundTrip(p))
+
+    def testCompressed(self):
+        p = self.createPool()
+        try:
+            result = self.roundTrip(p, compress=True)
+        except EssentiaException:
+            # essentia has been compiled without zlib
+            return
+        self.assertSamePools(p, result)
+
+    def testSameAsYaml(self):
+        p = self.createPool()
+        YamlOutput(filename='testfile.yaml')(p)
+        BinaryPoolOutput(filename='testfile.bin')(p)
+
+        expected = YamlInput(filename='testfile.yaml')()
+        result = BinaryPoolInput(filename='testfile.bin')()
+        os.remove('testfile.yaml')
+        os.remove('testfile.bin')
+
+        self.assertEqual(result['metadata.version.essentia'], expected['metadata.version.essentia'])
+        self.assertSamePools(expected, result)
+
+    def testInvalidFile(self):
+        open('testfile.bin', 'w').write('foo: 1.0')
+        self.assertComputeFails(BinaryPoolInput(filename='testfile.bin'))
+        os.remove('testfile.bin')
+        self.assertComputeFails(BinaryPoolInput(filename='unknown.bin'))
+
+
+suite = allTests(TestBinaryPoolOutput)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -0,0 +1,137 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+
+
+from essentia_test import *
+from numpy import array, arange, sin, pi, int16, float32
+import os
+import tempfile
+import wave
+audio_dir = join(testdata.audio_dir, 'generated', 'synthesised', 'impulse')
+wav_dir = join(audio_dir, 'wav')
+
+class TestMmapAudioLoader(TestCase):
+
+    def round(self, val):
+        if val >= 0 : return int(val+0.5)
+        return int(val-0.5)
+
+    def load(self, filename, **params):
+        return MmapAudioLoader(filename=filename, **params)()
+
+    def tempFile(self, suffix):
+        fd, filename = tempfile.mkstemp(suffix=suffix)
+        os.close(fd)
+        self.addCleanup(os.remove, filename)
+        return filename
+
+    def testInvalidParam(self):
+        filename = join(wav_dir, 'impulses_1second_44100_st.wav')
+        self.assertConfigureFails(MmapAudioLoader(), { 'filename' : filename,
+                                                       'downmix'  : 'stereo' })
+        self.assertConfigureFails(MmapAudioLoader(), { 'filename' : 'unknown.wav' })
+
+    def testNotWav(self):
+        filename = self.tempFile('.wav')
+        open(filename, 'wb').write('not a wav file')
+        self.assertConfigureFails(MmapAudioLoader(), { 'filename' : filename })
+
+    def testWav44100(self):
+        # files with 9 impulses in each channel
+        filename = join(wav_dir, 'impulses_1second_44100_st.wav')
+        for downmix in [ 'left', 'right', 'mix' ]:
+            audio, sampleRate, channels = self.load(filename, downmix=downmix)
+            self.assertEqual(self.round(sum(audio)), 9)
+            self.assertEqual(sampleRate, 44100)
+            self.assertEqual(channels, 2)
+
+    def testWavLeftRightOffset(self):
+        # file with 9 impulses in right channel and 10 in left channel
+        dir = join(testdata.audio_dir, 'generated', 'synthesised', 'impulse', 'left_right_offset')
+        filename = join(dir, 'impulses_1second_44100.wav')
+        self.assertEqual(self.round(sum(self.load(filename, downmix='left')[0])), 10)
+        self.assertEqual(self.round(sum(self.load(filename, downmix='right')[0])), 9)
+        self.assertAlmostEqualFixedPrecision(sum(self.load(filename, downmix='mix')[0]), 9.5, 3)
+
+    def testSameAsAudioLoader(self):
+        filename = join(wav_dir, 'impulses_1second_44100_st.wav')
+        stereo = AudioLoader(filename=filename)()[0]
+        self.assertEqualVector(self.load(filename, downmix='left')[0], stereo[:,0])
+        self.assertEqualVector(self.load(filename, downmix='right')[0], stereo[:,1])
+        self.assertAlmostEqualVector(self.load(filename, downmix='mix')[0],
+                                     0.5*(stereo[:,0] + stereo[:,1]))
+
+    def testInt16Wav(self):
+        signal = array(sin(2*pi*440*arange(10000)/22050.) * 32767, dtype=int16)
+        filename = self.tempFile('.wav')
+        f = wave.open(filename, 'wb')
+        f.setnchannels(1)
+        f.setsampwidth(2)
+        f.setframerate(22050)
+        f.writeframes(signal.tostring())
+        f.close()
+
+        audio, sampleRate, channels = self.load(filename)
+        self.assertEqual(sampleRate, 22050)
+        self.assertEqual(channels, 1)
+        self.assertEqualVector(audio, signal / 32768.)
+
+    def testRawFloat(self):
+        # interleaved stereo, the left channel is a ramp and the right one is constant
+        signal = array([ [ i/10000., 0.5 ] for i in range(10000) ], dtype=float32)
+        filename = self.tempFile('.raw')
+        open(filename, 'wb').write(signal.tostring())
+
+        params = { 'format': 'raw', 'sampleFormat': 'float32', 'channels': 2, 'sampleRate': 8000 }
+        left, sampleRate, channels = self.load(filename, downmix='left', **params)
+        self.assertEqual(sampleRate, 8000)
+        self.assertEqual(channels, 2)
+        self.assertEqualVector(left, signal[:,0])
+        self.assertEqualVector(self.load(filename, downmix='right', **params)[0], signal[:,1])
+        self.assertAlmostEqualVector(self.load(filename, downmix='mix', **params)[0],
+                                     0.5*(signal[:,0] + signal[:,1]))
+
+    def testEmptyRaw(self):
+        filename = self.tempFile('.raw')
+        self.assertEqualVector(self.load(filename, format='raw')[0], [])
+
+    def testStreaming(self):
+        # the samples go directly to FrameCutter
+        from essentia.streaming import MmapAudioLoader as sMmapAudioLoader, FrameCutter
+        filename = join(wav_dir, 'impulses_1second_44100_st.wav')
+
+        loader = sMmapAudioLoader(filename=filename)
+        fc = FrameCutter(frameSize=1024, hopSize=512)
+        pool = Pool()
+
+        loader.audio >> fc.signal
+        fc.frame >> (pool, 'frames')
+        loader.sampleRate >> None
+        loader.numberChannels >> None
+        run(loader)
+
+        audio = self.load(filename)[0]
+        expected = [ frame for frame in FrameGenerator(audio, frameSize=1024, hopSize=512) ]
+        self.assertEqualMatrix(pool['frames'], expected)
+
+
+suite = allTests(TestMmapAudioLoader)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
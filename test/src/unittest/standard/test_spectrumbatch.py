@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2006-2016  Music Technology Group - Universitat Pompeu Fabra
+#
+# This file is part of Essentia
+#
+# Essentia is free software: you can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the Free
+# Software Foundation (FSF), either version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the Affero GNU General Public License
+# version 3 along with this program. If not, see http://www.gnu.org/licenses/
+
+
+
+from essentia_test import *
+from essentia.streaming import SpectrumBatch as sSpectrumBatch
+
+
+class TestSpectrumBatch(TestCase):
+
+    def frames(self, n, size):
+        return [ [ sin(0.01*(i+1)*j) for j in range(size) ] for i in range(n) ]
+
+    def testRegression(self):
+        # results must be the same as computing the spectrum of each frame
+        frames = self.frames(10, 512)
+        output = SpectrumBatch()(frames)
+        self.assertEqual(len(output), len(frames))
+        for frame, spectrum in zip(frames, output):
+            self.assertAlmostEqualVector(spectrum, Spectrum()(frame), 1e-6)
+
+    def testChangingSizes(self):
+        # fewer samples in total, but more output bins than the first call
+        spectrumBatch = SpectrumBatch()
+        for n, size in [ (1, 1024), (16, 64), (3, 256) ]:
+            frames = self.frames(n, size)
+            output = spectrumBatch(frames)
+            self.assertEqual(len(output), n)
+            for frame, spectrum in zip(frames, output):
+                self.assertAlmostEqualVector(spectrum, Spectrum()(frame), 1e-6)
+
+    def testStreaming(self):
+        # 37 frames: two full batches and a partial one
+        frames = self.frames(37, 256)
+        gen = VectorInput(frames)
+        spectrum = sSpectrumBatch()
+        pool = Pool()
+
+        gen.data >> spectrum.frame
+        spectrum.spectrum >> (pool, 'spectrum')
+        run(gen)
+
+        expected = SpectrumBatch()(frames)
+        self.assertEqual(len(pool['spectrum']), len(frames))
+        self.assertAlmostEqualMatrix(pool['spectrum'], expected, 1e-6)
+
+    def testEmpty(self):
+        self.assertEqual(len(SpectrumBatch()([])), 0)
+
+    def testEmptyFrame(self):
+        self.assertComputeFails(SpectrumBatch(), [[]])
+
+    def testOddSize(self):
+        self.assertComputeFails(SpectrumBatch(), [[1]*513])
+
+    def testDifferentSizes(self):
+        self.assertComputeFails(SpectrumBatch(), [[1]*512, [1]*256])
+
+    def testInvalidParam(self):
+        self.assertConfigureFails(SpectrumBatch(), {'size': -1})
+        self.assertConfigureFails(SpectrumBatch(), {'size': 0})
+
+suite = allTests(TestSpectrumBatch)
+
+if __name__ == '__main__':
+    TextTestRunner(verbosity=2).run(suite)
@@ -90,6 +90,24 @@ class TestCrossCorrelation(TestCase):
 
         self.assertAlmostEqualVector(result, [0]*11)
 
+    def testLargeInputs(self):
+        # large enough for the correlation to be computed with FFTs
+        from numpy import random, correlate
+        random.seed(0)
+        x = random.uniform(-1, 1, 5000).astype('f4')
+        y = random.uniform(-1, 1, 3000).astype('f4')
+
+        # full cross-correlation, numpy's lag 0 being at index len(y)-1
+        full = correlate(x.astype('f8'), y.astype('f8'), 'full')
+        minLag, maxLag = -4000, 6000
+        expected = []
+        for lag in range(minLag, maxLag+1):
+            idx = lag + len(y) - 1
+            expected.append(full[idx] if 0 <= idx < len(full) else 0)
+
+        result = CrossCorrelation(minLag=minLag, maxLag=maxLag)(x, y)
+        self.assertAlmostEqualVectorFixedPrecision(result, expected, 3)
+
 
 suite = allTests(TestCrossCorrelation)
 
@@ -105,6 +105,28 @@ class TestPitchYin(TestCase):
     def testInvalidParam(self):
         self.assertConfigureFails(PitchYin(), {'frameSize' : 1})
         self.assertConfigureFails(PitchYin(), {'sampleRate' : 0})
+        self.assertConfigureFails(PitchYin(), {'differenceMethod' : 'autocorrelation'})
+
+    def testZeroFFT(self):
+        pitch, confidence = PitchYin(differenceMethod='fft')(zeros(2048))
+        self.assertEqual(pitch, 0)
+        self.assertEqual(confidence, 0)
+
+    def testFFTDifference(self):
+        # the difference function computed with FFTs gives the same results as
+        # the direct one, up to rounding errors
+        filename = join(testdata.audio_dir, 'recorded','mozart_c_major_30sec.wav')
+        audio = MonoLoader(filename=filename, sampleRate=44100)()
+
+        for frameSize in [ 1023, 1024, 2048 ]:
+            direct = PitchYin(frameSize=frameSize)
+            fft = PitchYin(frameSize=frameSize, differenceMethod='fft')
+
+            for frame in FrameGenerator(audio, frameSize=frameSize, hopSize=4*frameSize):
+                pitch, confidence = direct(frame)
+                fftPitch, fftConfidence = fft(frame)
+                self.assertAlmostEqual(fftPitch, pitch, 1e-4)
+                self.assertAlmostEqualFixedPrecision(fftConfidence, confidence, 4)
 
     # TODO: generate pitchyin/pitch_mozart_c_major_30sec.txt 
     #       check if estimations actually have some sense